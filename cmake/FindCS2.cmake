@@ -20,6 +20,9 @@ find_package(GMP REQUIRED)
 # deps: qhull
 set(QHULL_BASE_DIR ${CS2_DIR}/deps/qhull)
 
+# deps: threads
+find_package(Threads REQUIRED)
+
 # cs2: include
 set(CS2_INCLUDE_DIR ${CS2_DIR}/inc)
 set(CS2_INCLUDE_DIR ${CS2_INCLUDE_DIR} ${GMP_INCLUDE_DIR})
@@ -31,6 +34,7 @@ set(CS2_LIBRARIES cs2)
 set(CS2_LIBRARIES ${CS2_LIBRARIES} ${GMP_LIBRARIES})
 set(CS2_LIBRARIES ${CS2_LIBRARIES} ${QHULL_BASE_DIR}/lib/libqhullstatic_r.a)
 set(CS2_LIBRARIES ${CS2_LIBRARIES} c m)
+set(CS2_LIBRARIES ${CS2_LIBRARIES} ${CMAKE_THREAD_LIBS_INIT})
 
 if(${CMAKE_SYSTEM_NAME} MATCHES "Linux")
     set(CS2_LIBRARIES ${CS2_LIBRARIES} dl)
@@ -52,6 +56,7 @@ set(CS2_STATIC_LIBRARIES ${CS2_DIR}/lib/libcs2_s.a)
 set(CS2_STATIC_LIBRARIES ${CS2_STATIC_LIBRARIES} ${GMP_LIBRARIES})
 set(CS2_STATIC_LIBRARIES ${CS2_STATIC_LIBRARIES} ${QHULL_BASE_DIR}/lib/libqhullstatic_r.a)
 set(CS2_STATIC_LIBRARIES ${CS2_STATIC_LIBRARIES} c m)
+set(CS2_STATIC_LIBRARIES ${CS2_STATIC_LIBRARIES} ${CMAKE_THREAD_LIBS_INIT})
 
 if(${CMAKE_SYSTEM_NAME} MATCHES "Linux")
     set(CS2_STATIC_LIBRARIES ${CS2_STATIC_LIBRARIES} dl)
@@ -68,7 +68,7 @@ int main()
 
     for (double v = 0.1; v > 0.00000001; v /= 10)
     {
-        cs2_beziertreeleafsqq4f_sub_vol(&l, v);
+        cs2_beziertreeleafsqq4f_sub_vol_par(&l, v);
         printf("target hull vol: %.12f, perc: %.12f, subs: %d, time: %d ms\n",
                v, 100 * l.c * v / (M_PI * M_PI / 2.0),
                (int)l.c, (int)(cs2_timer_msec() - start));
@@ -61,14 +61,41 @@ double projectedDistance(const struct cs2_spin3f_s *a, const struct cs2_spin3f_s
     return cs2_vec3f_len(&pc);
 }
 
+// exact normal of the projected surface, oriented along the face normal
+QVector3D projectNormal(const struct cs2_spin3f_s &spin, const struct cs2_spin3f_s &spinU, const struct cs2_spin3f_s &spinV, const QVector3D &face)
+{
+    double w = 1.0 / (1.0 - spin.s0);
+
+    // d/dt (s / (1 - s0)) = ds / (1 - s0) + s ds0 / (1 - s0)^2
+    QVector3D pu(static_cast<float>(w * (spinU.s12 + spin.s12 * spinU.s0 * w)),
+                 static_cast<float>(w * (spinU.s23 + spin.s23 * spinU.s0 * w)),
+                 static_cast<float>(w * (spinU.s31 + spin.s31 * spinU.s0 * w)));
+
+    QVector3D pv(static_cast<float>(w * (spinV.s12 + spin.s12 * spinV.s0 * w)),
+                 static_cast<float>(w * (spinV.s23 + spin.s23 * spinV.s0 * w)),
+                 static_cast<float>(w * (spinV.s31 + spin.s31 * spinV.s0 * w)));
+
+    QVector3D n = QVector3D::crossProduct(pu, pv);
+
+    // singular point of the parametrization
+    if (n.isNull() || !std::isfinite(n.x()) || !std::isfinite(n.y()) || !std::isfinite(n.z()))
+        return face;
+
+    n.normalize();
+
+    return QVector3D::dotProduct(n, face) < 0 ? -n : n;
+}
+
 void meshSurfaceAdaptiveStep(TriangleListPtr trianglesFront, TriangleListPtr trianglesBack, struct cs2_predgparam3f_s *param, double targetRadius, int component, double minU, double maxU, double minV, double maxV, int maxSubdivisions, int subdivision)
 {
     struct cs2_spin3f_s sp00, sp01, sp10, sp11;
+    struct cs2_spin3f_s su00, su01, su10, su11;
+    struct cs2_spin3f_s sv00, sv01, sv10, sv11;
 
-    cs2_predgparam3f_eval(&sp00, param, minU, minV, component);
-    cs2_predgparam3f_eval(&sp01, param, minU, maxV, component);
-    cs2_predgparam3f_eval(&sp10, param, maxU, minV, component);
-    cs2_predgparam3f_eval(&sp11, param, maxU, maxV, component);
+    cs2_predgparam3f_eval_d(&sp00, &su00, &sv00, param, minU, minV, component);
+    cs2_predgparam3f_eval_d(&sp01, &su01, &sv01, param, minU, maxV, component);
+    cs2_predgparam3f_eval_d(&sp10, &su10, &sv10, param, maxU, minV, component);
+    cs2_predgparam3f_eval_d(&sp11, &su11, &sv11, param, maxU, maxV, component);
 
     if (subdivision == maxSubdivisions || (projectedDistance(&sp00, &sp01) <= targetRadius && projectedDistance(&sp00, &sp10) <= targetRadius && projectedDistance(&sp00, &sp11) <= targetRadius &&
                                            projectedDistance(&sp01, &sp10) <= targetRadius && projectedDistance(&sp01, &sp11) <= targetRadius && projectedDistance(&sp10, &sp11) <= targetRadius))
@@ -81,13 +108,14 @@ void meshSurfaceAdaptiveStep(TriangleListPtr trianglesFront, TriangleListPtr tri
         QVector3D nu = QVector3D::crossProduct(v00 - v11, v01 - v11).normalized();
         QVector3D nl = QVector3D::crossProduct(v10 - v11, v00 - v11).normalized();
 
+        // flat normals are per face, smooth normals are exact at the vertices
         Triangle tu(v00, v01, v11,
                     nu, nu, nu,
-                    nu, nu, nu);
+                    projectNormal(sp00, su00, sv00, nu), projectNormal(sp01, su01, sv01, nu), projectNormal(sp11, su11, sv11, nu));
 
         Triangle tl(v00, v11, v10,
                     nl, nl, nl,
-                    nl, nl, nl);
+                    projectNormal(sp00, su00, sv00, nl), projectNormal(sp11, su11, sv11, nl), projectNormal(sp10, su10, sv10, nl));
 
         if (trianglesFront)
         {
@@ -31,6 +31,30 @@
 
 CS2_API_BEGIN
 
+/* k-dop directions: 4 axes and 12 diagonals e_i +/- e_j */
+#define CS2_BEZIERQQ4F_KDOP 16
+
+/**
+ * bounding volume of the control points:
+ * - hull: exact convex hull (qhull)
+ * - aabb: axis-aligned box
+ * - kdop: axis-aligned box cut by diagonal slabs (volume and area of its box)
+ * - sphere: ball around the box center
+ * - obb: box oriented by the patch frame (du, dv)
+ */
+enum cs2_bezierbvqq4f_e
+{
+    cs2_bezierbvqq4f_hull,
+    cs2_bezierbvqq4f_aabb,
+    cs2_bezierbvqq4f_kdop,
+    cs2_bezierbvqq4f_sphere,
+    cs2_bezierbvqq4f_obb,
+
+    cs2_bezierbvqq4f_COUNT
+};
+
+CS2_API const char *cs2_bezierbvqq4f_str(enum cs2_bezierbvqq4f_e bv);
+
 /**
  * bezier quadratic-quadratic patch in 4 dimensions
  *
@@ -39,6 +63,9 @@ CS2_API_BEGIN
  * 00 01 02
  * 10 11 12
  * 20 21 22
+ *
+ * cheap bounding volumes are computed with the control points,
+ * the exact hull is built on demand (its volume alone does not build it)
  */
 struct cs2_bezierqq4f_s
 {
@@ -47,8 +74,24 @@ struct cs2_bezierqq4f_s
     struct cs2_vec4f_s p10, p11, p12;
     struct cs2_vec4f_s p20, p21, p22;
 
-    /* hull */
+    /* k-dop (the first 4 slabs are the aabb) */
+    double kmin[CS2_BEZIERQQ4F_KDOP], kmax[CS2_BEZIERQQ4F_KDOP];
+
+    /* sphere */
+    struct cs2_vec4f_s sc;
+    double sr;
+
+    /* oriented box: orthonormal axes and extents along them */
+    struct cs2_vec4f_s ox[4];
+    double omin[4], omax[4];
+
+    /* hull (valid if hv) */
     struct cs2_hull4f_s h;
+    int hv;
+
+    /* hull volume and area, measured without building the hull (valid if hm) */
+    double hvol, harea;
+    int hm;
 };
 
 struct cs2_bezierqq4f_coeff_s
@@ -63,8 +106,37 @@ CS2_API void cs2_bezierqq4f_init(struct cs2_bezierqq4f_s *b);
 CS2_API void cs2_bezierqq4f_clear(struct cs2_bezierqq4f_s *b);
 
 CS2_API void cs2_bezierqq4f_from_qq(struct cs2_bezierqq4f_s *b, const struct cs2_bezierqq4f_coeff_s *c);
+
+/* from control points p00, p01, ..., p22 */
+CS2_API void cs2_bezierqq4f_from_cp(struct cs2_bezierqq4f_s *b, const struct cs2_vec4f_s *p);
+
+/* control points p00, p01, ..., p22 as an array of 9 */
+CS2_API void cs2_bezierqq4f_cp(struct cs2_vec4f_s *p, const struct cs2_bezierqq4f_s *b);
 CS2_API void cs2_bezierqq4f_eval(struct cs2_vec4f_s *r, const struct cs2_bezierqq4f_s *b, double u, double v);
+
+/* max distance of the control points from the bilinear interpolant of the corners */
+CS2_API double cs2_bezierqq4f_flatness(const struct cs2_bezierqq4f_s *b);
+
+/* build the exact hull if it is not built yet (not thread-safe for a shared patch) */
+CS2_API const struct cs2_hull4f_s *cs2_bezierqq4f_hull(struct cs2_bezierqq4f_s *b);
+
+/* the built hull, or one built into 'tmp' (initialized, cleared by the caller) without changing the patch */
+CS2_API const struct cs2_hull4f_s *cs2_bezierqq4f_hull_tmp(const struct cs2_bezierqq4f_s *b, struct cs2_hull4f_s *tmp);
+
+/* volume and area of a bounding volume (the hull is measured, but not built) */
+CS2_API double cs2_bezierqq4f_vol(struct cs2_bezierqq4f_s *b, enum cs2_bezierbvqq4f_e bv);
+CS2_API double cs2_bezierqq4f_area(struct cs2_bezierqq4f_s *b, enum cs2_bezierbvqq4f_e bv);
+
+/* bounding volume test: 0 if the volumes are separated, 1 if they may intersect */
+CS2_API int cs2_bezierqq4f_inter_bv(struct cs2_bezierqq4f_s *p, struct cs2_bezierqq4f_s *q, enum cs2_bezierbvqq4f_e bv);
+
+/**
+ * cheap volumes first, the exact hulls only if all of them are inconclusive:
+ * - inter: hulls that are not built are built into temporaries (read-only, thread-safe)
+ * - inter_lazy: hulls that are not built are built and kept in the patches
+ */
 CS2_API int cs2_bezierqq4f_inter(const struct cs2_bezierqq4f_s *p, const struct cs2_bezierqq4f_s *q);
+CS2_API int cs2_bezierqq4f_inter_lazy(struct cs2_bezierqq4f_s *p, struct cs2_bezierqq4f_s *q);
 
 CS2_API_END
 
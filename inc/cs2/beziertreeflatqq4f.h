@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CS2_BEZIERTREEFLATQQ4F_H
+#define CS2_BEZIERTREEFLATQQ4F_H
+
+#include "defs.h"
+#include "beziertreeqq4f.h"
+#include "vec4f.h"
+#include "plane4f.h"
+#include <stddef.h>
+#include <stdint.h>
+
+CS2_API_BEGIN
+
+/* flat spin bezier tree: no child or parent */
+#define CS2_BEZIERTREEFLATQQ4F_NONE 0xffffffffu
+
+/**
+ * flat spin bezier tree
+ *
+ * a read-only copy of a tree in contiguous arrays, nodes in breadth-first order
+ * (the virtual root is node 0, the four children of a node are consecutive);
+ * per-node data is stored as structure of arrays, hulls in a separate pool
+ */
+struct cs2_beziertreeflatqq4f_s
+{
+    size_t n;
+
+    /* first child, parent */
+    uint32_t *c, *p;
+
+    /* domain [u0, u2] x [v0, v2] */
+    double *u0, *u2, *v0, *v2;
+
+    /* node volume, subtree volume */
+    double *vol, *svol;
+
+    /* control points: coordinate j of control point k (p00, p01, ..., p22) of node i is cp[(4 * k + j) * n + i] */
+    double *cp;
+
+    /* k-dop slabs kmin[k * n + i], kmax[k * n + i], sphere center sc[j * n + i] and radius sr[i] */
+    double *kmin, *kmax, *sc, *sr;
+
+    /* hull pool: planes [ho[i], ho[i + 1]) and vertices [vo[i], vo[i + 1]) of node i, empty if not built */
+    struct cs2_plane4f_s *hr;
+    struct cs2_vec4f_s *vr;
+    size_t *ho, *vo;
+};
+
+CS2_API void cs2_beziertreeflatqq4f_init(struct cs2_beziertreeflatqq4f_s *fl);
+CS2_API void cs2_beziertreeflatqq4f_clear(struct cs2_beziertreeflatqq4f_s *fl);
+
+CS2_API void cs2_beziertreeflatqq4f_from_tree(struct cs2_beziertreeflatqq4f_s *fl, struct cs2_beziertreeqq4f_s *t);
+
+/* child k (uv index 2 * u + v) of node i, CS2_BEZIERTREEFLATQQ4F_NONE for leaves */
+CS2_API uint32_t cs2_beziertreeflatqq4f_child(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i, int k);
+CS2_API uint32_t cs2_beziertreeflatqq4f_parent(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i);
+CS2_API int cs2_beziertreeflatqq4f_is_leaf(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i);
+
+/* leaf containing (u, v) */
+CS2_API uint32_t cs2_beziertreeflatqq4f_locate(const struct cs2_beziertreeflatqq4f_s *fl, double u, double v);
+
+/* patch of node i at (u, v) of its domain */
+CS2_API void cs2_beziertreeflatqq4f_eval(struct cs2_vec4f_s *r, const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i, double u, double v);
+
+/* volume of the leaves under node i */
+CS2_API double cs2_beziertreeflatqq4f_vol(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i);
+
+/**
+ * flat spin bezier tree leaf pair
+ */
+struct cs2_beziertreeflatpairqq4f_s
+{
+    uint32_t a, b;
+};
+
+struct cs2_beziertreeflatpairsqq4f_s
+{
+    struct cs2_beziertreeflatpairqq4f_s *p;
+    size_t n, cap;
+};
+
+CS2_API void cs2_beziertreeflatpairsqq4f_init(struct cs2_beziertreeflatpairsqq4f_s *ps);
+CS2_API void cs2_beziertreeflatpairsqq4f_clear(struct cs2_beziertreeflatpairsqq4f_s *ps);
+
+/**
+ * flat tree-vs-tree intersection:
+ *
+ * pairs of leaves (a of fa, b of fb) whose k-dops, spheres and (if present) hulls
+ * intersect are appended to 'ps'; the trees are not refined
+ */
+CS2_API void cs2_beziertreeflatqq4f_inter(struct cs2_beziertreeflatpairsqq4f_s *ps, const struct cs2_beziertreeflatqq4f_s *fa, const struct cs2_beziertreeflatqq4f_s *fb);
+
+CS2_API_END
+
+#endif /* CS2_BEZIERTREEFLATQQ4F_H */
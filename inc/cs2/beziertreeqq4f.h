@@ -28,6 +28,8 @@
 #include "defs.h"
 #include "bezierqq4f.h"
 #include "vec4f.h"
+#include "pool.h"
+#include <stdint.h>
 
 CS2_API_BEGIN
 
@@ -43,6 +45,10 @@ struct cs2_beziertreenodeqq4f_s
 
     double vol, area;
 
+    /* leaves of the subtree: total volume and area, max volume (infinite if virtual), count */
+    double svol, sarea, smax;
+    size_t sc;
+
     struct cs2_beziertreeqq4f_s *r;
     struct cs2_beziertreenodeqq4f_s *p;
 
@@ -62,22 +68,53 @@ CS2_API void cs2_beziertreenodeqq4f_clear(struct cs2_beziertreenodeqq4f_s *n);
 CS2_API void cs2_beziertreenodeqq4f_sub(struct cs2_beziertreenodeqq4f_s *n);
 CS2_API int cs2_beziertreenodeqq4f_is_virt(struct cs2_beziertreenodeqq4f_s *n);
 CS2_API int cs2_beziertreenodeqq4f_is_leaf(struct cs2_beziertreenodeqq4f_s *n);
+
+/* subtree aggregates, updated on each split */
 CS2_API double cs2_beziertreenodeqq4f_vol(struct cs2_beziertreenodeqq4f_s *n);
 CS2_API double cs2_beziertreenodeqq4f_area(struct cs2_beziertreenodeqq4f_s *n);
+CS2_API size_t cs2_beziertreenodeqq4f_leaves(struct cs2_beziertreenodeqq4f_s *n);
+CS2_API double cs2_beziertreenodeqq4f_max_vol(struct cs2_beziertreenodeqq4f_s *n);
 
 /**
  * spin bezier tree func
  */
 typedef void (*cs2_beziertreeqq4f_func_t)(struct cs2_vec4f_s *r, double u, double v, void *d);
 
+struct cs2_beziertreecacheqq4f_s;
+
 /**
  * spin bezier tree
+ *
+ * nodes and leaf list entries are allocated from pools owned by the tree,
+ * clearing the tree releases them at once
+ *
+ * samples of the tree func are cached by (u, v), so that points shared by a node,
+ * its children and their neighbours are evaluated once per tree; the cache is
+ * bounded (about 12 MiB, full parts start over) and may be dropped after refinement
+ *
+ * node volume and area are those of the bounding volume 'bv' (hull by default),
+ * it is selected before the tree is built from a func
  */
 struct cs2_beziertreeqq4f_s
 {
     cs2_beziertreeqq4f_func_t f;
     void *d;
     struct cs2_beziertreenodeqq4f_s *rn; /* virtual */
+
+    /* bounding volume */
+    enum cs2_bezierbvqq4f_e bv;
+
+    /* sample cache */
+    struct cs2_beziertreecacheqq4f_s *sc;
+
+    /* node pool */
+    struct cs2_pool_s np;
+
+    /* leaf pool */
+    struct cs2_pool_s lp;
+
+    /* memory of hulls built by tree queries (intersection, images) */
+    size_t hb;
 };
 
 CS2_API void cs2_beziertreeqq4f_init(struct cs2_beziertreeqq4f_s *t);
@@ -86,6 +123,41 @@ CS2_API void cs2_beziertreeqq4f_clear(struct cs2_beziertreeqq4f_s *t);
 CS2_API void cs2_beziertreeqq4f_from_func(struct cs2_beziertreeqq4f_s *t, cs2_beziertreeqq4f_func_t f, void *d);
 CS2_API double cs2_beziertreeqq4f_vol(struct cs2_beziertreeqq4f_s *t);
 CS2_API double cs2_beziertreeqq4f_area(struct cs2_beziertreeqq4f_s *t);
+CS2_API size_t cs2_beziertreeqq4f_leaves(struct cs2_beziertreeqq4f_s *t);
+CS2_API double cs2_beziertreeqq4f_max_vol(struct cs2_beziertreeqq4f_s *t);
+
+/**
+ * switches the bounding volume and measures the leaves with it (in parallel), inner
+ * nodes keep the volume they were split at; refining with a cheap volume or by
+ * flatness and switching to the hull measures hulls of final leaves only
+ */
+CS2_API void cs2_beziertreeqq4f_set_bv(struct cs2_beziertreeqq4f_s *t, enum cs2_bezierbvqq4f_e bv);
+
+/* memory of the tree: node and leaf pools, the sample cache and hulls built by tree queries */
+CS2_API size_t cs2_beziertreeqq4f_bytes(struct cs2_beziertreeqq4f_s *t);
+
+/* frees the cached samples (statistics are kept), later splits fill the cache again */
+CS2_API void cs2_beziertreeqq4f_drop_cache(struct cs2_beziertreeqq4f_s *t);
+
+/* number of samples taken from the cache and evaluated by the tree func */
+CS2_API void cs2_beziertreeqq4f_cache_stats(struct cs2_beziertreeqq4f_s *t, size_t *hits, size_t *misses);
+
+/**
+ * spin bezier tree hulls: hulls of a list of nodes, built in parallel without
+ * changing the nodes; built hulls are shared, the others are temporaries
+ * (NULL for the virtual root)
+ */
+struct cs2_beziertreehullsqq4f_s
+{
+    const struct cs2_hull4f_s **h;
+    struct cs2_hull4f_s *tmp;
+    size_t n;
+};
+
+CS2_API void cs2_beziertreehullsqq4f_init(struct cs2_beziertreehullsqq4f_s *hs);
+CS2_API void cs2_beziertreehullsqq4f_clear(struct cs2_beziertreehullsqq4f_s *hs);
+
+CS2_API void cs2_beziertreehullsqq4f_build(struct cs2_beziertreehullsqq4f_s *hs, struct cs2_beziertreenodeqq4f_s *const *nl, size_t n);
 
 /**
  * spin bezier tree leaf
@@ -96,17 +168,226 @@ struct cs2_beziertreeleafqq4f_s
     struct cs2_beziertreeleafqq4f_s *next;
 };
 
+/**
+ * leaf list: entries belong to the tree, so a list is cleared before its tree
+ * (or not at all, clearing the tree releases the entries too)
+ */
 struct cs2_beziertreeleafsqq4f_s
 {
     struct cs2_beziertreeleafqq4f_s *l;
     size_t c;
+
+    struct cs2_beziertreeqq4f_s *t;
 };
 
 CS2_API void cs2_beziertreeleafsqq4f_init(struct cs2_beziertreeleafsqq4f_s *l, struct cs2_beziertreeqq4f_s *t);
 CS2_API void cs2_beziertreeleafsqq4f_clear(struct cs2_beziertreeleafsqq4f_s *l);
 
+/**
+ * spin bezier tree refinement priority (split measure): leaves with larger values
+ * are split first, leaves at or below a threshold are not split
+ */
+typedef double (*cs2_beziertreeprioqq4f_func_t)(const struct cs2_beziertreenodeqq4f_s *n, void *d);
+
+/**
+ * control net flatness of a node: distance of the control points from the bilinear
+ * interpolant of the corners (no hull is needed)
+ */
+CS2_API double cs2_beziertreenodeqq4f_flatness(const struct cs2_beziertreenodeqq4f_s *n, void *d);
+
+/* splits leaves until f (volume if null) is at most 'thr' for all of them */
+CS2_API void cs2_beziertreeleafsqq4f_sub(struct cs2_beziertreeleafsqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d, double thr);
 CS2_API void cs2_beziertreeleafsqq4f_sub_vol(struct cs2_beziertreeleafsqq4f_s *l, double vol);
 
+/**
+ * parallel refinement:
+ *
+ * same result as cs2_beziertreeleafsqq4f_sub_vol (tree and leaf order do not depend
+ * on the number of threads); leaves are split in rounds, child nodes of a round are
+ * evaluated on cs2_thread_count() threads, so the tree func must be thread-safe
+ */
+CS2_API void cs2_beziertreeleafsqq4f_sub_par(struct cs2_beziertreeleafsqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d, double thr);
+CS2_API void cs2_beziertreeleafsqq4f_sub_vol_par(struct cs2_beziertreeleafsqq4f_s *l, double vol);
+
+/**
+ * spin bezier tree refinement budget (zero means unlimited, at least one limit must be set):
+ * - leaves: maximal number of leaves
+ * - bytes: maximal cs2_beziertreeqq4f_bytes of the tree (a split is not made if its
+ *   estimated growth does not fit)
+ * - usec: maximal time of a single run (a run makes at least one split)
+ * - prio: leaves with priority at or below are not split (-INFINITY for no threshold)
+ */
+struct cs2_beziertreebudgetqq4f_s
+{
+    size_t leaves;
+    size_t bytes;
+    uint64_t usec;
+    double prio;
+};
+
+struct cs2_beziertreeheapqq4f_s
+{
+    double prio;
+    struct cs2_beziertreeleafqq4f_s *l;
+};
+
+/**
+ * spin bezier tree refinement:
+ *
+ * splits the leaf with the highest priority first (hull volume by default, virtual
+ * leaves first) until a budget is exhausted; runs are resumable, the leaf list
+ * must not be refined by other means while a refinement is attached to it
+ */
+struct cs2_beziertreerefineqq4f_s
+{
+    struct cs2_beziertreeleafsqq4f_s *l;
+
+    /* priority */
+    cs2_beziertreeprioqq4f_func_t f;
+    void *d;
+
+    /* max-heap of leaves */
+    struct cs2_beziertreeheapqq4f_s *h;
+    size_t n, cap;
+};
+
+CS2_API void cs2_beziertreerefineqq4f_init(struct cs2_beziertreerefineqq4f_s *r, struct cs2_beziertreeleafsqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d);
+CS2_API void cs2_beziertreerefineqq4f_clear(struct cs2_beziertreerefineqq4f_s *r);
+
+/* highest priority of a leaf, -inf if there are no leaves */
+CS2_API double cs2_beziertreerefineqq4f_top(const struct cs2_beziertreerefineqq4f_s *r);
+
+/* returns the number of splits */
+CS2_API size_t cs2_beziertreerefineqq4f_run(struct cs2_beziertreerefineqq4f_s *r, const struct cs2_beziertreebudgetqq4f_s *b);
+
+/**
+ * spin bezier tree node pair
+ */
+struct cs2_beziertreepairqq4f_s
+{
+    struct cs2_beziertreenodeqq4f_s *a, *b;
+};
+
+struct cs2_beziertreepairsqq4f_s
+{
+    struct cs2_beziertreepairqq4f_s *p;
+    size_t n, cap;
+};
+
+CS2_API void cs2_beziertreepairsqq4f_init(struct cs2_beziertreepairsqq4f_s *ps);
+CS2_API void cs2_beziertreepairsqq4f_clear(struct cs2_beziertreepairsqq4f_s *ps);
+
+/**
+ * tree-vs-tree intersection:
+ *
+ * simultaneous descent of both trees; pairs of nodes with separated bounding volumes
+ * are pruned (cheap volumes first, hulls only if they are inconclusive) and the larger
+ * node of a pair is descended into until both have volume at most 'vol'; such candidate
+ * pairs (a from ta, b from tb) are appended to 'ps'
+ *
+ * missing children are created on demand, so both trees grow (leaf lists are not
+ * updated); the descent runs in rounds, with 'par' set each round runs on
+ * cs2_thread_count() threads and the tree funcs must be thread-safe; the result
+ * does not depend on 'par'
+ */
+CS2_API void cs2_beziertreeqq4f_inter(struct cs2_beziertreepairsqq4f_s *ps, struct cs2_beziertreeqq4f_s *ta, struct cs2_beziertreeqq4f_s *tb, double vol, int par);
+
+/* spin bezier tree image: no child or parent */
+#define CS2_BEZIERTREEIMGQQ4F_NONE 0xffffffffu
+
+/* spin bezier tree image: maximal depth of a node (dyadic (u, v) are exact far below it) */
+#define CS2_BEZIERTREEIMGQQ4F_DEPTH 64
+
+/**
+ * spin bezier tree image header
+ *
+ * sections (8-byte aligned, native byte order) follow at byte offsets 'on', 'op', 'ov'
+ */
+struct cs2_beziertreeimghdrqq4f_s
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t order; /* byte order mark */
+
+    /* key of the tree func, bounding volume */
+    uint64_t key;
+    uint32_t bv;
+    uint32_t reserved;
+
+    /* number of nodes, hull planes and hull vertices */
+    uint64_t nn, np, nv;
+
+    /* section offsets, file size */
+    uint64_t on, op, ov;
+    uint64_t size;
+};
+
+/**
+ * spin bezier tree image node
+ *
+ * nodes are stored in preorder, the virtual root first
+ */
+struct cs2_beziertreeimgnodeqq4f_s
+{
+    /* control points p00, p01, ..., p22 */
+    struct cs2_vec4f_s cp[9];
+
+    double u0, u1, u2;
+    double v0, v1, v2;
+
+    double vol, area;
+
+    /* hull: ranges of the plane and vertex sections, nhr = nvr = 0 if not built */
+    double hvol, harea;
+    uint64_t hr, nhr, vr, nvr;
+
+    /* children (uv order) and parent */
+    uint32_t c[4];
+    uint32_t p;
+    uint32_t hv;
+};
+
+/**
+ * spin bezier tree image: a read-only tree mapped from a file
+ *
+ * pages are shared between processes mapping the same file
+ */
+struct cs2_beziertreeimgqq4f_s
+{
+    void *m;
+    size_t size;
+
+    const struct cs2_beziertreeimghdrqq4f_s *h;
+    const struct cs2_beziertreeimgnodeqq4f_s *n;
+    const struct cs2_plane4f_s *hr;
+    const struct cs2_vec4f_s *vr;
+};
+
+/* key of a tree func: 64-bit fnv-1a hash of its data, chained by 'seed' (0 to start) */
+CS2_API uint64_t cs2_beziertreeimgqq4f_key(const void *d, size_t n, uint64_t seed);
+
+/**
+ * writes a tree with hulls of all nodes (atomically replacing 'path' through a unique
+ * temporary file next to it), returns 0 on success and -1 on error or if the tree is
+ * deeper than CS2_BEZIERTREEIMGQQ4F_DEPTH
+ */
+CS2_API int cs2_beziertreeqq4f_save(struct cs2_beziertreeqq4f_s *t, const char *path, uint64_t key);
+
+CS2_API void cs2_beziertreeimgqq4f_init(struct cs2_beziertreeimgqq4f_s *img);
+CS2_API void cs2_beziertreeimgqq4f_clear(struct cs2_beziertreeimgqq4f_s *img);
+
+/* maps a tree file, returns -1 if it is missing, malformed or has another key */
+CS2_API int cs2_beziertreeimgqq4f_load(struct cs2_beziertreeimgqq4f_s *img, const char *path, uint64_t key);
+
+/* read-only hull of node i: a view into the image stored in 'h', which is not to be modified or cleared */
+CS2_API const struct cs2_hull4f_s *cs2_beziertreeimgqq4f_hull(struct cs2_hull4f_s *h, const struct cs2_beziertreeimgqq4f_s *img, size_t i);
+
+/**
+ * a live tree from an image (no evaluation of the tree func); the tree func is used
+ * by further refinement and must be the one the image was saved with
+ */
+CS2_API void cs2_beziertreeqq4f_from_img(struct cs2_beziertreeqq4f_s *t, const struct cs2_beziertreeimgqq4f_s *img, cs2_beziertreeqq4f_func_t f, void *d);
+
 CS2_API_END
 
 #endif /* CS2_BEZIERTREEQQ4F_H */
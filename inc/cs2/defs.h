@@ -42,4 +42,11 @@
 
 #define CS2_NORETURN __attribute__((noreturn))
 
+/* simd kernels: dispatch between avx-512, avx2 and generic clones at load time */
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 6) && defined(__x86_64__) && defined(__linux__)
+#define CS2_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define CS2_SIMD_CLONES
+#endif
+
 #endif /* CS2_DEFS_H */
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CS2_FILTER3X_H
+#define CS2_FILTER3X_H
+
+#include "defs.h"
+#include <stdint.h>
+#include <gmp.h>
+
+CS2_API_BEGIN
+
+/**
+ * filtered exact predicates:
+ *
+ * a predicate is first evaluated in double precision together with an error bound;
+ * exact integer arithmetic runs only when the bound does not certify the result
+ *
+ * fixed-width exact kernels:
+ *
+ * when input magnitudes fit a bit budget, the exact formulas run in native 128-bit
+ * integers; gmp arithmetic runs only when the result could overflow
+ *
+ * a hit is a call answered without gmp arithmetic
+ */
+enum cs2_filter3x_e
+{
+    cs2_filter3x_spinquad3x_sign,
+    cs2_filter3x_predg3x_type,
+    cs2_filter3x_spinquad3x_eval,
+    cs2_filter3x_spinquad3x_from_predg3x,
+
+    cs2_filter3x_COUNT
+};
+
+CS2_API const char *cs2_filter3x_str(enum cs2_filter3x_e f);
+
+struct cs2_filter3x_stats_s
+{
+    /* number of predicate calls */
+    uint64_t calls;
+
+    /* number of calls certified by the floating-point filter */
+    uint64_t hits;
+};
+
+CS2_API void cs2_filter3x_stats(struct cs2_filter3x_stats_s *stats, enum cs2_filter3x_e f);
+CS2_API void cs2_filter3x_reset_stats(void);
+
+/* records a single call */
+CS2_API void cs2_filter3x_record(enum cs2_filter3x_e f, int hit);
+
+/* double approximation of an integer, relative error below DBL_EPSILON (inf on overflow) */
+CS2_API double cs2_filter3x_get_d(mpz_srcptr x);
+
+#if defined(__SIZEOF_INT128__) && (__SIZEOF_LONG__ == 8)
+#define CS2_FILTER3X_INT128
+
+typedef __int128 cs2_int128_t;
+
+/* r = x, returns the bit size of x or -1 if x does not fit in 63 bits */
+CS2_API int cs2_filter3x_get_si(long *r, mpz_srcptr x);
+
+/* r = x */
+CS2_API void cs2_filter3x_set_i128(mpz_ptr r, cs2_int128_t x);
+#endif /* defined(__SIZEOF_INT128__) && (__SIZEOF_LONG__ == 8) */
+
+CS2_API_END
+
+#endif /* CS2_FILTER3X_H */
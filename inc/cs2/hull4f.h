@@ -47,6 +47,9 @@ struct cs2_hull4f_s
     struct cs2_vec4f_s *vr;
     size_t nvr;
 
+    /* v-rep mirror in structure-of-arrays form: x, y, z and w blocks of nvr (optional, doubles the v-rep memory) */
+    double *vs;
+
     /* volume and area */
     double vol, area;
 };
@@ -54,9 +57,42 @@ struct cs2_hull4f_s
 CS2_API void cs2_hull4f_init(struct cs2_hull4f_s *h);
 CS2_API void cs2_hull4f_clear(struct cs2_hull4f_s *h);
 
+/* point sets up to this size are hulled by a stack-only kernel, larger ones by qhull */
+#define CS2_HULL4F_SMALL_N 16
+
 CS2_API void cs2_hull4f_from_arr(struct cs2_hull4f_s *h, const struct cs2_vec4f_s *v, size_t n);
+
+/* volume and area only: no h-rep or v-rep is extracted (no allocation for small sets) */
+CS2_API void cs2_hull4f_measure_arr(double *vol, double *area, const struct cs2_vec4f_s *v, size_t n);
+
+/* builds the soa mirror of the v-rep (done by from_arr, optional for hulls assembled by hand) */
+CS2_API void cs2_hull4f_soa(struct cs2_hull4f_s *h);
+
+/* heap memory of the h-rep, the v-rep and its soa mirror */
+CS2_API size_t cs2_hull4f_bytes(const struct cs2_hull4f_s *h);
+
+/**
+ * small point set hull (beneath-beyond, no heap use during construction);
+ * coplanar facets are merged in the h-rep, returns -1 for more than
+ * CS2_HULL4F_SMALL_N points or (nearly) degenerate input
+ */
+CS2_API int cs2_hull4f_from_arr_small(struct cs2_hull4f_s *h, const struct cs2_vec4f_s *v, size_t n);
 CS2_API int cs2_hull4f_inter(const struct cs2_hull4f_s *ha, const struct cs2_hull4f_s *hb);
 
+/**
+ * gjk distance of the convex hulls of two point sets (no h-rep is needed):
+ *
+ *    max w * a + dist = min w * b, a in va, b in vb
+ *
+ * 'w' is the unit separating direction from a to b, a non-zero 'w' on input is used
+ * as the initial direction (e.g. the witness of a previous query of a moving pair);
+ * returns 1 if the hulls intersect (dist is zero and w is left unchanged);
+ * the _it variant also reports the number of iterations (if 'iters' is not null)
+ */
+CS2_API int cs2_hull4f_gjk_arr_it(double *dist, struct cs2_vec4f_s *w, const struct cs2_vec4f_s *va, size_t na, const struct cs2_vec4f_s *vb, size_t nb, int *iters);
+CS2_API int cs2_hull4f_gjk_arr(double *dist, struct cs2_vec4f_s *w, const struct cs2_vec4f_s *va, size_t na, const struct cs2_vec4f_s *vb, size_t nb);
+CS2_API int cs2_hull4f_gjk(double *dist, struct cs2_vec4f_s *w, const struct cs2_hull4f_s *ha, const struct cs2_hull4f_s *hb);
+
 CS2_API void cs2_hull4f_print_json(struct cs2_hull4f_s *h, FILE *f, size_t indent);
 
 CS2_API_END
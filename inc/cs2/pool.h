@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CS2_POOL_H
+#define CS2_POOL_H
+
+#include "defs.h"
+#include <stddef.h>
+
+CS2_API_BEGIN
+
+/**
+ * fixed-size object pool:
+ *
+ * objects are carved from slabs of growing size and recycled through a free list;
+ * clearing the pool releases all objects at once
+ */
+struct cs2_pool_s
+{
+    /* object size (aligned) */
+    size_t size;
+
+    /* objects in the next slab */
+    size_t grow;
+
+    /* slab list */
+    void *slabs;
+
+    /* unused part of the current slab */
+    char *cur, *end;
+
+    /* recycled objects */
+    void *free;
+
+    /* number of live objects */
+    size_t count;
+};
+
+CS2_API void cs2_pool_init(struct cs2_pool_s *p, size_t size);
+CS2_API void cs2_pool_clear(struct cs2_pool_s *p);
+
+CS2_API void *cs2_pool_alloc(struct cs2_pool_s *p);
+CS2_API void cs2_pool_free(struct cs2_pool_s *p, void *ptr);
+
+#define CS2_POOL_ALLOC(Pool, Type) ((Type *)cs2_pool_alloc(Pool))
+
+#define CS2_POOL_FREE(Pool, Ptr) \
+    do { if (Ptr) cs2_pool_free(Pool, Ptr); } while (0)
+
+CS2_API_END
+
+#endif /* CS2_POOL_H */
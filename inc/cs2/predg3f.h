@@ -32,6 +32,7 @@
 #include "predh3f.h"
 #include "preds3f.h"
 #include "spin3f.h"
+#include <stddef.h>
 
 CS2_API_BEGIN
 
@@ -131,8 +132,70 @@ struct cs2_predgparam3f_s
 };
 
 CS2_API void cs2_predg3f_param(struct cs2_predgparam3f_s *pgp, const struct cs2_predg3f_s *pg);
+
+/* bulk parametrization: pgp[i] = param(pg[i]), i = 0, ..., n - 1 (multi-threaded) */
+CS2_API void cs2_predg3f_param_n(struct cs2_predgparam3f_s *pgp, const struct cs2_predg3f_s *pg, size_t n);
+
 CS2_API void cs2_predgparam3f_eval(struct cs2_spin3f_s *s, const struct cs2_predgparam3f_s *pgp, double u, double v, int domain_component);
 
+/**
+ * evaluation with partial derivatives:
+ *
+ *    s = eval(u, v), su = d eval / du, sv = d eval / dv
+ *
+ * one-sided (v >= 0.5) at the fold of barrels and caps; zero where a parametrization is singular
+ */
+CS2_API void cs2_predgparam3f_eval_d(struct cs2_spin3f_s *s, struct cs2_spin3f_s *su, struct cs2_spin3f_s *sv, const struct cs2_predgparam3f_s *pgp, double u, double v, int domain_component);
+
+/**
+ * inverse parametrization:
+ *
+ *    (u, v, domain_component) such that eval(u, v, domain_component) is closest to s
+ *
+ * closed form, polished by a few gauss-newton steps for spins off the zero set;
+ * returns the residual |eval(u, v, domain_component) - s|
+ */
+CS2_API double cs2_predgparam3f_inv(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pgp, const struct cs2_spin3f_s *s);
+
+/**
+ * batch evaluation:
+ *
+ *    (s12[i], s23[i], s31[i], s0[i]) = eval(u[i], v[i]), i = 0, ..., n - 1
+ *
+ * output is in structure-of-arrays form
+ */
+CS2_API void cs2_predgparam3f_eval_n(double *s12, double *s23, double *s31, double *s0, const struct cs2_predgparam3f_s *pgp, const double *u, const double *v, size_t n, int domain_component);
+
+/**
+ * evaluation plan:
+ *
+ * a parametrization specialized for a single domain component; all per-predicate
+ * invariants are computed once and the eigenmatrix is stored by columns, so that
+ * the rotation is a chain of multiply-adds
+ *
+ * 'f' is the specialized evaluator, it can be called directly (no domain checks)
+ */
+struct cs2_predgplan3f_s
+{
+    /* evaluator */
+    void (*f)(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v);
+
+    /* parametrization type */
+    enum cs2_predgparamtype3f_e t;
+
+    /* domain component */
+    int dc;
+
+    /* invariants */
+    double k[8];
+
+    /* eigenmatrix columns (prescaled for toroidal cases) */
+    double m[4][4];
+};
+
+CS2_API void cs2_predgparam3f_plan(struct cs2_predgplan3f_s *pl, const struct cs2_predgparam3f_s *pgp, int domain_component);
+CS2_API void cs2_predgplan3f_eval(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v);
+
 CS2_API_END
 
 #endif /* CS2_PREDG3F_H */
@@ -36,6 +36,8 @@
 
 CS2_API_BEGIN
 
+struct cs2_xctx_s;
+
 /**
  * general predicate:
  *
@@ -51,8 +53,10 @@ CS2_API void cs2_predg3x_init(struct cs2_predg3x_s *g);
 CS2_API void cs2_predg3x_clear(struct cs2_predg3x_s *g);
 
 CS2_API void cs2_predg3x_from_predh3x(struct cs2_predg3x_s *g, const struct cs2_predh3x_s *h);
+CS2_API void cs2_predg3x_from_predh3x_ctx(struct cs2_predg3x_s *g, const struct cs2_predh3x_s *h, struct cs2_xctx_s *xc);
 CS2_API void cs2_predg3x_from_preds3x(struct cs2_predg3x_s *g, const struct cs2_preds3x_s *s);
 CS2_API void cs2_predg3x_pquv(struct cs2_vec3x_s *p, struct cs2_vec3x_s *q, struct cs2_vec3x_s *u, struct cs2_vec3x_s *v, const struct cs2_predg3x_s *g);
+CS2_API void cs2_predg3x_pquv_ctx(struct cs2_vec3x_s *p, struct cs2_vec3x_s *q, struct cs2_vec3x_s *u, struct cs2_vec3x_s *v, const struct cs2_predg3x_s *g, struct cs2_xctx_s *xc);
 
 /* type */
 enum cs2_predgtype3x_e
@@ -67,6 +71,11 @@ enum cs2_predgtype3x_e
 CS2_API const char *cs2_predgtype3x_str(enum cs2_predgtype3x_e pgt);
 
 CS2_API enum cs2_predgtype3x_e cs2_predg3x_type(const struct cs2_predg3x_s *pg);
+CS2_API enum cs2_predgtype3x_e cs2_predg3x_type_ctx(const struct cs2_predg3x_s *pg, struct cs2_xctx_s *xc);
+
+/* same as cs2_predg3x_type (filtered, exact) */
+CS2_API enum cs2_predgtype3x_e cs2_predg3x_type_filtered(const struct cs2_predg3x_s *pg);
+CS2_API enum cs2_predgtype3x_e cs2_predg3x_type_filtered_ctx(const struct cs2_predg3x_s *pg, struct cs2_xctx_s *xc);
 
 CS2_API_END
 
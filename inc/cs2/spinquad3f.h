@@ -62,6 +62,31 @@ CS2_API void cs2_spinquad3f_from_predg3f(struct cs2_spinquad3f_s *sq, const stru
 
 CS2_API double cs2_spinquad3f_eval(const struct cs2_spinquad3f_s *sq, const struct cs2_spin3f_s *s);
 
+/**
+ * spin box:
+ *
+ *    lo <= s <= hi (componentwise)
+ */
+struct cs2_spinbox3f_s
+{
+    struct cs2_spin3f_s lo, hi;
+};
+
+/**
+ * range evaluation:
+ *
+ *    [rmin, rmax] contains F(s) for every s in the box, or for every unit s in the cap |s - c| <= r
+ *
+ * bounds are conservative (rounding errors included); box bounds are the intersection of
+ * the natural interval extension and the centered form, cap bounds are centered at the unit
+ * spin c; sign is -1 or +1 if certified on the whole region, 0 otherwise
+ */
+CS2_API void cs2_spinquad3f_eval_box(double *rmin, double *rmax, const struct cs2_spinquad3f_s *sq, const struct cs2_spinbox3f_s *b);
+CS2_API int cs2_spinquad3f_sign_box(const struct cs2_spinquad3f_s *sq, const struct cs2_spinbox3f_s *b);
+
+CS2_API void cs2_spinquad3f_eval_cap(double *rmin, double *rmax, const struct cs2_spinquad3f_s *sq, const struct cs2_spin3f_s *c, double r);
+CS2_API int cs2_spinquad3f_sign_cap(const struct cs2_spinquad3f_s *sq, const struct cs2_spin3f_s *c, double r);
+
 CS2_API double cs2_spinquad3f_len(const struct cs2_spinquad3f_s *sq);
 CS2_API double cs2_spinquad3f_sqlen(const struct cs2_spinquad3f_s *sq);
 
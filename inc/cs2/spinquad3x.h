@@ -62,8 +62,14 @@ CS2_API void cs2_spinquad3x_clear(struct cs2_spinquad3x_s *sq);
 CS2_API void cs2_spinquad3x_from_predh3x(struct cs2_spinquad3x_s *sq, const struct cs2_predh3x_s *ph);
 CS2_API void cs2_spinquad3x_from_preds3x(struct cs2_spinquad3x_s *sq, const struct cs2_preds3x_s *ps);
 CS2_API void cs2_spinquad3x_from_predg3x(struct cs2_spinquad3x_s *sq, const struct cs2_predg3x_s *pg);
+CS2_API void cs2_spinquad3x_from_predg3x_ctx(struct cs2_spinquad3x_s *sq, const struct cs2_predg3x_s *pg, struct cs2_xctx_s *xc);
 
 CS2_API void cs2_spinquad3x_eval(mpz_ptr s, const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p);
+CS2_API void cs2_spinquad3x_eval_ctx(mpz_ptr s, const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p, struct cs2_xctx_s *xc);
+
+/* sign of F(p) (filtered, exact) */
+CS2_API int cs2_spinquad3x_sign(const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p);
+CS2_API int cs2_spinquad3x_sign_ctx(const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p, struct cs2_xctx_s *xc);
 
 CS2_API_END
 
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CS2_SPINQUADBANK3F_H
+#define CS2_SPINQUADBANK3F_H
+
+#include "defs.h"
+#include "spinquad3f.h"
+#include "spin3f.h"
+#include <stddef.h>
+#include <stdint.h>
+
+CS2_API_BEGIN
+
+/**
+ * spin quadric bank:
+ *
+ *    n spin quadrics in structure-of-arrays form
+ *
+ * coefficients are stored as c[k * cap + i], k = 0, ..., 9 in the order
+ * a11, a22, a33, a44, 2 a12, 2 a13, 2 a14, 2 a23, 2 a24, 2 a34;
+ * capacity is a multiple of 64 and unused slots are zero
+ *
+ * sign masks: bit (i % 64) of word (i / 64) refers to quadric i
+ */
+struct cs2_spinquadbank3f_s
+{
+    double *c;
+    size_t n, cap;
+};
+
+CS2_API void cs2_spinquadbank3f_init(struct cs2_spinquadbank3f_s *b);
+CS2_API void cs2_spinquadbank3f_clear(struct cs2_spinquadbank3f_s *b);
+
+CS2_API void cs2_spinquadbank3f_reserve(struct cs2_spinquadbank3f_s *b, size_t n);
+CS2_API size_t cs2_spinquadbank3f_add(struct cs2_spinquadbank3f_s *b, const struct cs2_spinquad3f_s *sq);
+CS2_API void cs2_spinquadbank3f_get(struct cs2_spinquad3f_s *sq, const struct cs2_spinquadbank3f_s *b, size_t i);
+
+/* number of 64-bit words in a sign mask */
+CS2_API size_t cs2_spinquadbank3f_mask_size(const struct cs2_spinquadbank3f_s *b);
+
+/* f[i] = F_i(s), i = 0, ..., n - 1 */
+CS2_API void cs2_spinquadbank3f_eval(double *f, const struct cs2_spinquadbank3f_s *b, const struct cs2_spin3f_s *s);
+
+/* pos: F_i(s) > 0, neg: F_i(s) < 0 (optional) */
+CS2_API void cs2_spinquadbank3f_sign(uint64_t *pos, uint64_t *neg, const struct cs2_spinquadbank3f_s *b, const struct cs2_spin3f_s *s);
+
+/**
+ * batch of spins in structure-of-arrays form:
+ *
+ *    masks of spin j start at pos + j * mask_size (neg respectively)
+ */
+CS2_API void cs2_spinquadbank3f_sign_n(uint64_t *pos, uint64_t *neg, const struct cs2_spinquadbank3f_s *b, const double *s12, const double *s23, const double *s31, const double *s0, size_t n);
+
+CS2_API_END
+
+#endif /* CS2_SPINQUADBANK3F_H */
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CS2_THREAD_H
+#define CS2_THREAD_H
+
+#include "defs.h"
+#include <stddef.h>
+
+CS2_API_BEGIN
+
+/* processes a range [begin, end) of work items */
+typedef void (*cs2_thread_range_func_t)(size_t begin, size_t end, void *d);
+
+/* number of worker threads: 0 = hardware concurrency */
+CS2_API int cs2_thread_count(void);
+CS2_API void cs2_thread_set_count(int count);
+
+/**
+ * parallel for:
+ *
+ * splits [0, n) into ranges of at most 'grain' items and processes them
+ * on up to cs2_thread_count() threads; the calling thread takes part in the work,
+ * returns when all ranges are done
+ */
+CS2_API void cs2_thread_parallel_for(size_t n, size_t grain, cs2_thread_range_func_t f, void *d);
+
+CS2_API_END
+
+#endif /* CS2_THREAD_H */
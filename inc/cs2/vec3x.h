@@ -36,6 +36,8 @@ struct cs2_vec3x_s
     mpz_t x, y, z;
 };
 
+struct cs2_xctx_s;
+
 CS2_API void cs2_vec3x_init(struct cs2_vec3x_s *v);
 CS2_API void cs2_vec3x_clear(struct cs2_vec3x_s *v);
 
@@ -53,16 +55,24 @@ CS2_API void cs2_vec3x_neg(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va);
 CS2_API void cs2_vec3x_mul(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa);
 
 CS2_API void cs2_vec3x_cl(struct cs2_pin3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb);
+CS2_API void cs2_vec3x_cl_ctx(struct cs2_pin3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb, struct cs2_xctx_s *xc);
 
 CS2_API void cs2_vec3x_mad2(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb);
+CS2_API void cs2_vec3x_mad2_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, struct cs2_xctx_s *xc);
 CS2_API void cs2_vec3x_mad3(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc);
+CS2_API void cs2_vec3x_mad3_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, struct cs2_xctx_s *xc);
 CS2_API void cs2_vec3x_mad4(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd);
+CS2_API void cs2_vec3x_mad4_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd, struct cs2_xctx_s *xc);
 CS2_API void cs2_vec3x_mad5(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd, const struct cs2_vec3x_s *ve, mpz_srcptr se);
+CS2_API void cs2_vec3x_mad5_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd, const struct cs2_vec3x_s *ve, mpz_srcptr se, struct cs2_xctx_s *xc);
 
 CS2_API void cs2_vec3x_dot(mpz_ptr s, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb);
+CS2_API void cs2_vec3x_dot_ctx(mpz_ptr s, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb, struct cs2_xctx_s *xc);
 CS2_API void cs2_vec3x_cross(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb);
+CS2_API void cs2_vec3x_cross_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb, struct cs2_xctx_s *xc);
 
 CS2_API void cs2_vec3x_sqlen(mpz_ptr s, const struct cs2_vec3x_s *v);
+CS2_API void cs2_vec3x_sqlen_ctx(mpz_ptr s, const struct cs2_vec3x_s *v, struct cs2_xctx_s *xc);
 
 CS2_API void cs2_vec3x_tr(mpz_ptr s, const struct cs2_vec3x_s *v);
 
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CS2_VERIFY_H
+#define CS2_VERIFY_H
+
+#include "defs.h"
+#include <stdint.h>
+
+CS2_API_BEGIN
+
+/**
+ * numerical validation levels:
+ * - off: no checks
+ * - sampled: one in 'sample rate' calls is checked
+ * - full: every call is checked
+ *
+ * the default level is selected at build time (CS2_VERIFY_DEFAULT_LEVEL),
+ * building with CS2_VERIFY_DISABLED compiles all checks out
+ */
+enum cs2_verify_level_e
+{
+    cs2_verify_level_off,
+    cs2_verify_level_sampled,
+    cs2_verify_level_full,
+
+    cs2_verify_level_COUNT
+};
+
+CS2_API const char *cs2_verify_level_str(enum cs2_verify_level_e level);
+
+CS2_API enum cs2_verify_level_e cs2_verify_level(void);
+CS2_API void cs2_verify_set_level(enum cs2_verify_level_e level);
+
+CS2_API unsigned cs2_verify_sample_rate(void);
+CS2_API void cs2_verify_set_sample_rate(unsigned rate);
+
+/* fatal: a failed check aborts (default), otherwise it is only counted */
+CS2_API int cs2_verify_fatal(void);
+CS2_API void cs2_verify_set_fatal(int fatal);
+
+struct cs2_verify_stats_s
+{
+    /* number of checks that ran */
+    uint64_t checks;
+
+    /* number of checks that failed */
+    uint64_t failures;
+
+    /* location of the last failure */
+    const char *last_file;
+    int last_line;
+};
+
+CS2_API void cs2_verify_stats(struct cs2_verify_stats_s *stats);
+CS2_API void cs2_verify_reset_stats(void);
+
+/* returns non-zero if the current call should be verified */
+CS2_API int cs2_verify_sample(void);
+
+/* records a single check */
+CS2_API int cs2_verify_check(int value, const char *cond, const char *file, int line, const char *msg, ...);
+
+#if defined(CS2_VERIFY_DISABLED)
+#define CS2_VERIFY_SAMPLE() (0)
+#else /* defined(CS2_VERIFY_DISABLED) */
+#define CS2_VERIFY_SAMPLE() (cs2_verify_sample())
+#endif /* defined(CS2_VERIFY_DISABLED) */
+
+#define CS2_VERIFY_MSG(Cond, Msg, ...) do cs2_verify_check(Cond, #Cond, __FILE__, __LINE__, Msg, ## __VA_ARGS__); while (0)
+
+CS2_API_END
+
+#endif /* CS2_VERIFY_H */
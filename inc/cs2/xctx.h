@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef CS2_XCTX_H
+#define CS2_XCTX_H
+
+#include "defs.h"
+#include "vec3x.h"
+#include <stddef.h>
+#include <gmp.h>
+
+CS2_API_BEGIN
+
+/**
+ * exact arithmetic scratch context:
+ *
+ * stacks of integer and vector temporaries that are initialized once and keep
+ * their limb storage between calls; kernels take temporaries with get and
+ * return them with put in reverse order
+ *
+ * a context must not be shared between threads, cs2_xctx_thread returns
+ * the context of the calling thread (created on first use); it is destroyed
+ * at thread exit, at process exit or by cs2_xctx_cleanup
+ */
+struct cs2_xctx_s
+{
+    /* integer temporaries */
+    mpz_ptr *z;
+    size_t ztop, zcap;
+
+    /* vector temporaries */
+    struct cs2_vec3x_s **v;
+    size_t vtop, vcap;
+};
+
+CS2_API void cs2_xctx_init(struct cs2_xctx_s *xc);
+CS2_API void cs2_xctx_clear(struct cs2_xctx_s *xc);
+
+CS2_API struct cs2_xctx_s *cs2_xctx_thread(void);
+
+/* destroys the context of the calling thread, a later cs2_xctx_thread creates a new one */
+CS2_API void cs2_xctx_cleanup(void);
+
+CS2_API mpz_ptr cs2_xctx_get_mpz(struct cs2_xctx_s *xc);
+CS2_API void cs2_xctx_put_mpz(struct cs2_xctx_s *xc, size_t n);
+
+CS2_API struct cs2_vec3x_s *cs2_xctx_get_vec3x(struct cs2_xctx_s *xc);
+CS2_API void cs2_xctx_put_vec3x(struct cs2_xctx_s *xc, size_t n);
+
+CS2_API_END
+
+#endif /* CS2_XCTX_H */
@@ -24,27 +24,244 @@
  */
 #include "cs2/bezierqq4f.h"
 #include "cs2/hull4f.h"
+#include <math.h>
+#include <cs2/assert.h>
+
+#define CS2_BEZIERQQ4F_PI 3.14159265358979323846
 
 static void _cs2_bezierqq4f_calc_hull(struct cs2_bezierqq4f_s *b)
 {
     struct cs2_vec4f_s pts[9];
 
-    cs2_vec4f_copy(&pts[0], &b->p00);
-    cs2_vec4f_copy(&pts[1], &b->p01);
-    cs2_vec4f_copy(&pts[2], &b->p02);
-    cs2_vec4f_copy(&pts[3], &b->p10);
-    cs2_vec4f_copy(&pts[4], &b->p11);
-    cs2_vec4f_copy(&pts[5], &b->p12);
-    cs2_vec4f_copy(&pts[6], &b->p20);
-    cs2_vec4f_copy(&pts[7], &b->p21);
-    cs2_vec4f_copy(&pts[8], &b->p22);
-
+    cs2_bezierqq4f_cp(pts, b);
     cs2_hull4f_from_arr(&b->h, pts, 9);
+    b->hv = 1;
+}
+
+static void _cs2_bezierqq4f_measure_hull(struct cs2_bezierqq4f_s *b)
+{
+    struct cs2_vec4f_s pts[9];
+
+    if (b->hv)
+    {
+        b->hvol = b->h.vol;
+        b->harea = b->h.area;
+    }
+    else
+    {
+        cs2_bezierqq4f_cp(pts, b);
+        cs2_hull4f_measure_arr(&b->hvol, &b->harea, pts, 9);
+    }
+
+    b->hm = 1;
+}
+
+static double _cs2_bezierqq4f_kdop_dot(const struct cs2_vec4f_s *p, int k)
+{
+    /* e_i +/- e_j, (i, j) = (0, 1), (0, 2), (0, 3), (1, 2), (1, 3), (2, 3) */
+    switch (k)
+    {
+    case 0: return p->x;
+    case 1: return p->y;
+    case 2: return p->z;
+    case 3: return p->w;
+    case 4: return p->x + p->y;
+    case 5: return p->x - p->y;
+    case 6: return p->x + p->z;
+    case 7: return p->x - p->z;
+    case 8: return p->x + p->w;
+    case 9: return p->x - p->w;
+    case 10: return p->y + p->z;
+    case 11: return p->y - p->z;
+    case 12: return p->y + p->w;
+    case 13: return p->y - p->w;
+    case 14: return p->z + p->w;
+    case 15: return p->z - p->w;
+    }
+
+    return 0.0;
+}
+
+static int _cs2_bezierqq4f_add_axis(struct cs2_vec4f_s *ox, int n, const struct cs2_vec4f_s *a)
+{
+    struct cs2_vec4f_s r;
+    double l0 = cs2_vec4f_len(a), l;
+    int i;
+
+    /* gram-schmidt, twice for stability */
+    cs2_vec4f_copy(&r, a);
+
+    for (i = 0; i < 2 * n; ++i)
+        cs2_vec4f_mad2(&r, &r, 1.0, &ox[i % n], -cs2_vec4f_dot(&r, &ox[i % n]));
+
+    l = cs2_vec4f_len(&r);
+
+    if (!(l > 1e-9 * l0))
+        return n;
+
+    cs2_vec4f_mul(&ox[n], &r, 1.0 / l);
+
+    return n + 1;
+}
+
+static void _cs2_bezierqq4f_calc_bv(struct cs2_bezierqq4f_s *b)
+{
+    struct cs2_vec4f_s pts[9], du, dv, e;
+    double d, r;
+    int i, k, n, kb;
+
+    cs2_bezierqq4f_cp(pts, b);
+
+    /* k-dop */
+    for (k = 0; k < CS2_BEZIERQQ4F_KDOP; ++k)
+    {
+        b->kmin[k] = b->kmax[k] = _cs2_bezierqq4f_kdop_dot(&pts[0], k);
+
+        for (i = 1; i < 9; ++i)
+        {
+            d = _cs2_bezierqq4f_kdop_dot(&pts[i], k);
+
+            if (d < b->kmin[k])
+                b->kmin[k] = d;
+
+            if (d > b->kmax[k])
+                b->kmax[k] = d;
+        }
+    }
+
+    /* sphere around the aabb center */
+    cs2_vec4f_set(&b->sc, 0.5 * (b->kmin[0] + b->kmax[0]), 0.5 * (b->kmin[1] + b->kmax[1]), 0.5 * (b->kmin[2] + b->kmax[2]), 0.5 * (b->kmin[3] + b->kmax[3]));
+    b->sr = 0.0;
+
+    for (i = 0; i < 9; ++i)
+    {
+        cs2_vec4f_sub(&e, &pts[i], &b->sc);
+        r = cs2_vec4f_sqlen(&e);
+
+        if (r > b->sr)
+            b->sr = r;
+    }
+
+    b->sr = sqrt(b->sr);
+
+    /* patch frame: mean directions along u and v, completed by the best basis vectors */
+    cs2_vec4f_mad3(&du, &b->p20, 1.0, &b->p21, 1.0, &b->p22, 1.0);
+    cs2_vec4f_mad4(&du, &du, 1.0, &b->p00, -1.0, &b->p01, -1.0, &b->p02, -1.0);
+    cs2_vec4f_mad3(&dv, &b->p02, 1.0, &b->p12, 1.0, &b->p22, 1.0);
+    cs2_vec4f_mad4(&dv, &dv, 1.0, &b->p00, -1.0, &b->p10, -1.0, &b->p20, -1.0);
+
+    n = _cs2_bezierqq4f_add_axis(b->ox, 0, &du);
+    n = _cs2_bezierqq4f_add_axis(b->ox, n, &dv);
+
+    while (n < 4)
+    {
+        kb = 0;
+        r = -1.0;
+
+        for (k = 0; k < 4; ++k)
+        {
+            cs2_vec4f_set(&e, k == 0, k == 1, k == 2, k == 3);
+
+            for (i = 0; i < n; ++i)
+                cs2_vec4f_mad2(&e, &e, 1.0, &b->ox[i], -cs2_vec4f_dot(&e, &b->ox[i]));
+
+            d = cs2_vec4f_sqlen(&e);
+
+            if (d > r)
+            {
+                r = d;
+                kb = k;
+            }
+        }
+
+        cs2_vec4f_set(&e, kb == 0, kb == 1, kb == 2, kb == 3);
+        n = _cs2_bezierqq4f_add_axis(b->ox, n, &e);
+    }
+
+    for (k = 0; k < 4; ++k)
+    {
+        b->omin[k] = b->omax[k] = cs2_vec4f_dot(&pts[0], &b->ox[k]);
+
+        for (i = 1; i < 9; ++i)
+        {
+            d = cs2_vec4f_dot(&pts[i], &b->ox[k]);
+
+            if (d < b->omin[k])
+                b->omin[k] = d;
+
+            if (d > b->omax[k])
+                b->omax[k] = d;
+        }
+    }
+}
+
+static double _cs2_bezierqq4f_box_vol(const double *lo, const double *hi)
+{
+    return (hi[0] - lo[0]) * (hi[1] - lo[1]) * (hi[2] - lo[2]) * (hi[3] - lo[3]);
+}
+
+static double _cs2_bezierqq4f_box_area(const double *lo, const double *hi)
+{
+    double e0 = hi[0] - lo[0], e1 = hi[1] - lo[1], e2 = hi[2] - lo[2], e3 = hi[3] - lo[3];
+
+    /* 8 facets */
+    return 2.0 * (e1 * e2 * e3 + e0 * e2 * e3 + e0 * e1 * e3 + e0 * e1 * e2);
+}
+
+static int _cs2_bezierqq4f_obb_sep(const struct cs2_bezierqq4f_s *p, const struct cs2_bezierqq4f_s *q)
+{
+    struct cs2_vec4f_s c;
+    double pc, pr, qc, qr, a;
+    int i, j;
+
+    /* face axes of p */
+    for (i = 0; i < 4; ++i)
+    {
+        pc = 0.5 * (p->omin[i] + p->omax[i]);
+        pr = 0.5 * (p->omax[i] - p->omin[i]);
+
+        cs2_vec4f_zero(&c);
+        qr = 0.0;
+
+        for (j = 0; j < 4; ++j)
+        {
+            cs2_vec4f_mad2(&c, &c, 1.0, &q->ox[j], 0.5 * (q->omin[j] + q->omax[j]));
+
+            a = cs2_vec4f_dot(&p->ox[i], &q->ox[j]);
+            qr += fabs(a) * 0.5 * (q->omax[j] - q->omin[j]);
+        }
+
+        qc = cs2_vec4f_dot(&p->ox[i], &c);
+
+        if (fabs(pc - qc) > pr + qr)
+            return 1;
+    }
+
+    return 0;
+}
+
+const char *cs2_bezierbvqq4f_str(enum cs2_bezierbvqq4f_e bv)
+{
+    switch (bv)
+    {
+    case cs2_bezierbvqq4f_hull: return "hull";
+    case cs2_bezierbvqq4f_aabb: return "aabb";
+    case cs2_bezierbvqq4f_kdop: return "kdop";
+    case cs2_bezierbvqq4f_sphere: return "sphere";
+    case cs2_bezierbvqq4f_obb: return "obb";
+
+    /* COUNT */
+    case cs2_bezierbvqq4f_COUNT: return 0;
+    }
+
+    return 0;
 }
 
 void cs2_bezierqq4f_init(struct cs2_bezierqq4f_s *b)
 {
     cs2_hull4f_init(&b->h);
+    b->hv = 0;
+    b->hm = 0;
 }
 
 void cs2_bezierqq4f_clear(struct cs2_bezierqq4f_s *b)
@@ -83,8 +300,53 @@ void cs2_bezierqq4f_from_qq(struct cs2_bezierqq4f_s *b, const struct cs2_bezierq
     BEZIERQQ44F_MID_CASE_IMPL(w)
     #undef BEZIERQQ44F_MID_CASE_IMPL
 
-    /* hull */
-    _cs2_bezierqq4f_calc_hull(b);
+    /* bounding volumes, a previous hull is stale */
+    _cs2_bezierqq4f_calc_bv(b);
+    b->hm = 0;
+
+    if (b->hv)
+    {
+        cs2_hull4f_clear(&b->h);
+        cs2_hull4f_init(&b->h);
+        b->hv = 0;
+    }
+}
+
+void cs2_bezierqq4f_from_cp(struct cs2_bezierqq4f_s *b, const struct cs2_vec4f_s *p)
+{
+    cs2_vec4f_copy(&b->p00, &p[0]);
+    cs2_vec4f_copy(&b->p01, &p[1]);
+    cs2_vec4f_copy(&b->p02, &p[2]);
+    cs2_vec4f_copy(&b->p10, &p[3]);
+    cs2_vec4f_copy(&b->p11, &p[4]);
+    cs2_vec4f_copy(&b->p12, &p[5]);
+    cs2_vec4f_copy(&b->p20, &p[6]);
+    cs2_vec4f_copy(&b->p21, &p[7]);
+    cs2_vec4f_copy(&b->p22, &p[8]);
+
+    /* bounding volumes, a previous hull is stale */
+    _cs2_bezierqq4f_calc_bv(b);
+    b->hm = 0;
+
+    if (b->hv)
+    {
+        cs2_hull4f_clear(&b->h);
+        cs2_hull4f_init(&b->h);
+        b->hv = 0;
+    }
+}
+
+void cs2_bezierqq4f_cp(struct cs2_vec4f_s *p, const struct cs2_bezierqq4f_s *b)
+{
+    cs2_vec4f_copy(&p[0], &b->p00);
+    cs2_vec4f_copy(&p[1], &b->p01);
+    cs2_vec4f_copy(&p[2], &b->p02);
+    cs2_vec4f_copy(&p[3], &b->p10);
+    cs2_vec4f_copy(&p[4], &b->p11);
+    cs2_vec4f_copy(&p[5], &b->p12);
+    cs2_vec4f_copy(&p[6], &b->p20);
+    cs2_vec4f_copy(&p[7], &b->p21);
+    cs2_vec4f_copy(&p[8], &b->p22);
 }
 
 void cs2_bezierqq4f_eval(struct cs2_vec4f_s *r, const struct cs2_bezierqq4f_s *b, double u, double v)
@@ -110,7 +372,170 @@ void cs2_bezierqq4f_eval(struct cs2_vec4f_s *r, const struct cs2_bezierqq4f_s *b
     #undef BEZIERQQ44F_EVAL_CASE_IMPL
 }
 
+double cs2_bezierqq4f_flatness(const struct cs2_bezierqq4f_s *b)
+{
+    struct cs2_vec4f_s e, d;
+    double f, m = 0.0;
+
+    /* bilinear interpolant of the corners at the border and center control points */
+    #define BEZIERQQ4F_FLAT_CASE_IMPL(P, S, T) \
+        cs2_vec4f_mad4(&e, &b->p00, (1.0 - S) * (1.0 - T), &b->p02, (1.0 - S) * T, &b->p20, S * (1.0 - T), &b->p22, S * T); \
+        cs2_vec4f_sub(&d, &b->P, &e); \
+        f = cs2_vec4f_sqlen(&d); \
+        m = f > m ? f : m;
+
+    BEZIERQQ4F_FLAT_CASE_IMPL(p01, 0.0, 0.5)
+    BEZIERQQ4F_FLAT_CASE_IMPL(p10, 0.5, 0.0)
+    BEZIERQQ4F_FLAT_CASE_IMPL(p11, 0.5, 0.5)
+    BEZIERQQ4F_FLAT_CASE_IMPL(p12, 0.5, 1.0)
+    BEZIERQQ4F_FLAT_CASE_IMPL(p21, 1.0, 0.5)
+    #undef BEZIERQQ4F_FLAT_CASE_IMPL
+
+    return sqrt(m);
+}
+
+const struct cs2_hull4f_s *cs2_bezierqq4f_hull(struct cs2_bezierqq4f_s *b)
+{
+    if (!b->hv)
+        _cs2_bezierqq4f_calc_hull(b);
+
+    return &b->h;
+}
+
+const struct cs2_hull4f_s *cs2_bezierqq4f_hull_tmp(const struct cs2_bezierqq4f_s *b, struct cs2_hull4f_s *tmp)
+{
+    struct cs2_vec4f_s pts[9];
+
+    if (b->hv)
+        return &b->h;
+
+    cs2_bezierqq4f_cp(pts, b);
+    cs2_hull4f_from_arr(tmp, pts, 9);
+
+    return tmp;
+}
+
+double cs2_bezierqq4f_vol(struct cs2_bezierqq4f_s *b, enum cs2_bezierbvqq4f_e bv)
+{
+    switch (bv)
+    {
+    case cs2_bezierbvqq4f_hull:
+        if (!b->hm)
+            _cs2_bezierqq4f_measure_hull(b);
+
+        return b->hvol;
+
+    case cs2_bezierbvqq4f_aabb: return _cs2_bezierqq4f_box_vol(b->kmin, b->kmax);
+    case cs2_bezierbvqq4f_kdop: return _cs2_bezierqq4f_box_vol(b->kmin, b->kmax);
+    case cs2_bezierbvqq4f_sphere: return 0.5 * CS2_BEZIERQQ4F_PI * CS2_BEZIERQQ4F_PI * b->sr * b->sr * b->sr * b->sr;
+    case cs2_bezierbvqq4f_obb: return _cs2_bezierqq4f_box_vol(b->omin, b->omax);
+
+    /* COUNT */
+    case cs2_bezierbvqq4f_COUNT: break;
+    }
+
+    CS2_PANIC_MSG("invalid bounding volume");
+    return 0.0;
+}
+
+double cs2_bezierqq4f_area(struct cs2_bezierqq4f_s *b, enum cs2_bezierbvqq4f_e bv)
+{
+    switch (bv)
+    {
+    case cs2_bezierbvqq4f_hull:
+        if (!b->hm)
+            _cs2_bezierqq4f_measure_hull(b);
+
+        return b->harea;
+
+    case cs2_bezierbvqq4f_aabb: return _cs2_bezierqq4f_box_area(b->kmin, b->kmax);
+    case cs2_bezierbvqq4f_kdop: return _cs2_bezierqq4f_box_area(b->kmin, b->kmax);
+    case cs2_bezierbvqq4f_sphere: return 2.0 * CS2_BEZIERQQ4F_PI * CS2_BEZIERQQ4F_PI * b->sr * b->sr * b->sr;
+    case cs2_bezierbvqq4f_obb: return _cs2_bezierqq4f_box_area(b->omin, b->omax);
+
+    /* COUNT */
+    case cs2_bezierbvqq4f_COUNT: break;
+    }
+
+    CS2_PANIC_MSG("invalid bounding volume");
+    return 0.0;
+}
+
+/* test of a bounding volume built with the control points */
+static int _cs2_bezierqq4f_inter_cheap(const struct cs2_bezierqq4f_s *p, const struct cs2_bezierqq4f_s *q, enum cs2_bezierbvqq4f_e bv)
+{
+    struct cs2_vec4f_s d;
+    double r;
+    int k;
+
+    switch (bv)
+    {
+    case cs2_bezierbvqq4f_aabb:
+    case cs2_bezierbvqq4f_kdop:
+        for (k = 0; k < (bv == cs2_bezierbvqq4f_aabb ? 4 : CS2_BEZIERQQ4F_KDOP); ++k)
+            if (p->kmax[k] < q->kmin[k] || q->kmax[k] < p->kmin[k])
+                return 0;
+
+        return 1;
+
+    case cs2_bezierbvqq4f_sphere:
+        cs2_vec4f_sub(&d, &p->sc, &q->sc);
+        r = p->sr + q->sr;
+
+        return cs2_vec4f_sqlen(&d) <= r * r;
+
+    case cs2_bezierbvqq4f_obb:
+        return !_cs2_bezierqq4f_obb_sep(p, q) && !_cs2_bezierqq4f_obb_sep(q, p);
+
+    /* not cheap */
+    case cs2_bezierbvqq4f_hull:
+    case cs2_bezierbvqq4f_COUNT: break;
+    }
+
+    CS2_PANIC_MSG("invalid bounding volume");
+    return 1;
+}
+
+/* all volumes contain the hull, so any separation is conclusive */
+static int _cs2_bezierqq4f_inter_cheap_all(const struct cs2_bezierqq4f_s *p, const struct cs2_bezierqq4f_s *q)
+{
+    return _cs2_bezierqq4f_inter_cheap(p, q, cs2_bezierbvqq4f_kdop) &&
+           _cs2_bezierqq4f_inter_cheap(p, q, cs2_bezierbvqq4f_sphere) &&
+           _cs2_bezierqq4f_inter_cheap(p, q, cs2_bezierbvqq4f_obb);
+}
+
+int cs2_bezierqq4f_inter_bv(struct cs2_bezierqq4f_s *p, struct cs2_bezierqq4f_s *q, enum cs2_bezierbvqq4f_e bv)
+{
+    if (bv == cs2_bezierbvqq4f_hull)
+        return cs2_hull4f_inter(cs2_bezierqq4f_hull(p), cs2_bezierqq4f_hull(q));
+
+    return _cs2_bezierqq4f_inter_cheap(p, q, bv);
+}
+
 int cs2_bezierqq4f_inter(const struct cs2_bezierqq4f_s *p, const struct cs2_bezierqq4f_s *q)
 {
-    return cs2_hull4f_inter(&p->h, &q->h);
+    struct cs2_hull4f_s tp, tq;
+    int r;
+
+    if (!_cs2_bezierqq4f_inter_cheap_all(p, q))
+        return 0;
+
+    /* hulls that are not built are temporaries */
+    cs2_hull4f_init(&tp);
+    cs2_hull4f_init(&tq);
+
+    r = cs2_hull4f_inter(cs2_bezierqq4f_hull_tmp(p, &tp), cs2_bezierqq4f_hull_tmp(q, &tq));
+
+    cs2_hull4f_clear(&tp);
+    cs2_hull4f_clear(&tq);
+
+    return r;
+}
+
+int cs2_bezierqq4f_inter_lazy(struct cs2_bezierqq4f_s *p, struct cs2_bezierqq4f_s *q)
+{
+    if (!_cs2_bezierqq4f_inter_cheap_all(p, q))
+        return 0;
+
+    return cs2_bezierqq4f_inter_bv(p, q, cs2_bezierbvqq4f_hull);
 }
@@ -0,0 +1,399 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/beziertreeflatqq4f.h"
+#include "cs2/hull4f.h"
+#include "cs2/mem.h"
+#include <string.h>
+#include <cs2/assert.h>
+
+static void _cs2_beziertreeflatqq4f_set(struct cs2_beziertreeflatqq4f_s *fl, uint32_t i, struct cs2_beziertreenodeqq4f_s *n)
+{
+    struct cs2_vec4f_s cp[9];
+    size_t k, nn = fl->n;
+
+    fl->u0[i] = n->u0;
+    fl->u2[i] = n->u2;
+    fl->v0[i] = n->v0;
+    fl->v2[i] = n->v2;
+    fl->vol[i] = n->vol;
+    fl->svol[i] = n->svol;
+
+    /* the virtual root has no patch */
+    if (cs2_beziertreenodeqq4f_is_virt(n))
+    {
+        for (k = 0; k < 36; ++k)
+            fl->cp[k * nn + i] = 0.0;
+
+        for (k = 0; k < CS2_BEZIERQQ4F_KDOP; ++k)
+        {
+            fl->kmin[k * nn + i] = 0.0;
+            fl->kmax[k * nn + i] = 0.0;
+        }
+
+        for (k = 0; k < 4; ++k)
+            fl->sc[k * nn + i] = 0.0;
+
+        fl->sr[i] = 0.0;
+
+        return;
+    }
+
+    cs2_bezierqq4f_cp(cp, &n->b);
+
+    for (k = 0; k < 9; ++k)
+    {
+        fl->cp[(4 * k + 0) * nn + i] = cp[k].x;
+        fl->cp[(4 * k + 1) * nn + i] = cp[k].y;
+        fl->cp[(4 * k + 2) * nn + i] = cp[k].z;
+        fl->cp[(4 * k + 3) * nn + i] = cp[k].w;
+    }
+
+    for (k = 0; k < CS2_BEZIERQQ4F_KDOP; ++k)
+    {
+        fl->kmin[k * nn + i] = n->b.kmin[k];
+        fl->kmax[k * nn + i] = n->b.kmax[k];
+    }
+
+    fl->sc[0 * nn + i] = n->b.sc.x;
+    fl->sc[1 * nn + i] = n->b.sc.y;
+    fl->sc[2 * nn + i] = n->b.sc.z;
+    fl->sc[3 * nn + i] = n->b.sc.w;
+    fl->sr[i] = n->b.sr;
+}
+
+void cs2_beziertreeflatqq4f_init(struct cs2_beziertreeflatqq4f_s *fl)
+{
+    memset(fl, 0, sizeof(struct cs2_beziertreeflatqq4f_s));
+}
+
+void cs2_beziertreeflatqq4f_clear(struct cs2_beziertreeflatqq4f_s *fl)
+{
+    CS2_MEM_FREE(fl->c);
+    CS2_MEM_FREE(fl->p);
+    CS2_MEM_FREE(fl->u0);
+    CS2_MEM_FREE(fl->u2);
+    CS2_MEM_FREE(fl->v0);
+    CS2_MEM_FREE(fl->v2);
+    CS2_MEM_FREE(fl->vol);
+    CS2_MEM_FREE(fl->svol);
+    CS2_MEM_FREE(fl->cp);
+    CS2_MEM_FREE(fl->kmin);
+    CS2_MEM_FREE(fl->kmax);
+    CS2_MEM_FREE(fl->sc);
+    CS2_MEM_FREE(fl->sr);
+    CS2_MEM_FREE(fl->hr);
+    CS2_MEM_FREE(fl->vr);
+    CS2_MEM_FREE(fl->ho);
+    CS2_MEM_FREE(fl->vo);
+
+    cs2_beziertreeflatqq4f_init(fl);
+}
+
+void cs2_beziertreeflatqq4f_from_tree(struct cs2_beziertreeflatqq4f_s *fl, struct cs2_beziertreeqq4f_s *t)
+{
+    struct cs2_beziertreenodeqq4f_s **q, *n;
+    struct cs2_beziertreehullsqq4f_s hs;
+    size_t nn, np = 0, nv = 0, i, e;
+    int k;
+
+    CS2_ASSERT_MSG(t->rn != NULL, "tree must be built from a func");
+
+    cs2_beziertreeflatqq4f_clear(fl);
+
+    /* breadth-first: children are appended together */
+    q = CS2_MEM_MALLOC_N(struct cs2_beziertreenodeqq4f_s *, t->np.count);
+    q[0] = t->rn;
+    e = 1;
+
+    for (i = 0; i < e; ++i)
+        if (!cs2_beziertreenodeqq4f_is_leaf(q[i]))
+            for (k = 0; k < 4; ++k)
+                q[e++] = q[i]->c[k / 2][k % 2];
+
+    nn = e;
+
+    CS2_ASSERT_MSG(nn < CS2_BEZIERTREEFLATQQ4F_NONE, "too many nodes");
+
+    /* refinement measures hulls without building them, the pool holds temporary ones */
+    cs2_beziertreehullsqq4f_init(&hs);
+    cs2_beziertreehullsqq4f_build(&hs, q, nn);
+
+    for (i = 0; i < nn; ++i)
+    {
+        if (hs.h[i])
+        {
+            np += hs.h[i]->nhr;
+            nv += hs.h[i]->nvr;
+        }
+    }
+
+    fl->n = nn;
+    fl->c = CS2_MEM_MALLOC_N(uint32_t, nn);
+    fl->p = CS2_MEM_MALLOC_N(uint32_t, nn);
+    fl->u0 = CS2_MEM_MALLOC_N(double, nn);
+    fl->u2 = CS2_MEM_MALLOC_N(double, nn);
+    fl->v0 = CS2_MEM_MALLOC_N(double, nn);
+    fl->v2 = CS2_MEM_MALLOC_N(double, nn);
+    fl->vol = CS2_MEM_MALLOC_N(double, nn);
+    fl->svol = CS2_MEM_MALLOC_N(double, nn);
+    fl->cp = CS2_MEM_MALLOC_N(double, (36 * nn));
+    fl->kmin = CS2_MEM_MALLOC_N(double, (CS2_BEZIERQQ4F_KDOP * nn));
+    fl->kmax = CS2_MEM_MALLOC_N(double, (CS2_BEZIERQQ4F_KDOP * nn));
+    fl->sc = CS2_MEM_MALLOC_N(double, (4 * nn));
+    fl->sr = CS2_MEM_MALLOC_N(double, nn);
+    fl->hr = CS2_MEM_MALLOC_N(struct cs2_plane4f_s, (np > 0 ? np : 1));
+    fl->vr = CS2_MEM_MALLOC_N(struct cs2_vec4f_s, (nv > 0 ? nv : 1));
+    fl->ho = CS2_MEM_MALLOC_N(size_t, (nn + 1));
+    fl->vo = CS2_MEM_MALLOC_N(size_t, (nn + 1));
+
+    fl->p[0] = CS2_BEZIERTREEFLATQQ4F_NONE;
+    fl->ho[0] = 0;
+    fl->vo[0] = 0;
+    e = 1;
+
+    for (i = 0; i < nn; ++i)
+    {
+        n = q[i];
+
+        _cs2_beziertreeflatqq4f_set(fl, (uint32_t)i, n);
+
+        /* hull pool */
+        fl->ho[i + 1] = fl->ho[i];
+        fl->vo[i + 1] = fl->vo[i];
+
+        if (hs.h[i])
+        {
+            memcpy(fl->hr + fl->ho[i], hs.h[i]->hr, sizeof(struct cs2_plane4f_s) * hs.h[i]->nhr);
+            memcpy(fl->vr + fl->vo[i], hs.h[i]->vr, sizeof(struct cs2_vec4f_s) * hs.h[i]->nvr);
+
+            fl->ho[i + 1] += hs.h[i]->nhr;
+            fl->vo[i + 1] += hs.h[i]->nvr;
+        }
+
+        if (cs2_beziertreenodeqq4f_is_leaf(n))
+        {
+            fl->c[i] = CS2_BEZIERTREEFLATQQ4F_NONE;
+            continue;
+        }
+
+        fl->c[i] = (uint32_t)e;
+
+        for (k = 0; k < 4; ++k)
+        {
+            fl->p[e] = (uint32_t)i;
+            ++e;
+        }
+    }
+
+    cs2_beziertreehullsqq4f_clear(&hs);
+    CS2_MEM_FREE(q);
+}
+
+uint32_t cs2_beziertreeflatqq4f_child(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i, int k)
+{
+    return fl->c[i] == CS2_BEZIERTREEFLATQQ4F_NONE ? CS2_BEZIERTREEFLATQQ4F_NONE : fl->c[i] + (uint32_t)k;
+}
+
+uint32_t cs2_beziertreeflatqq4f_parent(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i)
+{
+    return fl->p[i];
+}
+
+int cs2_beziertreeflatqq4f_is_leaf(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i)
+{
+    return fl->c[i] == CS2_BEZIERTREEFLATQQ4F_NONE;
+}
+
+uint32_t cs2_beziertreeflatqq4f_locate(const struct cs2_beziertreeflatqq4f_s *fl, double u, double v)
+{
+    uint32_t i = 0;
+
+    /* children split the domain at its center */
+    while (fl->c[i] != CS2_BEZIERTREEFLATQQ4F_NONE)
+        i = fl->c[i] + 2 * (u >= 0.5 * (fl->u0[i] + fl->u2[i])) + (v >= 0.5 * (fl->v0[i] + fl->v2[i]));
+
+    return i;
+}
+
+void cs2_beziertreeflatqq4f_eval(struct cs2_vec4f_s *r, const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i, double u, double v)
+{
+    double lu = (u - fl->u0[i]) / (fl->u2[i] - fl->u0[i]);
+    double lv = (v - fl->v0[i]) / (fl->v2[i] - fl->v0[i]);
+    double bu[3], bv[3], b, x = 0.0, y = 0.0, z = 0.0, w = 0.0;
+    const double *cp = fl->cp + i;
+    size_t n = fl->n;
+    int k;
+
+    /* same bernstein weights as cs2_bezierqq4f_eval */
+    bu[0] = (1.0 - lu) * (1.0 - lu);
+    bu[1] = 2.0 * lu * (1.0 - lu);
+    bu[2] = lu * lu;
+    bv[0] = (1.0 - lv) * (1.0 - lv);
+    bv[1] = 2.0 * lv * (1.0 - lv);
+    bv[2] = lv * lv;
+
+    for (k = 0; k < 9; ++k)
+    {
+        b = bu[k / 3] * bv[k % 3];
+
+        x += b * cp[(4 * k + 0) * n];
+        y += b * cp[(4 * k + 1) * n];
+        z += b * cp[(4 * k + 2) * n];
+        w += b * cp[(4 * k + 3) * n];
+    }
+
+    cs2_vec4f_set(r, x, y, z, w);
+}
+
+double cs2_beziertreeflatqq4f_vol(const struct cs2_beziertreeflatqq4f_s *fl, uint32_t i)
+{
+    return fl->svol[i];
+}
+
+void cs2_beziertreeflatpairsqq4f_init(struct cs2_beziertreeflatpairsqq4f_s *ps)
+{
+    ps->p = NULL;
+    ps->n = 0;
+    ps->cap = 0;
+}
+
+void cs2_beziertreeflatpairsqq4f_clear(struct cs2_beziertreeflatpairsqq4f_s *ps)
+{
+    CS2_MEM_FREE(ps->p);
+
+    cs2_beziertreeflatpairsqq4f_init(ps);
+}
+
+static void _cs2_beziertreeflatpairsqq4f_push(struct cs2_beziertreeflatpairsqq4f_s *ps, uint32_t a, uint32_t b)
+{
+    struct cs2_beziertreeflatpairqq4f_s *p;
+
+    if (ps->n == ps->cap)
+    {
+        ps->cap = ps->cap ? 2 * ps->cap : 64;
+        p = CS2_MEM_MALLOC_N(struct cs2_beziertreeflatpairqq4f_s, ps->cap);
+
+        if (ps->n > 0)
+            memcpy(p, ps->p, sizeof(struct cs2_beziertreeflatpairqq4f_s) * ps->n);
+
+        CS2_MEM_FREE(ps->p);
+        ps->p = p;
+    }
+
+    ps->p[ps->n].a = a;
+    ps->p[ps->n].b = b;
+    ++ps->n;
+}
+
+static int _cs2_beziertreeflatqq4f_inter_node(const struct cs2_beziertreeflatqq4f_s *fa, uint32_t a, const struct cs2_beziertreeflatqq4f_s *fb, uint32_t b)
+{
+    struct cs2_hull4f_s ha, hb;
+    double d, r, s;
+    size_t k;
+
+    /* virtual roots have no volumes */
+    if (a == 0 || b == 0)
+        return 1;
+
+    for (k = 0; k < CS2_BEZIERQQ4F_KDOP; ++k)
+        if (fa->kmax[k * fa->n + a] < fb->kmin[k * fb->n + b] || fb->kmax[k * fb->n + b] < fa->kmin[k * fa->n + a])
+            return 0;
+
+    s = 0.0;
+
+    for (k = 0; k < 4; ++k)
+    {
+        d = fa->sc[k * fa->n + a] - fb->sc[k * fb->n + b];
+        s += d * d;
+    }
+
+    r = fa->sr[a] + fb->sr[b];
+
+    if (s > r * r)
+        return 0;
+
+    /* hulls are optional */
+    if (fa->vo[a] == fa->vo[a + 1] || fb->vo[b] == fb->vo[b + 1])
+        return 1;
+
+    ha.hr = fa->hr + fa->ho[a];
+    ha.nhr = fa->ho[a + 1] - fa->ho[a];
+    ha.vr = fa->vr + fa->vo[a];
+    ha.nvr = fa->vo[a + 1] - fa->vo[a];
+    ha.vs = NULL;
+
+    hb.hr = fb->hr + fb->ho[b];
+    hb.nhr = fb->ho[b + 1] - fb->ho[b];
+    hb.vr = fb->vr + fb->vo[b];
+    hb.nvr = fb->vo[b + 1] - fb->vo[b];
+    hb.vs = NULL;
+
+    return cs2_hull4f_inter(&ha, &hb);
+}
+
+void cs2_beziertreeflatqq4f_inter(struct cs2_beziertreeflatpairsqq4f_s *ps, const struct cs2_beziertreeflatqq4f_s *fa, const struct cs2_beziertreeflatqq4f_s *fb)
+{
+    struct cs2_beziertreeflatpairsqq4f_s st;
+    uint32_t a, b;
+    int k, sa;
+
+    /* depth-first with an explicit stack of pairs */
+    cs2_beziertreeflatpairsqq4f_init(&st);
+    _cs2_beziertreeflatpairsqq4f_push(&st, 0, 0);
+
+    while (st.n > 0)
+    {
+        --st.n;
+        a = st.p[st.n].a;
+        b = st.p[st.n].b;
+
+        if (!_cs2_beziertreeflatqq4f_inter_node(fa, a, fb, b))
+            continue;
+
+        if (fa->c[a] == CS2_BEZIERTREEFLATQQ4F_NONE && fb->c[b] == CS2_BEZIERTREEFLATQQ4F_NONE)
+        {
+            _cs2_beziertreeflatpairsqq4f_push(ps, a, b);
+            continue;
+        }
+
+        /* descend into the virtual or larger inner node */
+        if (fb->c[b] == CS2_BEZIERTREEFLATQQ4F_NONE)
+            sa = 1;
+        else if (fa->c[a] == CS2_BEZIERTREEFLATQQ4F_NONE)
+            sa = 0;
+        else
+            sa = a == 0 || (b != 0 && fa->vol[a] >= fb->vol[b]);
+
+        for (k = 3; k >= 0; --k)
+        {
+            if (sa)
+                _cs2_beziertreeflatpairsqq4f_push(&st, fa->c[a] + (uint32_t)k, b);
+            else
+                _cs2_beziertreeflatpairsqq4f_push(&st, a, fb->c[b] + (uint32_t)k);
+        }
+    }
+
+    cs2_beziertreeflatpairsqq4f_clear(&st);
+}
@@ -23,24 +23,211 @@
  * SOFTWARE.
  */
 #include "cs2/beziertreeqq4f.h"
+#include "cs2/pool.h"
 #include "cs2/mem.h"
+#include "cs2/thread.h"
+#include "cs2/timer.h"
+#include <math.h>
+#include <string.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <cs2/assert.h>
 
+/* tree image: "cs2btqq4", format version */
+#define CS2_BEZIERTREEIMGQQ4F_MAGIC 0x3471717462327363ULL
+#define CS2_BEZIERTREEIMGQQ4F_VERSION 1
+#define CS2_BEZIERTREEIMGQQ4F_ORDER 0x01020304u
+
+/* sample cache shards (locked separately for parallel refinement) */
+#define CS2_BEZIERTREECACHEQQ4F_SHARDS 64
+
+/* largest shard (slots), a full shard starts over: at most 64 x 4096 x 48 B = 12 MiB */
+#define CS2_BEZIERTREECACHEQQ4F_SLOTS 4096
+
+struct cs2_beziertreesampleqq4f_s
+{
+    double u, v;
+    struct cs2_vec4f_s r;
+};
+
+struct cs2_beziertreeshardqq4f_s
+{
+    pthread_mutex_t m;
+
+    /* open addressing, linear probing, empty slots have u = -1 */
+    struct cs2_beziertreesampleqq4f_s *e;
+    size_t n, cap;
+
+    size_t hits, misses;
+};
+
+struct cs2_beziertreecacheqq4f_s
+{
+    struct cs2_beziertreeshardqq4f_s s[CS2_BEZIERTREECACHEQQ4F_SHARDS];
+};
+
+static uint64_t _cs2_beziertreecacheqq4f_hash(double u, double v)
+{
+    uint64_t bu, bv, h;
+
+    /* dyadic coordinates are exact, so bitwise keys are exact */
+    memcpy(&bu, &u, sizeof(bu));
+    memcpy(&bv, &v, sizeof(bv));
+
+    h = bu * 0x9e3779b97f4a7c15ULL;
+    h ^= (bv + (h << 6) + (h >> 2)) * 0xc2b2ae3d27d4eb4fULL;
+    h ^= h >> 29;
+
+    return h;
+}
+
+static struct cs2_beziertreecacheqq4f_s *_cs2_beziertreecacheqq4f_create(void)
+{
+    struct cs2_beziertreecacheqq4f_s *c = CS2_MEM_MALLOC(struct cs2_beziertreecacheqq4f_s);
+    int i;
+
+    for (i = 0; i < CS2_BEZIERTREECACHEQQ4F_SHARDS; ++i)
+    {
+        pthread_mutex_init(&c->s[i].m, NULL);
+        c->s[i].e = NULL;
+        c->s[i].n = 0;
+        c->s[i].cap = 0;
+        c->s[i].hits = 0;
+        c->s[i].misses = 0;
+    }
+
+    return c;
+}
+
+static void _cs2_beziertreecacheqq4f_destroy(struct cs2_beziertreecacheqq4f_s *c)
+{
+    int i;
+
+    if (!c)
+        return;
+
+    for (i = 0; i < CS2_BEZIERTREECACHEQQ4F_SHARDS; ++i)
+    {
+        pthread_mutex_destroy(&c->s[i].m);
+        CS2_MEM_FREE(c->s[i].e);
+    }
+
+    CS2_MEM_FREE(c);
+}
+
+/* slot of (u, v) or of the empty slot where it belongs */
+static struct cs2_beziertreesampleqq4f_s *_cs2_beziertreeshardqq4f_find(struct cs2_beziertreeshardqq4f_s *s, uint64_t h, double u, double v)
+{
+    size_t i = (size_t)h & (s->cap - 1);
+
+    while (s->e[i].u >= 0.0 && !(s->e[i].u == u && s->e[i].v == v))
+        i = (i + 1) & (s->cap - 1);
+
+    return &s->e[i];
+}
+
+static void _cs2_beziertreeshardqq4f_grow(struct cs2_beziertreeshardqq4f_s *s)
+{
+    struct cs2_beziertreesampleqq4f_s *e = s->e;
+    size_t i, cap = s->cap;
+
+    s->cap = cap ? 2 * cap : 64;
+    s->e = CS2_MEM_MALLOC_N(struct cs2_beziertreesampleqq4f_s, s->cap);
+
+    for (i = 0; i < s->cap; ++i)
+        s->e[i].u = -1.0;
+
+    for (i = 0; i < cap; ++i)
+        if (e[i].u >= 0.0)
+            *_cs2_beziertreeshardqq4f_find(s, _cs2_beziertreecacheqq4f_hash(e[i].u, e[i].v), e[i].u, e[i].v) = e[i];
+
+    CS2_MEM_FREE(e);
+}
+
+/* drops all samples of a shard of the largest size (neighbouring samples come back soon) */
+static void _cs2_beziertreeshardqq4f_reset(struct cs2_beziertreeshardqq4f_s *s)
+{
+    size_t i;
+
+    for (i = 0; i < s->cap; ++i)
+        s->e[i].u = -1.0;
+
+    s->n = 0;
+}
+
+static void _cs2_beziertreeqq4f_sample(struct cs2_vec4f_s *r, struct cs2_beziertreeqq4f_s *t, double u, double v)
+{
+    uint64_t h = _cs2_beziertreecacheqq4f_hash(u, v);
+    struct cs2_beziertreeshardqq4f_s *s = &t->sc->s[h >> 58];
+    struct cs2_beziertreesampleqq4f_s *e;
+
+    /* the high bits select the shard, the low bits the slot */
+    pthread_mutex_lock(&s->m);
+
+    if (s->cap > 0)
+    {
+        e = _cs2_beziertreeshardqq4f_find(s, h, u, v);
+
+        if (e->u >= 0.0)
+        {
+            *r = e->r;
+            ++s->hits;
+            pthread_mutex_unlock(&s->m);
+            return;
+        }
+    }
+
+    ++s->misses;
+    pthread_mutex_unlock(&s->m);
+
+    /* evaluated outside of the lock; a concurrent miss computes the same value */
+    t->f(r, u, v, t->d);
+
+    pthread_mutex_lock(&s->m);
+
+    /* load factor at most 1/2, the size is bounded */
+    if (2 * (s->n + 1) > s->cap)
+    {
+        if (s->cap < CS2_BEZIERTREECACHEQQ4F_SLOTS)
+            _cs2_beziertreeshardqq4f_grow(s);
+        else
+            _cs2_beziertreeshardqq4f_reset(s);
+    }
+
+    e = _cs2_beziertreeshardqq4f_find(s, h, u, v);
+
+    if (e->u < 0.0)
+    {
+        e->u = u;
+        e->v = v;
+        e->r = *r;
+        ++s->n;
+    }
+
+    pthread_mutex_unlock(&s->m);
+}
+
 static void _cs2_beziertreenodeqq4f_eval(struct cs2_beziertreenodeqq4f_s *n)
 {
     struct cs2_bezierqq4f_coeff_s c;
 
     /* eval coeffs */
-    n->r->f(&c.c00, n->u0, n->v0, n->r->d);
-    n->r->f(&c.c01, n->u0, n->v1, n->r->d);
-    n->r->f(&c.c02, n->u0, n->v2, n->r->d);
-    n->r->f(&c.c10, n->u1, n->v0, n->r->d);
-    n->r->f(&c.c11, n->u1, n->v1, n->r->d);
-    n->r->f(&c.c12, n->u1, n->v2, n->r->d);
-    n->r->f(&c.c20, n->u2, n->v0, n->r->d);
-    n->r->f(&c.c21, n->u2, n->v1, n->r->d);
-    n->r->f(&c.c22, n->u2, n->v2, n->r->d);
+    _cs2_beziertreeqq4f_sample(&c.c00, n->r, n->u0, n->v0);
+    _cs2_beziertreeqq4f_sample(&c.c01, n->r, n->u0, n->v1);
+    _cs2_beziertreeqq4f_sample(&c.c02, n->r, n->u0, n->v2);
+    _cs2_beziertreeqq4f_sample(&c.c10, n->r, n->u1, n->v0);
+    _cs2_beziertreeqq4f_sample(&c.c11, n->r, n->u1, n->v1);
+    _cs2_beziertreeqq4f_sample(&c.c12, n->r, n->u1, n->v2);
+    _cs2_beziertreeqq4f_sample(&c.c20, n->r, n->u2, n->v0);
+    _cs2_beziertreeqq4f_sample(&c.c21, n->r, n->u2, n->v1);
+    _cs2_beziertreeqq4f_sample(&c.c22, n->r, n->u2, n->v2);
 
     cs2_bezierqq4f_from_qq(&n->b, &c);
 }
@@ -68,14 +255,20 @@ void cs2_beziertreenodeqq4f_init(struct cs2_beziertreenodeqq4f_s *n, double u0,
     {
         _cs2_beziertreenodeqq4f_eval(n);
 
-        n->vol = n->b.h.vol;
-        n->area = n->b.h.area;
+        n->vol = cs2_bezierqq4f_vol(&n->b, t->bv);
+        n->area = cs2_bezierqq4f_area(&n->b, t->bv);
     }
     else
     {
         n->vol = 0.0;
         n->area = 0.0;
     }
+
+    /* a leaf aggregates itself, virtual leaves are always split */
+    n->svol = n->vol;
+    n->sarea = n->area;
+    n->smax = is_virt ? INFINITY : n->vol;
+    n->sc = 1;
 }
 
 void cs2_beziertreenodeqq4f_clear(struct cs2_beziertreenodeqq4f_s *n)
@@ -84,31 +277,71 @@ void cs2_beziertreenodeqq4f_clear(struct cs2_beziertreenodeqq4f_s *n)
         return;
 
     cs2_beziertreenodeqq4f_clear(n->c[0][0]);
-    CS2_MEM_FREE(n->c[0][0]);
+    CS2_POOL_FREE(&n->r->np, n->c[0][0]);
 
     cs2_beziertreenodeqq4f_clear(n->c[0][1]);
-    CS2_MEM_FREE(n->c[0][1]);
+    CS2_POOL_FREE(&n->r->np, n->c[0][1]);
 
     cs2_beziertreenodeqq4f_clear(n->c[1][0]);
-    CS2_MEM_FREE(n->c[1][0]);
+    CS2_POOL_FREE(&n->r->np, n->c[1][0]);
 
     cs2_beziertreenodeqq4f_clear(n->c[1][1]);
-    CS2_MEM_FREE(n->c[1][1]);
+    CS2_POOL_FREE(&n->r->np, n->c[1][1]);
 
     cs2_bezierqq4f_clear(&n->b);
 }
 
+/* allocates children, they are evaluated separately */
+static void _cs2_beziertreenodeqq4f_sub_alloc(struct cs2_beziertreenodeqq4f_s *n)
+{
+    CS2_ASSERT_MSG(cs2_beziertreenodeqq4f_is_leaf(n), "only a leaf can be split");
+
+    n->c[0][0] = CS2_POOL_ALLOC(&n->r->np, struct cs2_beziertreenodeqq4f_s);
+    n->c[0][1] = CS2_POOL_ALLOC(&n->r->np, struct cs2_beziertreenodeqq4f_s);
+    n->c[1][0] = CS2_POOL_ALLOC(&n->r->np, struct cs2_beziertreenodeqq4f_s);
+    n->c[1][1] = CS2_POOL_ALLOC(&n->r->np, struct cs2_beziertreenodeqq4f_s);
+}
+
+/* evaluates child i (uv index 2 * u + v) */
+static void _cs2_beziertreenodeqq4f_sub_init(struct cs2_beziertreenodeqq4f_s *n, int i)
+{
+    switch (i)
+    {
+    case 0: cs2_beziertreenodeqq4f_init(n->c[0][0], n->u0, 0.5 * (n->u1 + n->u0), n->u1, n->v0, 0.5 * (n->v1 + n->v0), n->v1, n->r, n, 0); break;
+    case 1: cs2_beziertreenodeqq4f_init(n->c[0][1], n->u0, 0.5 * (n->u1 + n->u0), n->u1, n->v1, 0.5 * (n->v2 + n->v1), n->v2, n->r, n, 0); break;
+    case 2: cs2_beziertreenodeqq4f_init(n->c[1][0], n->u1, 0.5 * (n->u2 + n->u1), n->u2, n->v0, 0.5 * (n->v1 + n->v0), n->v1, n->r, n, 0); break;
+    case 3: cs2_beziertreenodeqq4f_init(n->c[1][1], n->u1, 0.5 * (n->u2 + n->u1), n->u2, n->v1, 0.5 * (n->v2 + n->v1), n->v2, n->r, n, 0); break;
+    }
+}
+
+/* aggregates of an inner node from its children */
+static void _cs2_beziertreenodeqq4f_aggr(struct cs2_beziertreenodeqq4f_s *n)
+{
+    struct cs2_beziertreenodeqq4f_s *c00 = n->c[0][0], *c01 = n->c[0][1], *c10 = n->c[1][0], *c11 = n->c[1][1];
+
+    n->svol = c00->svol + c01->svol + c10->svol + c11->svol;
+    n->sarea = c00->sarea + c01->sarea + c10->sarea + c11->sarea;
+    n->smax = fmax(fmax(c00->smax, c01->smax), fmax(c10->smax, c11->smax));
+    n->sc = c00->sc + c01->sc + c10->sc + c11->sc;
+}
+
+/* propagates aggregates to the root once the children of n are evaluated */
+static void _cs2_beziertreenodeqq4f_sub_done(struct cs2_beziertreenodeqq4f_s *n)
+{
+    for (; n; n = n->p)
+        _cs2_beziertreenodeqq4f_aggr(n);
+}
+
 void cs2_beziertreenodeqq4f_sub(struct cs2_beziertreenodeqq4f_s *n)
 {
-    n->c[0][0] = CS2_MEM_MALLOC(struct cs2_beziertreenodeqq4f_s);
-    n->c[0][1] = CS2_MEM_MALLOC(struct cs2_beziertreenodeqq4f_s);
-    n->c[1][0] = CS2_MEM_MALLOC(struct cs2_beziertreenodeqq4f_s);
-    n->c[1][1] = CS2_MEM_MALLOC(struct cs2_beziertreenodeqq4f_s);
+    int i;
+
+    _cs2_beziertreenodeqq4f_sub_alloc(n);
+
+    for (i = 0; i < 4; ++i)
+        _cs2_beziertreenodeqq4f_sub_init(n, i);
 
-    cs2_beziertreenodeqq4f_init(n->c[0][0], n->u0, 0.5 * (n->u1 + n->u0), n->u1, n->v0, 0.5 * (n->v1 + n->v0), n->v1, n->r, n, 0);
-    cs2_beziertreenodeqq4f_init(n->c[0][1], n->u0, 0.5 * (n->u1 + n->u0), n->u1, n->v1, 0.5 * (n->v2 + n->v1), n->v2, n->r, n, 0);
-    cs2_beziertreenodeqq4f_init(n->c[1][0], n->u1, 0.5 * (n->u2 + n->u1), n->u2, n->v0, 0.5 * (n->v1 + n->v0), n->v1, n->r, n, 0);
-    cs2_beziertreenodeqq4f_init(n->c[1][1], n->u1, 0.5 * (n->u2 + n->u1), n->u2, n->v1, 0.5 * (n->v2 + n->v1), n->v2, n->r, n, 0);
+    _cs2_beziertreenodeqq4f_sub_done(n);
 }
 
 int cs2_beziertreenodeqq4f_is_virt(struct cs2_beziertreenodeqq4f_s *n)
@@ -126,16 +359,22 @@ int cs2_beziertreenodeqq4f_is_leaf(struct cs2_beziertreenodeqq4f_s *n)
 
 double cs2_beziertreenodeqq4f_vol(struct cs2_beziertreenodeqq4f_s *n)
 {
-    return cs2_beziertreenodeqq4f_is_leaf(n) ?
-           n->vol :
-           cs2_beziertreenodeqq4f_vol(n->c[0][0]) + cs2_beziertreenodeqq4f_vol(n->c[0][1]) + cs2_beziertreenodeqq4f_vol(n->c[1][0]) + cs2_beziertreenodeqq4f_vol(n->c[1][1]);
+    return n->svol;
 }
 
 double cs2_beziertreenodeqq4f_area(struct cs2_beziertreenodeqq4f_s *n)
 {
-    return cs2_beziertreenodeqq4f_is_leaf(n) ?
-           n->area :
-           cs2_beziertreenodeqq4f_area(n->c[0][0]) + cs2_beziertreenodeqq4f_area(n->c[0][1]) + cs2_beziertreenodeqq4f_area(n->c[1][0]) + cs2_beziertreenodeqq4f_area(n->c[1][1]);
+    return n->sarea;
+}
+
+size_t cs2_beziertreenodeqq4f_leaves(struct cs2_beziertreenodeqq4f_s *n)
+{
+    return n->sc;
+}
+
+double cs2_beziertreenodeqq4f_max_vol(struct cs2_beziertreenodeqq4f_s *n)
+{
+    return n->smax;
 }
 
 void cs2_beziertreeqq4f_init(struct cs2_beziertreeqq4f_s *t)
@@ -143,12 +382,27 @@ void cs2_beziertreeqq4f_init(struct cs2_beziertreeqq4f_s *t)
     t->f = 0;
     t->d = 0;
     t->rn = 0;
+    t->bv = cs2_bezierbvqq4f_hull;
+    t->sc = 0;
+    t->hb = 0;
+
+    cs2_pool_init(&t->np, sizeof(struct cs2_beziertreenodeqq4f_s));
+    cs2_pool_init(&t->lp, sizeof(struct cs2_beziertreeleafqq4f_s));
 }
 
 void cs2_beziertreeqq4f_clear(struct cs2_beziertreeqq4f_s *t)
 {
     cs2_beziertreenodeqq4f_clear(t->rn);
-    CS2_MEM_FREE(t->rn);
+
+    /* bulk free */
+    cs2_pool_clear(&t->np);
+    cs2_pool_clear(&t->lp);
+
+    _cs2_beziertreecacheqq4f_destroy(t->sc);
+
+    t->rn = 0;
+    t->sc = 0;
+    t->hb = 0;
 }
 
 void cs2_beziertreeqq4f_from_func(struct cs2_beziertreeqq4f_s *t, cs2_beziertreeqq4f_func_t f, void *d)
@@ -156,12 +410,101 @@ void cs2_beziertreeqq4f_from_func(struct cs2_beziertreeqq4f_s *t, cs2_beziertree
     t->f = f;
     t->d = d;
 
+    /* samples of a previous func are stale */
+    _cs2_beziertreecacheqq4f_destroy(t->sc);
+    t->sc = _cs2_beziertreecacheqq4f_create();
+
     /* virtual */
-    t->rn = CS2_MEM_MALLOC(struct cs2_beziertreenodeqq4f_s);
+    t->rn = CS2_POOL_ALLOC(&t->np, struct cs2_beziertreenodeqq4f_s);
 
     cs2_beziertreenodeqq4f_init(t->rn, 0.0, 0.5, 1.0, 0.0, 0.5, 1.0, t, 0, 1);
 }
 
+static int beziertreecacheqq4f_cmp(const void *a, const void *b)
+{
+    size_t x = *(const size_t *)a, y = *(const size_t *)b;
+
+    return x < y ? 1 : (x > y ? -1 : 0);
+}
+
+/* upper bound of the memory added by 'k' new samples: at most 'k' shards below the largest size double, once */
+static size_t beziertreecacheqq4f_growth(struct cs2_beziertreecacheqq4f_s *c, size_t k)
+{
+    size_t g[CS2_BEZIERTREECACHEQQ4F_SHARDS], bytes = 0;
+    size_t i;
+
+    for (i = 0; i < CS2_BEZIERTREECACHEQQ4F_SHARDS; ++i)
+    {
+        pthread_mutex_lock(&c->s[i].m);
+        g[i] = (2 * (c->s[i].n + k) > c->s[i].cap && c->s[i].cap < CS2_BEZIERTREECACHEQQ4F_SLOTS) ? (c->s[i].cap ? c->s[i].cap : 64) : 0;
+        pthread_mutex_unlock(&c->s[i].m);
+    }
+
+    qsort(g, CS2_BEZIERTREECACHEQQ4F_SHARDS, sizeof(size_t), beziertreecacheqq4f_cmp);
+
+    for (i = 0; i < k && i < CS2_BEZIERTREECACHEQQ4F_SHARDS; ++i)
+        bytes += g[i] * sizeof(struct cs2_beziertreesampleqq4f_s);
+
+    return bytes;
+}
+
+size_t cs2_beziertreeqq4f_bytes(struct cs2_beziertreeqq4f_s *t)
+{
+    size_t bytes = t->np.count * t->np.size + t->lp.count * t->lp.size + t->hb;
+    int i;
+
+    if (!t->sc)
+        return bytes;
+
+    bytes += sizeof(struct cs2_beziertreecacheqq4f_s);
+
+    for (i = 0; i < CS2_BEZIERTREECACHEQQ4F_SHARDS; ++i)
+    {
+        pthread_mutex_lock(&t->sc->s[i].m);
+        bytes += t->sc->s[i].cap * sizeof(struct cs2_beziertreesampleqq4f_s);
+        pthread_mutex_unlock(&t->sc->s[i].m);
+    }
+
+    return bytes;
+}
+
+void cs2_beziertreeqq4f_drop_cache(struct cs2_beziertreeqq4f_s *t)
+{
+    int i;
+
+    if (!t->sc)
+        return;
+
+    for (i = 0; i < CS2_BEZIERTREECACHEQQ4F_SHARDS; ++i)
+    {
+        pthread_mutex_lock(&t->sc->s[i].m);
+        CS2_MEM_FREE(t->sc->s[i].e);
+        t->sc->s[i].e = NULL;
+        t->sc->s[i].n = 0;
+        t->sc->s[i].cap = 0;
+        pthread_mutex_unlock(&t->sc->s[i].m);
+    }
+}
+
+void cs2_beziertreeqq4f_cache_stats(struct cs2_beziertreeqq4f_s *t, size_t *hits, size_t *misses)
+{
+    int i;
+
+    *hits = 0;
+    *misses = 0;
+
+    if (!t->sc)
+        return;
+
+    for (i = 0; i < CS2_BEZIERTREECACHEQQ4F_SHARDS; ++i)
+    {
+        pthread_mutex_lock(&t->sc->s[i].m);
+        *hits += t->sc->s[i].hits;
+        *misses += t->sc->s[i].misses;
+        pthread_mutex_unlock(&t->sc->s[i].m);
+    }
+}
+
 double cs2_beziertreeqq4f_vol(struct cs2_beziertreeqq4f_s *t)
 {
     return cs2_beziertreenodeqq4f_vol(t->rn);
@@ -172,9 +515,135 @@ double cs2_beziertreeqq4f_area(struct cs2_beziertreeqq4f_s *t)
     return cs2_beziertreenodeqq4f_area(t->rn);
 }
 
+size_t cs2_beziertreeqq4f_leaves(struct cs2_beziertreeqq4f_s *t)
+{
+    return cs2_beziertreenodeqq4f_leaves(t->rn);
+}
+
+double cs2_beziertreeqq4f_max_vol(struct cs2_beziertreeqq4f_s *t)
+{
+    return cs2_beziertreenodeqq4f_max_vol(t->rn);
+}
+
+static void beziertreebvqq4f_collect(struct cs2_beziertreenodeqq4f_s **nl, size_t *c, struct cs2_beziertreenodeqq4f_s *n)
+{
+    int k;
+
+    if (cs2_beziertreenodeqq4f_is_leaf(n))
+        nl[(*c)++] = n;
+    else
+        for (k = 0; k < 4; ++k)
+            beziertreebvqq4f_collect(nl, c, n->c[k / 2][k % 2]);
+}
+
+/* leaves are distinct patches, so lazy volumes can be measured concurrently */
+static void beziertreebvqq4f_range(size_t begin, size_t end, void *d)
+{
+    struct cs2_beziertreenodeqq4f_s **nl = (struct cs2_beziertreenodeqq4f_s **)d;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+    {
+        nl[i]->vol = cs2_bezierqq4f_vol(&nl[i]->b, nl[i]->r->bv);
+        nl[i]->area = cs2_bezierqq4f_area(&nl[i]->b, nl[i]->r->bv);
+        nl[i]->svol = nl[i]->vol;
+        nl[i]->sarea = nl[i]->area;
+        nl[i]->smax = nl[i]->vol;
+    }
+}
+
+static void beziertreebvqq4f_aggr_r(struct cs2_beziertreenodeqq4f_s *n)
+{
+    int k;
+
+    if (cs2_beziertreenodeqq4f_is_leaf(n))
+        return;
+
+    for (k = 0; k < 4; ++k)
+        beziertreebvqq4f_aggr_r(n->c[k / 2][k % 2]);
+
+    _cs2_beziertreenodeqq4f_aggr(n);
+}
+
+void cs2_beziertreeqq4f_set_bv(struct cs2_beziertreeqq4f_s *t, enum cs2_bezierbvqq4f_e bv)
+{
+    struct cs2_beziertreenodeqq4f_s **nl;
+    size_t c = 0;
+
+    t->bv = bv;
+
+    /* a virtual leaf has no patch to measure */
+    if (!t->rn || cs2_beziertreenodeqq4f_is_leaf(t->rn))
+        return;
+
+    nl = CS2_MEM_MALLOC_N(struct cs2_beziertreenodeqq4f_s *, t->rn->sc);
+    beziertreebvqq4f_collect(nl, &c, t->rn);
+
+    cs2_thread_parallel_for(c, 16, beziertreebvqq4f_range, nl);
+    beziertreebvqq4f_aggr_r(t->rn);
+
+    CS2_MEM_FREE(nl);
+}
+
+struct beziertreehullsqq4f_b_s
+{
+    struct cs2_beziertreehullsqq4f_s *hs;
+    struct cs2_beziertreenodeqq4f_s *const *nl;
+};
+
+/* nodes are only read, so hulls can be built concurrently */
+static void beziertreehullsqq4f_range(size_t begin, size_t end, void *d)
+{
+    struct beziertreehullsqq4f_b_s *b = (struct beziertreehullsqq4f_b_s *)d;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+        b->hs->h[i] = cs2_beziertreenodeqq4f_is_virt(b->nl[i]) ? NULL : cs2_bezierqq4f_hull_tmp(&b->nl[i]->b, &b->hs->tmp[i]);
+}
+
+void cs2_beziertreehullsqq4f_init(struct cs2_beziertreehullsqq4f_s *hs)
+{
+    hs->h = NULL;
+    hs->tmp = NULL;
+    hs->n = 0;
+}
+
+void cs2_beziertreehullsqq4f_clear(struct cs2_beziertreehullsqq4f_s *hs)
+{
+    size_t i;
+
+    for (i = 0; i < hs->n; ++i)
+        cs2_hull4f_clear(&hs->tmp[i]);
+
+    CS2_MEM_FREE(hs->h);
+    CS2_MEM_FREE(hs->tmp);
+
+    cs2_beziertreehullsqq4f_init(hs);
+}
+
+void cs2_beziertreehullsqq4f_build(struct cs2_beziertreehullsqq4f_s *hs, struct cs2_beziertreenodeqq4f_s *const *nl, size_t n)
+{
+    struct beziertreehullsqq4f_b_s b;
+    size_t i;
+
+    cs2_beziertreehullsqq4f_clear(hs);
+
+    hs->h = CS2_MEM_MALLOC_N(const struct cs2_hull4f_s *, (n > 0 ? n : 1));
+    hs->tmp = CS2_MEM_MALLOC_N(struct cs2_hull4f_s, (n > 0 ? n : 1));
+    hs->n = n;
+
+    for (i = 0; i < n; ++i)
+        cs2_hull4f_init(&hs->tmp[i]);
+
+    b.hs = hs;
+    b.nl = nl;
+
+    cs2_thread_parallel_for(n, 4, beziertreehullsqq4f_range, &b);
+}
+
 static void beziertreeleafsqq4f_add(struct cs2_beziertreeleafsqq4f_s *l, struct cs2_beziertreenodeqq4f_s *n)
 {
-    struct cs2_beziertreeleafqq4f_s *nl = CS2_MEM_MALLOC(struct cs2_beziertreeleafqq4f_s);
+    struct cs2_beziertreeleafqq4f_s *nl = CS2_POOL_ALLOC(&l->t->lp, struct cs2_beziertreeleafqq4f_s);
     nl->n = n;
     nl->next = l->l;
     l->l = nl;
@@ -198,6 +667,7 @@ void cs2_beziertreeleafsqq4f_init(struct cs2_beziertreeleafsqq4f_s *l, struct cs
 {
     l->c = 0;
     l->l = 0;
+    l->t = t;
 
     if (t->rn)
         beziertreeleafsqq4f_init_r(l, t->rn);
@@ -210,26 +680,41 @@ void cs2_beziertreeleafsqq4f_clear(struct cs2_beziertreeleafsqq4f_s *l)
     while (ll)
     {
         nll = ll->next;
-        CS2_MEM_FREE(ll);
+        CS2_POOL_FREE(&l->t->lp, ll);
         ll = nll;
     }
 }
 
-static size_t beziertreeleafsqq4f_sub_vol_i(struct cs2_beziertreeleafqq4f_s *l, double vol, struct cs2_beziertreeleafqq4f_s **nl)
+double cs2_beziertreenodeqq4f_flatness(const struct cs2_beziertreenodeqq4f_s *n, void *d)
 {
-    struct cs2_beziertreeleafqq4f_s *l01, *l10, *l11;
+    (void)d;
 
-    if (!cs2_beziertreenodeqq4f_is_virt(l->n) && cs2_beziertreenodeqq4f_vol(l->n) <= vol)
-    {
-        *nl = (*nl)->next;
-        return 0;
-    }
+    /* the virtual root has no patch */
+    if (!n->p)
+        return INFINITY;
 
-    cs2_beziertreenodeqq4f_sub(l->n);
+    return cs2_bezierqq4f_flatness(&n->b);
+}
+
+static int beziertreeleafsqq4f_needs_sub(struct cs2_beziertreeleafqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d, double thr)
+{
+    return cs2_beziertreenodeqq4f_is_virt(l->n) || (f ? f(l->n, d) : cs2_beziertreenodeqq4f_vol(l->n)) > thr;
+}
+
+/* no leaf of the tree needs a split (known for the volume only), the list must be in sync */
+static int beziertreeleafsqq4f_done(struct cs2_beziertreeleafsqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, double thr)
+{
+    return !f && cs2_beziertreeqq4f_max_vol(l->t) <= thr;
+}
+
+/* replaces a leaf by the leaves of its (evaluated) children, in uv order */
+static void beziertreeleafsqq4f_split(struct cs2_beziertreeleafqq4f_s *l, struct cs2_pool_s *lp)
+{
+    struct cs2_beziertreeleafqq4f_s *l01, *l10, *l11;
 
-    l01 = CS2_MEM_MALLOC(struct cs2_beziertreeleafqq4f_s);
-    l10 = CS2_MEM_MALLOC(struct cs2_beziertreeleafqq4f_s);
-    l11 = CS2_MEM_MALLOC(struct cs2_beziertreeleafqq4f_s);
+    l01 = CS2_POOL_ALLOC(lp, struct cs2_beziertreeleafqq4f_s);
+    l10 = CS2_POOL_ALLOC(lp, struct cs2_beziertreeleafqq4f_s);
+    l11 = CS2_POOL_ALLOC(lp, struct cs2_beziertreeleafqq4f_s);
 
     l11->n = l->n->c[1][1];
     l10->n = l->n->c[1][0];
@@ -240,14 +725,965 @@ static size_t beziertreeleafsqq4f_sub_vol_i(struct cs2_beziertreeleafqq4f_s *l,
     l10->next = l11;
     l01->next = l10;
     l->next = l01;
+}
+
+/**
+ * replaces the entries from l up to e (exclusive) whose nodes were split outside of the
+ * list (e.g. by an intersection query) by the existing leaves of these nodes, in uv order;
+ * returns the number of added entries
+ */
+static size_t beziertreeleafsqq4f_expand(struct cs2_beziertreeleafqq4f_s *l, struct cs2_beziertreeleafqq4f_s *e, struct cs2_pool_s *lp)
+{
+    size_t c = 0;
+
+    for (; l != e; l = l->next)
+    {
+        while (!cs2_beziertreenodeqq4f_is_leaf(l->n))
+        {
+            beziertreeleafsqq4f_split(l, lp);
+            c += 3;
+        }
+    }
+
+    return c;
+}
+
+/* brings the list in sync with the leaves of the tree */
+static void beziertreeleafsqq4f_sync(struct cs2_beziertreeleafsqq4f_s *l)
+{
+    l->c += beziertreeleafsqq4f_expand(l->l, NULL, &l->t->lp);
+}
+
+static size_t beziertreeleafsqq4f_sub_i(struct cs2_beziertreeleafqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d, double thr, struct cs2_beziertreeleafqq4f_s **nl, struct cs2_pool_s *lp)
+{
+    if (!beziertreeleafsqq4f_needs_sub(l, f, d, thr))
+    {
+        *nl = (*nl)->next;
+        return 0;
+    }
+
+    cs2_beziertreenodeqq4f_sub(l->n);
+    beziertreeleafsqq4f_split(l, lp);
 
     return 3;
 }
 
+void cs2_beziertreeleafsqq4f_sub(struct cs2_beziertreeleafsqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d, double thr)
+{
+    struct cs2_beziertreeleafqq4f_s *ll;
+
+    beziertreeleafsqq4f_sync(l);
+
+    /* the rest of the list is done once no leaf of the tree needs a split */
+    ll = l->l;
+
+    while (ll && !beziertreeleafsqq4f_done(l, f, thr))
+        l->c += beziertreeleafsqq4f_sub_i(ll, f, d, thr, &ll, &l->t->lp);
+}
+
 void cs2_beziertreeleafsqq4f_sub_vol(struct cs2_beziertreeleafsqq4f_s *l, double vol)
 {
-    struct cs2_beziertreeleafqq4f_s *ll = l->l;
+    cs2_beziertreeleafsqq4f_sub(l, NULL, NULL, vol);
+}
 
-    while (ll)
-        l->c += beziertreeleafsqq4f_sub_vol_i(ll, vol, &ll);
+/* child evaluation of a refinement round: item 4 * i + j is child j of the i-th split leaf */
+static void beziertreeleafsqq4f_sub_range(size_t begin, size_t end, void *d)
+{
+    struct cs2_beziertreeleafqq4f_s **sl = (struct cs2_beziertreeleafqq4f_s **)d;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+        _cs2_beziertreenodeqq4f_sub_init(sl[i / 4]->n, (int)(i % 4));
 }
+
+void cs2_beziertreeleafsqq4f_sub_par(struct cs2_beziertreeleafsqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d, double thr)
+{
+    struct cs2_beziertreeleafqq4f_s *ll, **sl;
+    size_t i, n;
+
+    beziertreeleafsqq4f_sync(l);
+
+    for (;;)
+    {
+        if (beziertreeleafsqq4f_done(l, f, thr))
+            break;
+
+        /* leaves to split in this round, in list order */
+        n = 0;
+
+        for (ll = l->l; ll; ll = ll->next)
+            n += beziertreeleafsqq4f_needs_sub(ll, f, d, thr);
+
+        if (n == 0)
+            break;
+
+        sl = CS2_MEM_MALLOC_N(struct cs2_beziertreeleafqq4f_s *, n);
+
+        for (ll = l->l, i = 0; ll; ll = ll->next)
+            if (beziertreeleafsqq4f_needs_sub(ll, f, d, thr))
+                sl[i++] = ll;
+
+        /* pools are not thread-safe: allocate serially, evaluate in parallel */
+        for (i = 0; i < n; ++i)
+            _cs2_beziertreenodeqq4f_sub_alloc(sl[i]->n);
+
+        cs2_thread_parallel_for(4 * n, 4, beziertreeleafsqq4f_sub_range, sl);
+
+        for (i = 0; i < n; ++i)
+            _cs2_beziertreenodeqq4f_sub_done(sl[i]->n);
+
+        /* splitting in place keeps the serial leaf order */
+        for (i = 0; i < n; ++i)
+            beziertreeleafsqq4f_split(sl[i], &l->t->lp);
+
+        l->c += 3 * n;
+
+        CS2_MEM_FREE(sl);
+    }
+}
+
+void cs2_beziertreeleafsqq4f_sub_vol_par(struct cs2_beziertreeleafsqq4f_s *l, double vol)
+{
+    cs2_beziertreeleafsqq4f_sub_par(l, NULL, NULL, vol);
+}
+
+static double beziertreerefineqq4f_prio(const struct cs2_beziertreerefineqq4f_s *r, const struct cs2_beziertreenodeqq4f_s *n)
+{
+    /* the virtual root has no hull */
+    if (!n->p)
+        return INFINITY;
+
+    return r->f ? r->f(n, r->d) : n->vol;
+}
+
+static void beziertreerefineqq4f_push(struct cs2_beziertreerefineqq4f_s *r, struct cs2_beziertreeleafqq4f_s *l)
+{
+    struct cs2_beziertreeheapqq4f_s *h, e;
+    size_t i, p;
+
+    if (r->n == r->cap)
+    {
+        r->cap = r->cap ? 2 * r->cap : 64;
+        h = CS2_MEM_MALLOC_N(struct cs2_beziertreeheapqq4f_s, r->cap);
+
+        if (r->n > 0)
+            memcpy(h, r->h, sizeof(struct cs2_beziertreeheapqq4f_s) * r->n);
+
+        CS2_MEM_FREE(r->h);
+        r->h = h;
+    }
+
+    e.prio = beziertreerefineqq4f_prio(r, l->n);
+    e.l = l;
+
+    /* sift up */
+    for (i = r->n++; i > 0; i = p)
+    {
+        p = (i - 1) / 2;
+
+        if (r->h[p].prio >= e.prio)
+            break;
+
+        r->h[i] = r->h[p];
+    }
+
+    r->h[i] = e;
+}
+
+static struct cs2_beziertreeleafqq4f_s *beziertreerefineqq4f_pop(struct cs2_beziertreerefineqq4f_s *r)
+{
+    struct cs2_beziertreeleafqq4f_s *l = r->h[0].l;
+    struct cs2_beziertreeheapqq4f_s e = r->h[--r->n];
+    size_t i, c;
+
+    /* sift down */
+    for (i = 0; (c = 2 * i + 1) < r->n; i = c)
+    {
+        if (c + 1 < r->n && r->h[c + 1].prio > r->h[c].prio)
+            ++c;
+
+        if (e.prio >= r->h[c].prio)
+            break;
+
+        r->h[i] = r->h[c];
+    }
+
+    if (r->n > 0)
+        r->h[i] = e;
+
+    return l;
+}
+
+void cs2_beziertreerefineqq4f_init(struct cs2_beziertreerefineqq4f_s *r, struct cs2_beziertreeleafsqq4f_s *l, cs2_beziertreeprioqq4f_func_t f, void *d)
+{
+    struct cs2_beziertreeleafqq4f_s *ll;
+
+    r->l = l;
+    r->f = f;
+    r->d = d;
+    r->h = NULL;
+    r->n = 0;
+    r->cap = 0;
+
+    beziertreeleafsqq4f_sync(l);
+
+    for (ll = l->l; ll; ll = ll->next)
+        beziertreerefineqq4f_push(r, ll);
+}
+
+void cs2_beziertreerefineqq4f_clear(struct cs2_beziertreerefineqq4f_s *r)
+{
+    CS2_MEM_FREE(r->h);
+
+    r->h = NULL;
+    r->n = 0;
+    r->cap = 0;
+}
+
+double cs2_beziertreerefineqq4f_top(const struct cs2_beziertreerefineqq4f_s *r)
+{
+    return r->n > 0 ? r->h[0].prio : -INFINITY;
+}
+
+size_t cs2_beziertreerefineqq4f_run(struct cs2_beziertreerefineqq4f_s *r, const struct cs2_beziertreebudgetqq4f_s *b)
+{
+    struct cs2_beziertreeqq4f_s *t = r->l->t;
+    struct cs2_beziertreeleafqq4f_s *l, *e;
+    uint64_t start = b->usec ? cs2_timer_usec() : 0;
+    size_t splits = 0, bytes;
+
+    CS2_ASSERT_MSG(b->leaves || b->bytes || b->usec || b->prio > -INFINITY, "budget must be limited");
+
+    /* a split adds 4 nodes and 3 leaf entries */
+    bytes = 4 * t->np.size + 3 * t->lp.size;
+
+    while (r->n > 0 && r->h[0].prio > b->prio)
+    {
+        if (b->leaves && r->l->c + 3 > b->leaves)
+            break;
+
+        /* and evaluates 16 new samples */
+        if (b->bytes && cs2_beziertreeqq4f_bytes(t) + bytes + beziertreecacheqq4f_growth(t->sc, 16) > b->bytes)
+            break;
+
+        if (b->usec && splits > 0 && cs2_timer_usec() - start >= b->usec)
+            break;
+
+        l = beziertreerefineqq4f_pop(r);
+
+        /* split since the heap was built: queue the existing leaves instead */
+        if (!cs2_beziertreenodeqq4f_is_leaf(l->n))
+        {
+            e = l->next;
+            r->l->c += beziertreeleafsqq4f_expand(l, e, &t->lp);
+
+            for (; l != e; l = l->next)
+                beziertreerefineqq4f_push(r, l);
+
+            continue;
+        }
+
+        cs2_beziertreenodeqq4f_sub(l->n);
+        beziertreeleafsqq4f_split(l, &t->lp);
+
+        r->l->c += 3;
+        ++splits;
+
+        /* the split entry and its three successors are the children */
+        beziertreerefineqq4f_push(r, l);
+        beziertreerefineqq4f_push(r, l->next);
+        beziertreerefineqq4f_push(r, l->next->next);
+        beziertreerefineqq4f_push(r, l->next->next->next);
+    }
+
+    return splits;
+}
+
+void cs2_beziertreepairsqq4f_init(struct cs2_beziertreepairsqq4f_s *ps)
+{
+    ps->p = NULL;
+    ps->n = 0;
+    ps->cap = 0;
+}
+
+void cs2_beziertreepairsqq4f_clear(struct cs2_beziertreepairsqq4f_s *ps)
+{
+    CS2_MEM_FREE(ps->p);
+
+    ps->p = NULL;
+    ps->n = 0;
+    ps->cap = 0;
+}
+
+static void beziertreepairsqq4f_add(struct cs2_beziertreepairsqq4f_s *ps, struct cs2_beziertreenodeqq4f_s *a, struct cs2_beziertreenodeqq4f_s *b)
+{
+    struct cs2_beziertreepairqq4f_s *p;
+
+    if (ps->n == ps->cap)
+    {
+        ps->cap = ps->cap ? 2 * ps->cap : 64;
+        p = CS2_MEM_MALLOC_N(struct cs2_beziertreepairqq4f_s, ps->cap);
+
+        if (ps->n > 0)
+            memcpy(p, ps->p, sizeof(struct cs2_beziertreepairqq4f_s) * ps->n);
+
+        CS2_MEM_FREE(ps->p);
+        ps->p = p;
+    }
+
+    ps->p[ps->n].a = a;
+    ps->p[ps->n].b = b;
+    ++ps->n;
+}
+
+/* pair states of a round */
+enum
+{
+    BEZIERTREEINTERQQ4F_SEP,
+    BEZIERTREEINTERQQ4F_MAYBE,
+    BEZIERTREEINTERQQ4F_HULL
+};
+
+struct beziertreeinterqq4f_s
+{
+    struct cs2_beziertreepairqq4f_s *p;
+    int *s;
+
+    /* nodes to build hulls of / to evaluate children of */
+    struct cs2_beziertreenodeqq4f_s **n;
+};
+
+static void beziertreeinterqq4f_for(size_t n, size_t grain, cs2_thread_range_func_t f, void *d, int par)
+{
+    if (par)
+        cs2_thread_parallel_for(n, grain, f, d);
+    else if (n > 0)
+        f(0, n, d);
+}
+
+static void beziertreeinterqq4f_cheap_range(size_t begin, size_t end, void *d)
+{
+    struct beziertreeinterqq4f_s *it = (struct beziertreeinterqq4f_s *)d;
+    struct cs2_beziertreenodeqq4f_s *a, *b;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+    {
+        a = it->p[i].a;
+        b = it->p[i].b;
+
+        /* virtual roots have no volumes */
+        if (cs2_beziertreenodeqq4f_is_virt(a) || cs2_beziertreenodeqq4f_is_virt(b))
+            it->s[i] = BEZIERTREEINTERQQ4F_MAYBE;
+        else if (cs2_bezierqq4f_inter_bv(&a->b, &b->b, cs2_bezierbvqq4f_kdop) &&
+                 cs2_bezierqq4f_inter_bv(&a->b, &b->b, cs2_bezierbvqq4f_sphere) &&
+                 cs2_bezierqq4f_inter_bv(&a->b, &b->b, cs2_bezierbvqq4f_obb))
+            it->s[i] = BEZIERTREEINTERQQ4F_HULL;
+        else
+            it->s[i] = BEZIERTREEINTERQQ4F_SEP;
+    }
+}
+
+static void beziertreeinterqq4f_hull_range(size_t begin, size_t end, void *d)
+{
+    struct beziertreeinterqq4f_s *it = (struct beziertreeinterqq4f_s *)d;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+        cs2_bezierqq4f_hull(&it->n[i]->b);
+}
+
+static void beziertreeinterqq4f_exact_range(size_t begin, size_t end, void *d)
+{
+    struct beziertreeinterqq4f_s *it = (struct beziertreeinterqq4f_s *)d;
+    size_t i;
+
+    /* hulls are built, the test is read-only */
+    for (i = begin; i < end; ++i)
+        if (it->s[i] == BEZIERTREEINTERQQ4F_HULL)
+            it->s[i] = cs2_bezierqq4f_inter_bv(&it->p[i].a->b, &it->p[i].b->b, cs2_bezierbvqq4f_hull) ? BEZIERTREEINTERQQ4F_MAYBE : BEZIERTREEINTERQQ4F_SEP;
+}
+
+static void beziertreeinterqq4f_sub_range(size_t begin, size_t end, void *d)
+{
+    struct beziertreeinterqq4f_s *it = (struct beziertreeinterqq4f_s *)d;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+        _cs2_beziertreenodeqq4f_sub_init(it->n[i / 4], (int)(i % 4));
+}
+
+static int beziertreeinterqq4f_cmp(const void *a, const void *b)
+{
+    uintptr_t na = (uintptr_t)*(struct cs2_beziertreenodeqq4f_s *const *)a;
+    uintptr_t nb = (uintptr_t)*(struct cs2_beziertreenodeqq4f_s *const *)b;
+
+    return (na > nb) - (na < nb);
+}
+
+static int beziertreeinterqq4f_needs_sub(struct cs2_beziertreenodeqq4f_s *n, double vol)
+{
+    return cs2_beziertreenodeqq4f_is_virt(n) || n->vol > vol;
+}
+
+/* 1 if a is descended into, 0 if b */
+static int beziertreeinterqq4f_pick(struct cs2_beziertreenodeqq4f_s *a, struct cs2_beziertreenodeqq4f_s *b, double vol)
+{
+    if (!beziertreeinterqq4f_needs_sub(b, vol))
+        return 1;
+
+    if (!beziertreeinterqq4f_needs_sub(a, vol))
+        return 0;
+
+    if (cs2_beziertreenodeqq4f_is_virt(a))
+        return 1;
+
+    if (cs2_beziertreenodeqq4f_is_virt(b))
+        return 0;
+
+    return a->vol >= b->vol;
+}
+
+void cs2_beziertreeqq4f_inter(struct cs2_beziertreepairsqq4f_s *ps, struct cs2_beziertreeqq4f_s *ta, struct cs2_beziertreeqq4f_s *tb, double vol, int par)
+{
+    struct beziertreeinterqq4f_s it;
+    struct cs2_beziertreepairqq4f_s *np;
+    struct cs2_beziertreenodeqq4f_s *a, *b, *x;
+    size_t i, j, k, n, nn;
+    int pa;
+
+    CS2_ASSERT_MSG(ta->rn && tb->rn, "trees must be built from a func");
+
+    n = 1;
+    it.p = CS2_MEM_MALLOC_N(struct cs2_beziertreepairqq4f_s, 1);
+    it.p[0].a = ta->rn;
+    it.p[0].b = tb->rn;
+
+    while (n > 0)
+    {
+        it.s = CS2_MEM_MALLOC_N(int, n);
+        it.n = CS2_MEM_MALLOC_N(struct cs2_beziertreenodeqq4f_s *, 2 * n);
+
+        /* cheap volumes */
+        beziertreeinterqq4f_for(n, 64, beziertreeinterqq4f_cheap_range, &it, par);
+
+        /* hulls of inconclusive pairs, each built once */
+        for (i = 0, k = 0; i < n; ++i)
+        {
+            if (it.s[i] != BEZIERTREEINTERQQ4F_HULL)
+                continue;
+
+            if (!it.p[i].a->b.hv)
+                it.n[k++] = it.p[i].a;
+
+            if (!it.p[i].b->b.hv)
+                it.n[k++] = it.p[i].b;
+        }
+
+        qsort(it.n, k, sizeof(struct cs2_beziertreenodeqq4f_s *), beziertreeinterqq4f_cmp);
+
+        for (i = 0, j = 0; i < k; ++i)
+            if (j == 0 || it.n[j - 1] != it.n[i])
+                it.n[j++] = it.n[i];
+
+        beziertreeinterqq4f_for(j, 1, beziertreeinterqq4f_hull_range, &it, par);
+
+        for (i = 0; i < j; ++i)
+            it.n[i]->r->hb += cs2_hull4f_bytes(&it.n[i]->b.h);
+
+        beziertreeinterqq4f_for(n, 64, beziertreeinterqq4f_exact_range, &it, par);
+
+        /* report small pairs, allocate children of large ones */
+        for (i = 0, k = 0, nn = 0; i < n; ++i)
+        {
+            if (it.s[i] == BEZIERTREEINTERQQ4F_SEP)
+                continue;
+
+            a = it.p[i].a;
+            b = it.p[i].b;
+
+            if (!beziertreeinterqq4f_needs_sub(a, vol) && !beziertreeinterqq4f_needs_sub(b, vol))
+            {
+                beziertreepairsqq4f_add(ps, a, b);
+                it.s[i] = BEZIERTREEINTERQQ4F_SEP;
+                continue;
+            }
+
+            x = beziertreeinterqq4f_pick(a, b, vol) ? a : b;
+
+            /* pools are not thread-safe: allocate serially, evaluate in parallel */
+            if (cs2_beziertreenodeqq4f_is_leaf(x))
+            {
+                _cs2_beziertreenodeqq4f_sub_alloc(x);
+                it.n[k++] = x;
+            }
+
+            nn += 4;
+        }
+
+        beziertreeinterqq4f_for(4 * k, 4, beziertreeinterqq4f_sub_range, &it, par);
+
+        for (i = 0; i < k; ++i)
+            _cs2_beziertreenodeqq4f_sub_done(it.n[i]);
+
+        /* next round */
+        np = CS2_MEM_MALLOC_N(struct cs2_beziertreepairqq4f_s, (nn > 0 ? nn : 1));
+
+        for (i = 0, j = 0; i < n; ++i)
+        {
+            if (it.s[i] == BEZIERTREEINTERQQ4F_SEP)
+                continue;
+
+            a = it.p[i].a;
+            b = it.p[i].b;
+            pa = beziertreeinterqq4f_pick(a, b, vol);
+            x = pa ? a : b;
+
+            for (k = 0; k < 4; ++k)
+            {
+                np[j].a = pa ? x->c[k / 2][k % 2] : a;
+                np[j].b = pa ? b : x->c[k / 2][k % 2];
+                ++j;
+            }
+        }
+
+        CS2_MEM_FREE(it.s);
+        CS2_MEM_FREE(it.n);
+        CS2_MEM_FREE(it.p);
+
+        it.p = np;
+        n = nn;
+    }
+
+    CS2_MEM_FREE(it.p);
+}
+
+uint64_t cs2_beziertreeimgqq4f_key(const void *d, size_t n, uint64_t seed)
+{
+    const unsigned char *b = (const unsigned char *)d;
+    uint64_t h = seed ? seed : 0xcbf29ce484222325ULL;
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+    {
+        h ^= b[i];
+        h *= 0x100000001b3ULL;
+    }
+
+    return h;
+}
+
+struct beziertreeimgqq4f_w_s
+{
+    struct cs2_beziertreeimgnodeqq4f_s *n;
+    struct cs2_plane4f_s *hr;
+    struct cs2_vec4f_s *vr;
+    uint64_t nn, np, nv;
+
+    /* hulls in preorder */
+    struct cs2_beziertreehullsqq4f_s hs;
+};
+
+/* preorder, the order of nodes in the image; returns the depth of the subtree */
+static int beziertreeimgqq4f_collect(struct cs2_beziertreenodeqq4f_s **nl, size_t *c, struct cs2_beziertreenodeqq4f_s *n)
+{
+    int d = 0, k, l;
+
+    nl[(*c)++] = n;
+
+    if (!cs2_beziertreenodeqq4f_is_leaf(n))
+        for (k = 0; k < 4; ++k)
+            if ((l = 1 + beziertreeimgqq4f_collect(nl, c, n->c[k / 2][k % 2])) > d)
+                d = l;
+
+    return d;
+}
+
+static uint32_t beziertreeimgqq4f_put(struct beziertreeimgqq4f_w_s *w, struct cs2_beziertreenodeqq4f_s *n, uint32_t p)
+{
+    uint32_t i = (uint32_t)w->nn++;
+    struct cs2_beziertreeimgnodeqq4f_s *r = &w->n[i];
+    const struct cs2_hull4f_s *h = w->hs.h[i];
+    int k;
+
+    memset(r, 0, sizeof(struct cs2_beziertreeimgnodeqq4f_s));
+
+    /* the virtual root has no patch */
+    if (!cs2_beziertreenodeqq4f_is_virt(n))
+        cs2_bezierqq4f_cp(r->cp, &n->b);
+
+    r->u0 = n->u0;
+    r->u1 = n->u1;
+    r->u2 = n->u2;
+    r->v0 = n->v0;
+    r->v1 = n->v1;
+    r->v2 = n->v2;
+    r->vol = n->vol;
+    r->area = n->area;
+    r->p = p;
+    r->hv = h != NULL;
+
+    if (h)
+    {
+        r->hvol = h->vol;
+        r->harea = h->area;
+        r->hr = w->np;
+        r->nhr = h->nhr;
+        r->vr = w->nv;
+        r->nvr = h->nvr;
+
+        memcpy(w->hr + w->np, h->hr, sizeof(struct cs2_plane4f_s) * h->nhr);
+        memcpy(w->vr + w->nv, h->vr, sizeof(struct cs2_vec4f_s) * h->nvr);
+
+        w->np += h->nhr;
+        w->nv += h->nvr;
+    }
+
+    for (k = 0; k < 4; ++k)
+        r->c[k] = cs2_beziertreenodeqq4f_is_leaf(n) ? CS2_BEZIERTREEIMGQQ4F_NONE : beziertreeimgqq4f_put(w, n->c[k / 2][k % 2], i);
+
+    return i;
+}
+
+int cs2_beziertreeqq4f_save(struct cs2_beziertreeqq4f_s *t, const char *path, uint64_t key)
+{
+    struct cs2_beziertreeimghdrqq4f_s h;
+    struct beziertreeimgqq4f_w_s w;
+    struct cs2_beziertreenodeqq4f_s **nl;
+    size_t c = 0, i;
+    char *tmp;
+    FILE *f;
+    int depth, fd, ok;
+
+    CS2_ASSERT_MSG(t->rn != NULL, "tree must be built from a func");
+
+    /* flatten */
+    memset(&w, 0, sizeof(w));
+
+    nl = CS2_MEM_MALLOC_N(struct cs2_beziertreenodeqq4f_s *, t->np.count);
+    depth = beziertreeimgqq4f_collect(nl, &c, t->rn);
+
+    w.nn = c;
+
+    if (w.nn >= CS2_BEZIERTREEIMGQQ4F_NONE || depth > CS2_BEZIERTREEIMGQQ4F_DEPTH)
+    {
+        CS2_MEM_FREE(nl);
+        return -1;
+    }
+
+    /* refinement measures hulls without building them, the image stores temporary ones */
+    cs2_beziertreehullsqq4f_init(&w.hs);
+    cs2_beziertreehullsqq4f_build(&w.hs, nl, c);
+
+    CS2_MEM_FREE(nl);
+
+    for (i = 0; i < c; ++i)
+    {
+        if (w.hs.h[i])
+        {
+            w.np += w.hs.h[i]->nhr;
+            w.nv += w.hs.h[i]->nvr;
+        }
+    }
+
+    memset(&h, 0, sizeof(h));
+    h.magic = CS2_BEZIERTREEIMGQQ4F_MAGIC;
+    h.version = CS2_BEZIERTREEIMGQQ4F_VERSION;
+    h.order = CS2_BEZIERTREEIMGQQ4F_ORDER;
+    h.key = key;
+    h.bv = (uint32_t)t->bv;
+    h.nn = w.nn;
+    h.np = w.np;
+    h.nv = w.nv;
+    h.on = sizeof(struct cs2_beziertreeimghdrqq4f_s);
+    h.op = h.on + sizeof(struct cs2_beziertreeimgnodeqq4f_s) * h.nn;
+    h.ov = h.op + sizeof(struct cs2_plane4f_s) * h.np;
+    h.size = h.ov + sizeof(struct cs2_vec4f_s) * h.nv;
+
+    w.n = CS2_MEM_MALLOC_N(struct cs2_beziertreeimgnodeqq4f_s, w.nn);
+    w.hr = CS2_MEM_MALLOC_N(struct cs2_plane4f_s, (w.np > 0 ? w.np : 1));
+    w.vr = CS2_MEM_MALLOC_N(struct cs2_vec4f_s, (w.nv > 0 ? w.nv : 1));
+    w.nn = w.np = w.nv = 0;
+
+    beziertreeimgqq4f_put(&w, t->rn, CS2_BEZIERTREEIMGQQ4F_NONE);
+    cs2_beziertreehullsqq4f_clear(&w.hs);
+
+    /* write a unique temporary file and rename it, readers never see a partial tree */
+    tmp = CS2_MEM_MALLOC_N(char, (strlen(path) + 8));
+    sprintf(tmp, "%s.XXXXXX", path);
+
+    fd = mkstemp(tmp);
+    f = NULL;
+
+    if (fd >= 0)
+    {
+        /* mkstemp creates the file private to the user, images are shared */
+        f = fchmod(fd, 0644) == 0 ? fdopen(fd, "wb") : NULL;
+
+        if (!f)
+        {
+            close(fd);
+            unlink(tmp);
+        }
+    }
+
+    ok = f != NULL;
+
+    if (f)
+    {
+        ok = ok && fwrite(&h, sizeof(h), 1, f) == 1;
+        ok = ok && fwrite(w.n, sizeof(struct cs2_beziertreeimgnodeqq4f_s), w.nn, f) == w.nn;
+        ok = ok && fwrite(w.hr, sizeof(struct cs2_plane4f_s), w.np, f) == w.np;
+        ok = ok && fwrite(w.vr, sizeof(struct cs2_vec4f_s), w.nv, f) == w.nv;
+        ok = (fclose(f) == 0) && ok;
+        ok = ok && rename(tmp, path) == 0;
+
+        if (!ok)
+            unlink(tmp);
+    }
+
+    CS2_MEM_FREE(tmp);
+    CS2_MEM_FREE(w.n);
+    CS2_MEM_FREE(w.hr);
+    CS2_MEM_FREE(w.vr);
+
+    return ok ? 0 : -1;
+}
+
+void cs2_beziertreeimgqq4f_init(struct cs2_beziertreeimgqq4f_s *img)
+{
+    img->m = NULL;
+    img->size = 0;
+    img->h = NULL;
+    img->n = NULL;
+    img->hr = NULL;
+    img->vr = NULL;
+}
+
+void cs2_beziertreeimgqq4f_clear(struct cs2_beziertreeimgqq4f_s *img)
+{
+    if (img->m)
+        munmap(img->m, img->size);
+
+    cs2_beziertreeimgqq4f_init(img);
+}
+
+static int beziertreeimgqq4f_check(const void *m, size_t size, uint64_t key)
+{
+    const struct cs2_beziertreeimghdrqq4f_s *h = (const struct cs2_beziertreeimghdrqq4f_s *)m;
+    const struct cs2_beziertreeimgnodeqq4f_s *n;
+    uint64_t i, j;
+    int k, l;
+
+    /* header */
+    if (size < sizeof(struct cs2_beziertreeimghdrqq4f_s))
+        return 0;
+
+    if (h->magic != CS2_BEZIERTREEIMGQQ4F_MAGIC || h->version != CS2_BEZIERTREEIMGQQ4F_VERSION || h->order != CS2_BEZIERTREEIMGQQ4F_ORDER)
+        return 0;
+
+    if (h->key != key || h->bv >= cs2_bezierbvqq4f_COUNT || h->size != size)
+        return 0;
+
+    /* sections (overflow-safe) */
+    if (h->on != sizeof(struct cs2_beziertreeimghdrqq4f_s) || h->nn < 1 || h->nn >= CS2_BEZIERTREEIMGQQ4F_NONE)
+        return 0;
+
+    if (h->nn > (size - h->on) / sizeof(struct cs2_beziertreeimgnodeqq4f_s) || h->op != h->on + sizeof(struct cs2_beziertreeimgnodeqq4f_s) * h->nn)
+        return 0;
+
+    if (h->np > (size - h->op) / sizeof(struct cs2_plane4f_s) || h->ov != h->op + sizeof(struct cs2_plane4f_s) * h->np)
+        return 0;
+
+    if (h->nv != (size - h->ov) / sizeof(struct cs2_vec4f_s) || h->size != h->ov + sizeof(struct cs2_vec4f_s) * h->nv)
+        return 0;
+
+    /*
+     * nodes: children follow their parent (preorder) and point back at it, each
+     * non-root node is a distinct child of its parent (so referenced exactly once),
+     * hull ranges are in bounds
+     */
+    n = (const struct cs2_beziertreeimgnodeqq4f_s *)((const char *)m + h->on);
+
+    if (n[0].p != CS2_BEZIERTREEIMGQQ4F_NONE)
+        return 0;
+
+    for (i = 0; i < h->nn; ++i)
+    {
+        for (k = 0; k < 4; ++k)
+        {
+            if ((n[i].c[k] == CS2_BEZIERTREEIMGQQ4F_NONE) != (n[i].c[0] == CS2_BEZIERTREEIMGQQ4F_NONE))
+                return 0;
+
+            if (n[i].c[k] == CS2_BEZIERTREEIMGQQ4F_NONE)
+                continue;
+
+            if (n[i].c[k] <= i || n[i].c[k] >= h->nn || n[n[i].c[k]].p != i)
+                return 0;
+
+            for (l = 0; l < k; ++l)
+                if (n[i].c[l] == n[i].c[k])
+                    return 0;
+        }
+
+        if (i > 0)
+        {
+            if (n[i].p >= i)
+                return 0;
+
+            for (k = 0; k < 4 && n[n[i].p].c[k] != i; ++k)
+                ;
+
+            if (k == 4)
+                return 0;
+
+            /* depth bound, the parents are already checked (walks at most the bound) */
+            for (j = n[i].p, l = 1; j != 0 && l <= CS2_BEZIERTREEIMGQQ4F_DEPTH; j = n[j].p, ++l)
+                ;
+
+            if (l > CS2_BEZIERTREEIMGQQ4F_DEPTH)
+                return 0;
+        }
+
+        if (n[i].nhr > h->np || n[i].hr > h->np - n[i].nhr || n[i].nvr > h->nv || n[i].vr > h->nv - n[i].nvr)
+            return 0;
+    }
+
+    return 1;
+}
+
+int cs2_beziertreeimgqq4f_load(struct cs2_beziertreeimgqq4f_s *img, const char *path, uint64_t key)
+{
+    struct stat st;
+    void *m;
+    int fd;
+
+    cs2_beziertreeimgqq4f_clear(img);
+
+    fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return -1;
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    /* shared read-only mapping, the descriptor is not needed afterwards */
+    m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (m == MAP_FAILED)
+        return -1;
+
+    if (!beziertreeimgqq4f_check(m, (size_t)st.st_size, key))
+    {
+        munmap(m, (size_t)st.st_size);
+        return -1;
+    }
+
+    img->m = m;
+    img->size = (size_t)st.st_size;
+    img->h = (const struct cs2_beziertreeimghdrqq4f_s *)m;
+    img->n = (const struct cs2_beziertreeimgnodeqq4f_s *)((const char *)m + img->h->on);
+    img->hr = (const struct cs2_plane4f_s *)((const char *)m + img->h->op);
+    img->vr = (const struct cs2_vec4f_s *)((const char *)m + img->h->ov);
+
+    return 0;
+}
+
+const struct cs2_hull4f_s *cs2_beziertreeimgqq4f_hull(struct cs2_hull4f_s *h, const struct cs2_beziertreeimgqq4f_s *img, size_t i)
+{
+    const struct cs2_beziertreeimgnodeqq4f_s *r = &img->n[i];
+
+    /* the view is only handed out as const, the mapped pages are never written */
+    h->hr = (struct cs2_plane4f_s *)(img->hr + r->hr);
+    h->nhr = (size_t)r->nhr;
+    h->vr = (struct cs2_vec4f_s *)(img->vr + r->vr);
+    h->nvr = (size_t)r->nvr;
+    h->vs = NULL;
+    h->vol = r->hvol;
+    h->area = r->harea;
+
+    return h;
+}
+
+static struct cs2_beziertreenodeqq4f_s *beziertreeimgqq4f_get(struct cs2_beziertreeqq4f_s *t, const struct cs2_beziertreeimgqq4f_s *img, uint32_t i, struct cs2_beziertreenodeqq4f_s *pn)
+{
+    const struct cs2_beziertreeimgnodeqq4f_s *r = &img->n[i];
+    struct cs2_beziertreenodeqq4f_s *n = CS2_POOL_ALLOC(&t->np, struct cs2_beziertreenodeqq4f_s);
+    int k;
+
+    cs2_bezierqq4f_init(&n->b);
+
+    if (pn)
+        cs2_bezierqq4f_from_cp(&n->b, r->cp);
+
+    /* hulls are copied, live nodes own them */
+    if (r->hv)
+    {
+        n->b.h.nhr = (size_t)r->nhr;
+        n->b.h.nvr = (size_t)r->nvr;
+
+        if (r->nhr > 0)
+        {
+            n->b.h.hr = CS2_MEM_MALLOC_N(struct cs2_plane4f_s, n->b.h.nhr);
+            memcpy(n->b.h.hr, img->hr + r->hr, sizeof(struct cs2_plane4f_s) * n->b.h.nhr);
+        }
+
+        if (r->nvr > 0)
+        {
+            n->b.h.vr = CS2_MEM_MALLOC_N(struct cs2_vec4f_s, n->b.h.nvr);
+            memcpy(n->b.h.vr, img->vr + r->vr, sizeof(struct cs2_vec4f_s) * n->b.h.nvr);
+        }
+
+        n->b.h.vol = r->hvol;
+        n->b.h.area = r->harea;
+        n->b.hv = 1;
+
+        /* no soa mirror: it would double the memory of every loaded hull */
+        t->hb += cs2_hull4f_bytes(&n->b.h);
+    }
+
+    n->u0 = r->u0;
+    n->u1 = r->u1;
+    n->u2 = r->u2;
+    n->v0 = r->v0;
+    n->v1 = r->v1;
+    n->v2 = r->v2;
+    n->vol = r->vol;
+    n->area = r->area;
+    n->r = t;
+    n->p = pn;
+
+    for (k = 0; k < 4; ++k)
+        n->c[k / 2][k % 2] = r->c[k] == CS2_BEZIERTREEIMGQQ4F_NONE ? 0 : beziertreeimgqq4f_get(t, img, r->c[k], n);
+
+    if (n->c[0][0])
+        _cs2_beziertreenodeqq4f_aggr(n);
+    else
+    {
+        n->svol = n->vol;
+        n->sarea = n->area;
+        n->smax = pn ? n->vol : INFINITY;
+        n->sc = 1;
+    }
+
+    return n;
+}
+
+void cs2_beziertreeqq4f_from_img(struct cs2_beziertreeqq4f_s *t, const struct cs2_beziertreeimgqq4f_s *img, cs2_beziertreeqq4f_func_t f, void *d)
+{
+    t->f = f;
+    t->d = d;
+    t->bv = (enum cs2_bezierbvqq4f_e)img->h->bv;
+
+    /* samples of a previous func are stale */
+    _cs2_beziertreecacheqq4f_destroy(t->sc);
+    t->sc = _cs2_beziertreecacheqq4f_create();
+
+    t->rn = beziertreeimgqq4f_get(t, img, 0, NULL);
+}
+
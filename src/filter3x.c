@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/filter3x.h"
+#include "cs2/assert.h"
+#include <float.h>
+#include <math.h>
+
+/* infinities mark values out of double range */
+#if defined(__FAST_MATH__) || (defined(__FINITE_MATH_ONLY__) && __FINITE_MATH_ONLY__)
+#error "filter3x must be built without fast math"
+#endif
+
+/* stats */
+static uint64_t g_filter3x_hits[cs2_filter3x_COUNT];
+static uint64_t g_filter3x_misses[cs2_filter3x_COUNT];
+
+const char *cs2_filter3x_str(enum cs2_filter3x_e f)
+{
+    switch (f)
+    {
+    case cs2_filter3x_spinquad3x_sign: return "spinquad3x_sign";
+    case cs2_filter3x_predg3x_type: return "predg3x_type";
+    case cs2_filter3x_spinquad3x_eval: return "spinquad3x_eval";
+    case cs2_filter3x_spinquad3x_from_predg3x: return "spinquad3x_from_predg3x";
+
+    /* COUNT */
+    case cs2_filter3x_COUNT: return 0;
+    }
+
+    return 0;
+}
+
+void cs2_filter3x_stats(struct cs2_filter3x_stats_s *stats, enum cs2_filter3x_e f)
+{
+    CS2_ASSERT_MSG(f >= 0 && f < cs2_filter3x_COUNT, "invalid filter");
+
+    stats->hits = __atomic_load_n(&g_filter3x_hits[f], __ATOMIC_RELAXED);
+    stats->calls = stats->hits + __atomic_load_n(&g_filter3x_misses[f], __ATOMIC_RELAXED);
+}
+
+void cs2_filter3x_reset_stats(void)
+{
+    int f;
+
+    for (f = 0; f < cs2_filter3x_COUNT; ++f)
+    {
+        __atomic_store_n(&g_filter3x_hits[f], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_filter3x_misses[f], 0, __ATOMIC_RELAXED);
+    }
+}
+
+void cs2_filter3x_record(enum cs2_filter3x_e f, int hit)
+{
+    /* one atomic per call: calls = hits + misses */
+    __atomic_fetch_add(hit ? &g_filter3x_hits[f] : &g_filter3x_misses[f], 1, __ATOMIC_RELAXED);
+}
+
+double cs2_filter3x_get_d(mpz_srcptr x)
+{
+    double d;
+
+    /* single limb: one rounded conversion */
+    if (mpz_size(x) <= 1)
+    {
+        d = (double)mpz_getlimbn(x, 0);
+        return mpz_sgn(x) < 0 ? -d : d;
+    }
+
+    /* mpz_get_d truncates, so the relative error is below one ulp; huge values do not fit */
+    if (mpz_sizeinbase(x, 2) > DBL_MAX_EXP - 1)
+        return mpz_sgn(x) < 0 ? -INFINITY : INFINITY;
+
+    return mpz_get_d(x);
+}
+
+#if defined(CS2_FILTER3X_INT128)
+int cs2_filter3x_get_si(long *r, mpz_srcptr x)
+{
+    size_t bits = mpz_sizeinbase(x, 2);
+
+    if (bits > 63)
+        return -1;
+
+    *r = mpz_get_si(x);
+
+    return (int)bits;
+}
+
+void cs2_filter3x_set_i128(mpz_ptr r, cs2_int128_t x)
+{
+    unsigned __int128 m = x < 0 ? -(unsigned __int128)x : (unsigned __int128)x;
+
+    mpz_set_ui(r, (unsigned long)(m >> 64));
+
+    if (m >> 64)
+        mpz_mul_2exp(r, r, 64);
+
+    mpz_add_ui(r, r, (unsigned long)m);
+
+    if (x < 0)
+        mpz_neg(r, r);
+}
+#endif /* defined(CS2_FILTER3X_INT128) */
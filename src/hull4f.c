@@ -30,24 +30,268 @@
 #include <setjmp.h>
 #include <cs2/assert.h>
 #include <stdio.h>
+#include <math.h>
+
+/* facet capacity of the small kernel (a 4-polytope with 16 vertices has at most 104 facets) */
+#define CS2_HULL4F_SMALL_FACETS 256
+
+/* relative distance tolerance of the small kernel */
+#define CS2_HULL4F_SMALL_EPS 1e-12
+
+/* relative tolerances (degeneracy, convergence) and iteration limit of gjk */
+#define CS2_HULL4F_GJK_EPS 1e-12
+#define CS2_HULL4F_GJK_REL 1e-10
+#define CS2_HULL4F_GJK_ITERS 64
+
+/* facet of the small kernel: a tetrahedron with sorted vertex indices and an outer plane */
+struct _cs2_hull4f_facet_s
+{
+    int v[4];
+    struct cs2_vec4f_s n;
+    double d, area;
+};
+
+/* ridge of a visible facet: a triangle with sorted vertex indices */
+struct _cs2_hull4f_ridge_s
+{
+    int v[3];
+    int dup;
+};
+
+struct _cs2_hull4f_small_s
+{
+    /* points in local coordinates and an interior point */
+    struct cs2_vec4f_s p[CS2_HULL4F_SMALL_N];
+    struct cs2_vec4f_s o;
+
+    struct _cs2_hull4f_facet_s f[CS2_HULL4F_SMALL_FACETS];
+    size_t nf;
+
+    struct _cs2_hull4f_ridge_s r[4 * CS2_HULL4F_SMALL_FACETS];
+
+    /* distance tolerance */
+    double eps;
+};
+
+/* vertices tested per early exit check of the soa separation test */
+#define CS2_HULL4F_SEP_BLOCK 8
+
+/* no vertex of the soa v-rep is below the plane (a, b, c, e) * x + d */
+CS2_SIMD_CLONES
+static int _cs2_hull4f_sep_n(const double *vs, size_t n, double a, double b, double c, double e, double d)
+{
+    const double *x = vs, *y = vs + n, *z = vs + 2 * n, *w = vs + 3 * n;
+    size_t i, j, k;
+    int neg;
+
+    for (i = 0; i < n; i += CS2_HULL4F_SEP_BLOCK)
+    {
+        k = n - i < CS2_HULL4F_SEP_BLOCK ? n : i + CS2_HULL4F_SEP_BLOCK;
+        neg = 0;
+
+        for (j = i; j < k; ++j)
+            neg |= a * x[j] + b * y[j] + c * z[j] + e * w[j] + d < 0.0;
+
+        if (neg)
+            return 0;
+    }
+
+    return 1;
+}
 
 static int _cs2_hull4f_sep(const struct cs2_hull4f_s *h, const struct cs2_plane4f_s *p)
 {
+    const struct cs2_vec4f_s *v;
     size_t vi;
 
+    if (h->vs)
+        return _cs2_hull4f_sep_n(h->vs, h->nvr, p->n.x, p->n.y, p->n.z, p->n.w, p->d);
+
+    /* hulls without the mirror (e.g. views of a tree image) */
     for (vi = 0; vi < h->nvr; ++vi)
-        if (cs2_plane4f_pops(p, &h->vr[vi]) < 0.0)
+    {
+        v = &h->vr[vi];
+
+        if (p->n.x * v->x + p->n.y * v->y + p->n.z * v->z + p->n.w * v->w + p->d < 0.0)
             return 0;
+    }
 
     return 1;
 }
 
+/* generalized cross product: orthogonal to a, b and c, its length is the volume of their parallelotope */
+static void _cs2_hull4f_cross(struct cs2_vec4f_s *r, const struct cs2_vec4f_s *a, const struct cs2_vec4f_s *b, const struct cs2_vec4f_s *c)
+{
+    double xy = b->x * c->y - b->y * c->x;
+    double xz = b->x * c->z - b->z * c->x;
+    double xw = b->x * c->w - b->w * c->x;
+    double yz = b->y * c->z - b->z * c->y;
+    double yw = b->y * c->w - b->w * c->y;
+    double zw = b->z * c->w - b->w * c->z;
+
+    r->x = a->y * zw - a->z * yw + a->w * yz;
+    r->y = -(a->x * zw - a->z * xw + a->w * xz);
+    r->z = a->x * yw - a->y * xw + a->w * xy;
+    r->w = -(a->x * yz - a->y * xz + a->z * xy);
+}
+
+static double _cs2_hull4f_dist(const struct _cs2_hull4f_facet_s *f, const struct cs2_vec4f_s *p)
+{
+    return cs2_vec4f_dot(&f->n, p) + f->d;
+}
+
+/* facet through 4 points, oriented away from the interior point */
+static int _cs2_hull4f_small_facet(struct _cs2_hull4f_small_s *s, int a, int b, int c, int d)
+{
+    struct _cs2_hull4f_facet_s *f;
+    struct cs2_vec4f_s e1, e2, e3;
+    double l, o;
+    int i, j, t;
+
+    if (s->nf == CS2_HULL4F_SMALL_FACETS)
+        return -1;
+
+    f = &s->f[s->nf];
+
+    f->v[0] = a;
+    f->v[1] = b;
+    f->v[2] = c;
+    f->v[3] = d;
+
+    for (i = 1; i < 4; ++i)
+        for (j = i; j > 0 && f->v[j - 1] > f->v[j]; --j)
+        {
+            t = f->v[j];
+            f->v[j] = f->v[j - 1];
+            f->v[j - 1] = t;
+        }
+
+    cs2_vec4f_sub(&e1, &s->p[f->v[1]], &s->p[f->v[0]]);
+    cs2_vec4f_sub(&e2, &s->p[f->v[2]], &s->p[f->v[0]]);
+    cs2_vec4f_sub(&e3, &s->p[f->v[3]], &s->p[f->v[0]]);
+
+    _cs2_hull4f_cross(&f->n, &e1, &e2, &e3);
+
+    l = cs2_vec4f_len(&f->n);
+
+    /* a flat tetrahedron has no reliable normal */
+    if (!(l > 0.0))
+        return -1;
+
+    cs2_vec4f_mul(&f->n, &f->n, 1.0 / l);
+    f->d = -cs2_vec4f_dot(&f->n, &s->p[f->v[0]]);
+    f->area = l / 6.0;
+
+    o = _cs2_hull4f_dist(f, &s->o);
+
+    if (fabs(o) <= s->eps)
+        return -1;
+
+    if (o > 0.0)
+    {
+        cs2_vec4f_neg(&f->n, &f->n);
+        f->d = -f->d;
+    }
+
+    ++s->nf;
+
+    return 0;
+}
+
+/* greedy initial simplex: each vertex is farthest from the affine span of the previous ones */
+static int _cs2_hull4f_small_simplex(struct _cs2_hull4f_small_s *s, int *sv, size_t n)
+{
+    struct cs2_vec4f_s q[4], r;
+    double l, bl;
+    size_t i;
+    int j, k;
+
+    sv[0] = 0;
+
+    for (k = 0; k < 4; ++k)
+    {
+        sv[k + 1] = -1;
+        bl = s->eps;
+
+        for (i = 1; i < n; ++i)
+        {
+            cs2_vec4f_sub(&r, &s->p[i], &s->p[sv[0]]);
+
+            for (j = 0; j < k; ++j)
+                cs2_vec4f_mad2(&r, &r, 1.0, &q[j], -cs2_vec4f_dot(&r, &q[j]));
+
+            l = cs2_vec4f_len(&r);
+
+            if (l > bl)
+            {
+                bl = l;
+                sv[k + 1] = (int)i;
+                cs2_vec4f_mul(&q[k], &r, 1.0 / l);
+            }
+        }
+
+        if (sv[k + 1] < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/* adds a point outside of the hull: visible facets are replaced by a cone over the horizon */
+static int _cs2_hull4f_small_add(struct _cs2_hull4f_small_s *s, int pi)
+{
+    struct _cs2_hull4f_facet_s *f;
+    struct _cs2_hull4f_ridge_s *r;
+    size_t i, j, nf = 0, nr = 0;
+    int k, m, c;
+
+    /* visible facets are removed, their ridges are kept */
+    for (i = 0; i < s->nf; ++i)
+    {
+        f = &s->f[i];
+
+        if (_cs2_hull4f_dist(f, &s->p[pi]) > s->eps)
+        {
+            for (k = 0; k < 4; ++k)
+            {
+                r = &s->r[nr++];
+                r->dup = 0;
+
+                for (m = 0, c = 0; m < 4; ++m)
+                    if (m != k)
+                        r->v[c++] = f->v[m];
+            }
+        }
+        else
+            s->f[nf++] = *f;
+    }
+
+    /* inside (or on the boundary) */
+    if (!nr)
+        return 0;
+
+    s->nf = nf;
+
+    /* a ridge of two visible facets is interior, the rest is the horizon */
+    for (i = 0; i < nr; ++i)
+        for (j = i + 1; j < nr && !s->r[i].dup; ++j)
+            if (!s->r[j].dup && s->r[i].v[0] == s->r[j].v[0] && s->r[i].v[1] == s->r[j].v[1] && s->r[i].v[2] == s->r[j].v[2])
+                s->r[i].dup = s->r[j].dup = 1;
+
+    for (i = 0; i < nr; ++i)
+        if (!s->r[i].dup && _cs2_hull4f_small_facet(s, s->r[i].v[0], s->r[i].v[1], s->r[i].v[2], pi))
+            return -1;
+
+    return 0;
+}
+
 void cs2_hull4f_init(struct cs2_hull4f_s *h)
 {
     h->hr = NULL;
     h->nhr = 0;
     h->vr = NULL;
     h->nvr = 0;
+    h->vs = NULL;
     h->vol = 0.0;
     h->area = 0.0;
 }
@@ -56,6 +300,31 @@ void cs2_hull4f_clear(struct cs2_hull4f_s *h)
 {
     CS2_MEM_FREE(h->hr);
     CS2_MEM_FREE(h->vr);
+    CS2_MEM_FREE(h->vs);
+
+    /* reusable without init */
+    cs2_hull4f_init(h);
+}
+
+size_t cs2_hull4f_bytes(const struct cs2_hull4f_s *h)
+{
+    return sizeof(struct cs2_plane4f_s) * h->nhr + sizeof(struct cs2_vec4f_s) * h->nvr + (h->vs ? 4 * sizeof(double) * h->nvr : 0);
+}
+
+void cs2_hull4f_soa(struct cs2_hull4f_s *h)
+{
+    size_t i, n = h->nvr;
+
+    CS2_MEM_FREE(h->vs);
+    h->vs = CS2_MEM_MALLOC_N(double, (4 * (n > 0 ? n : 1)));
+
+    for (i = 0; i < n; ++i)
+    {
+        h->vs[i] = h->vr[i].x;
+        h->vs[n + i] = h->vr[i].y;
+        h->vs[2 * n + i] = h->vr[i].z;
+        h->vs[3 * n + i] = h->vr[i].w;
+    }
 }
 
 void cs2_hull4f_from_arr(struct cs2_hull4f_s *h, const struct cs2_vec4f_s *v, size_t n)
@@ -69,6 +338,10 @@ void cs2_hull4f_from_arr(struct cs2_hull4f_s *h, const struct cs2_vec4f_s *v, si
     vertexT *vi;
     int i;
 
+    /* patch hulls: no qhull context for a handful of points */
+    if (n <= CS2_HULL4F_SMALL_N && !cs2_hull4f_from_arr_small(h, v, n))
+        return;
+
     /* qhull lib check */
     QHULL_LIB_CHECK
 
@@ -120,6 +393,8 @@ void cs2_hull4f_from_arr(struct cs2_hull4f_s *h, const struct cs2_vec4f_s *v, si
 
         h->vol = qh.totvol;
         h->area = qh.totarea;
+
+        cs2_hull4f_soa(h);
     }
     else
     {
@@ -133,6 +408,147 @@ void cs2_hull4f_from_arr(struct cs2_hull4f_s *h, const struct cs2_vec4f_s *v, si
     CS2_ASSERT_MSG(!curlong && !totlong, "qhull mem leak");
 }
 
+/* triangulated boundary of a small point set in local coordinates (relative to v[0]) */
+static int _cs2_hull4f_small_build(struct _cs2_hull4f_small_s *s, const struct cs2_vec4f_s *v, size_t n)
+{
+    int sv[5], used[CS2_HULL4F_SMALL_N];
+    double sc = 0.0, cm;
+    size_t i;
+    int k;
+
+    if (n < 5 || n > CS2_HULL4F_SMALL_N)
+        return -1;
+
+    /* local coordinates keep the tolerance relative to the size of the set */
+    cm = fmax(fmax(fabs(v[0].x), fabs(v[0].y)), fmax(fabs(v[0].z), fabs(v[0].w)));
+
+    for (i = 0; i < n; ++i)
+    {
+        cs2_vec4f_sub(&s->p[i], &v[i], &v[0]);
+        sc = fmax(sc, fmax(fmax(fabs(s->p[i].x), fabs(s->p[i].y)), fmax(fabs(s->p[i].z), fabs(s->p[i].w))));
+        used[i] = 0;
+    }
+
+    s->eps = CS2_HULL4F_SMALL_EPS * (sc + cm);
+    s->nf = 0;
+
+    if (_cs2_hull4f_small_simplex(s, sv, n))
+        return -1;
+
+    cs2_vec4f_zero(&s->o);
+
+    for (k = 0; k < 5; ++k)
+    {
+        cs2_vec4f_add(&s->o, &s->o, &s->p[sv[k]]);
+        used[sv[k]] = 1;
+    }
+
+    cs2_vec4f_mul(&s->o, &s->o, 0.2);
+
+    for (k = 0; k < 5; ++k)
+        if (_cs2_hull4f_small_facet(s, sv[(k + 1) % 5], sv[(k + 2) % 5], sv[(k + 3) % 5], sv[(k + 4) % 5]))
+            return -1;
+
+    for (i = 0; i < n; ++i)
+        if (!used[i] && _cs2_hull4f_small_add(s, (int)i))
+            return -1;
+
+    return 0;
+}
+
+/* volume and area: pyramids of the boundary facets over the interior point */
+static void _cs2_hull4f_small_measure(const struct _cs2_hull4f_small_s *s, double *vol, double *area)
+{
+    size_t i;
+
+    *vol = 0.0;
+    *area = 0.0;
+
+    for (i = 0; i < s->nf; ++i)
+    {
+        *area += s->f[i].area;
+        *vol -= s->f[i].area * _cs2_hull4f_dist(&s->f[i], &s->o) / 4.0;
+    }
+}
+
+int cs2_hull4f_from_arr_small(struct cs2_hull4f_s *h, const struct cs2_vec4f_s *v, size_t n)
+{
+    struct _cs2_hull4f_small_s s;
+    struct cs2_plane4f_s hr[CS2_HULL4F_SMALL_FACETS];
+    int used[CS2_HULL4F_SMALL_N];
+    double vol, area;
+    size_t i, j, nhr = 0, nvr = 0;
+    int k;
+
+    if (_cs2_hull4f_small_build(&s, v, n))
+        return -1;
+
+    _cs2_hull4f_small_measure(&s, &vol, &area);
+
+    /* vertices of the boundary */
+    for (i = 0; i < n; ++i)
+        used[i] = 0;
+
+    for (i = 0; i < s.nf; ++i)
+        for (k = 0; k < 4; ++k)
+            used[s.f[i].v[k]] = 1;
+
+    /* h-rep with coplanar facets merged, back in global coordinates */
+    for (i = 0; i < s.nf; ++i)
+    {
+        for (j = 0; j < i; ++j)
+            if (fabs(s.f[i].d - s.f[j].d) <= s.eps && cs2_vec4f_dot(&s.f[i].n, &s.f[j].n) >= 1.0 - CS2_HULL4F_SMALL_EPS)
+                break;
+
+        if (j == i)
+            cs2_plane4f_set(&hr[nhr++], &s.f[i].n, s.f[i].d - cs2_vec4f_dot(&s.f[i].n, &v[0]));
+    }
+
+    h->nhr = nhr;
+    h->hr = CS2_MEM_MALLOC_N(struct cs2_plane4f_s, nhr);
+
+    for (i = 0; i < nhr; ++i)
+        cs2_plane4f_copy(&h->hr[i], &hr[i]);
+
+    for (i = 0; i < n; ++i)
+        nvr += (size_t)used[i];
+
+    h->nvr = nvr;
+    h->vr = CS2_MEM_MALLOC_N(struct cs2_vec4f_s, nvr);
+
+    for (i = 0, j = 0; i < n; ++i)
+        if (used[i])
+            cs2_vec4f_copy(&h->vr[j++], &v[i]);
+
+    h->vol = vol;
+    h->area = area;
+
+    cs2_hull4f_soa(h);
+
+    return 0;
+}
+
+void cs2_hull4f_measure_arr(double *vol, double *area, const struct cs2_vec4f_s *v, size_t n)
+{
+    struct _cs2_hull4f_small_s s;
+    struct cs2_hull4f_s h;
+
+    if (n <= CS2_HULL4F_SMALL_N && !_cs2_hull4f_small_build(&s, v, n))
+    {
+        _cs2_hull4f_small_measure(&s, vol, area);
+        return;
+    }
+
+    /* large or degenerate sets: a temporary full hull */
+    cs2_hull4f_init(&h);
+    cs2_hull4f_from_arr(&h, v, n);
+
+    *vol = h.vol;
+    *area = h.area;
+
+    cs2_hull4f_clear(&h);
+}
+
 int cs2_hull4f_inter(const struct cs2_hull4f_s *ha, const struct cs2_hull4f_s *hb)
 {
     size_t i;
@@ -152,6 +568,244 @@ int cs2_hull4f_inter(const struct cs2_hull4f_s *ha, const struct cs2_hull4f_s *h
     return 1;
 }
 
+static void _cs2_hull4f_support(struct cs2_vec4f_s *s, const struct cs2_vec4f_s *v, size_t n, const struct cs2_vec4f_s *d)
+{
+    double t, bt = -INFINITY;
+    size_t i, bi = 0;
+
+    for (i = 0; i < n; ++i)
+    {
+        t = cs2_vec4f_dot(&v[i], d);
+
+        if (t > bt)
+        {
+            bt = t;
+            bi = i;
+        }
+    }
+
+    cs2_vec4f_copy(s, &v[bi]);
+}
+
+/* support of the minkowski difference a - b */
+static void _cs2_hull4f_support_diff(struct cs2_vec4f_s *s, const struct cs2_vec4f_s *va, size_t na, const struct cs2_vec4f_s *vb, size_t nb, const struct cs2_vec4f_s *d)
+{
+    struct cs2_vec4f_s sa, sb, nd;
+
+    cs2_vec4f_neg(&nd, d);
+
+    _cs2_hull4f_support(&sa, va, na, d);
+    _cs2_hull4f_support(&sb, vb, nb, &nd);
+
+    cs2_vec4f_sub(s, &sa, &sb);
+}
+
+/**
+ * projection of the origin onto the affine hull of the points selected by 'm', given the
+ * gram matrix 'g' of the points: barycentric coordinates, returns -1 for a degenerate subset
+ */
+static int _cs2_hull4f_gjk_proj(double *l, double g[5][5], int m)
+{
+    double a[4][5], t, s = 0.0;
+    int idx[5], c = 0, i, j, k, r;
+
+    for (i = 0; i < 5; ++i)
+        if (m & (1 << i))
+            idx[c++] = i;
+
+    /* normal equations of the edge vectors from the first point */
+    for (i = 1; i < c; ++i)
+    {
+        for (j = 1; j < c; ++j)
+            a[i - 1][j - 1] = g[idx[i]][idx[j]] - g[idx[i]][idx[0]] - g[idx[0]][idx[j]] + g[idx[0]][idx[0]];
+
+        a[i - 1][c - 1] = g[idx[0]][idx[0]] - g[idx[i]][idx[0]];
+        s = fmax(s, a[i - 1][i - 1]);
+    }
+
+    /* gaussian elimination with partial pivoting */
+    for (k = 0; k < c - 1; ++k)
+    {
+        r = k;
+
+        for (i = k + 1; i < c - 1; ++i)
+            if (fabs(a[i][k]) > fabs(a[r][k]))
+                r = i;
+
+        if (fabs(a[r][k]) <= CS2_HULL4F_GJK_EPS * s)
+            return -1;
+
+        for (j = k; j < c; ++j)
+        {
+            t = a[k][j];
+            a[k][j] = a[r][j];
+            a[r][j] = t;
+        }
+
+        for (i = k + 1; i < c - 1; ++i)
+            for (j = c - 1, t = a[i][k] / a[k][k]; j >= k; --j)
+                a[i][j] -= t * a[k][j];
+    }
+
+    for (i = 0; i < 5; ++i)
+        l[i] = 0.0;
+
+    l[idx[0]] = 1.0;
+
+    for (k = c - 2; k >= 0; --k)
+    {
+        t = a[k][c - 1];
+
+        for (j = k + 1; j < c - 1; ++j)
+            t -= a[k][j] * l[idx[j + 1]];
+
+        l[idx[k + 1]] = t / a[k][k];
+        l[idx[0]] -= l[idx[k + 1]];
+    }
+
+    return 0;
+}
+
+/**
+ * closest point of a simplex (up to 5 points) to the origin, the simplex is reduced to
+ * its support; the newest point is the last one and the closest point lies on a face
+ * containing it
+ */
+static void _cs2_hull4f_gjk_closest(struct cs2_vec4f_s *v, struct cs2_vec4f_s *p, int *n)
+{
+    double g[5][5], l[5], bl[5], t, bt = INFINITY;
+    int m, i, j, bm = 0, c;
+
+    for (i = 0; i < *n; ++i)
+        for (j = i; j < *n; ++j)
+            g[i][j] = g[j][i] = cs2_vec4f_dot(&p[i], &p[j]);
+
+    /* the projection inside its face with the least norm */
+    for (m = 1 << (*n - 1); m < (1 << *n); ++m)
+    {
+        if (_cs2_hull4f_gjk_proj(l, g, m))
+            continue;
+
+        for (i = 0; i < *n; ++i)
+            if ((m & (1 << i)) && l[i] <= 0.0)
+                break;
+
+        if (i < *n)
+            continue;
+
+        for (i = 0, t = 0.0; i < *n; ++i)
+            for (j = 0; j < *n; ++j)
+                t += l[i] * l[j] * g[i][j];
+
+        if (t < bt)
+        {
+            bt = t;
+            bm = m;
+
+            for (i = 0; i < 5; ++i)
+                bl[i] = l[i];
+        }
+    }
+
+    /* the newest point alone is always a valid face */
+    CS2_ASSERT(bm);
+
+    cs2_vec4f_zero(v);
+
+    for (i = 0, c = 0; i < *n; ++i)
+        if (bm & (1 << i))
+        {
+            cs2_vec4f_mad2(v, v, 1.0, &p[i], bl[i]);
+            cs2_vec4f_copy(&p[c++], &p[i]);
+        }
+
+    *n = c;
+}
+
+int cs2_hull4f_gjk_arr_it(double *dist, struct cs2_vec4f_s *w, const struct cs2_vec4f_s *va, size_t na, const struct cs2_vec4f_s *vb, size_t nb, int *iters)
+{
+    struct cs2_vec4f_s p[5], v, pv, nv, s;
+    double vv, pvv, mm = 0.0;
+    int n = 0, it;
+
+    CS2_ASSERT(na > 0 && nb > 0);
+
+    /* initial point: the closest point was -dist * w, so the support is searched along w */
+    if (cs2_vec4f_sqlen(w) > 0.0)
+        _cs2_hull4f_support_diff(&v, va, na, vb, nb, w);
+    else
+        cs2_vec4f_sub(&v, &va[0], &vb[0]);
+
+    cs2_vec4f_copy(&p[n++], &v);
+    vv = cs2_vec4f_sqlen(&v);
+
+    for (it = 0; it < CS2_HULL4F_GJK_ITERS; ++it)
+    {
+        mm = fmax(mm, vv);
+
+        /* the origin is (numerically) in the simplex */
+        if (vv <= CS2_HULL4F_GJK_EPS * CS2_HULL4F_GJK_EPS * mm)
+            break;
+
+        cs2_vec4f_neg(&nv, &v);
+        _cs2_hull4f_support_diff(&s, va, na, vb, nb, &nv);
+
+        /* no progress towards the origin: v is the closest point */
+        if (vv - cs2_vec4f_dot(&v, &s) <= CS2_HULL4F_GJK_REL * vv)
+            break;
+
+        mm = fmax(mm, cs2_vec4f_sqlen(&s));
+        cs2_vec4f_copy(&p[n++], &s);
+
+        cs2_vec4f_copy(&pv, &v);
+        pvv = vv;
+
+        _cs2_hull4f_gjk_closest(&v, p, &n);
+        vv = cs2_vec4f_sqlen(&v);
+
+        /* a full simplex contains the origin */
+        if (n == 5)
+        {
+            vv = 0.0;
+            break;
+        }
+
+        /* roundoff: the distance must decrease */
+        if (vv >= pvv)
+        {
+            cs2_vec4f_copy(&v, &pv);
+            vv = pvv;
+            break;
+        }
+    }
+
+    if (iters)
+        *iters = it;
+
+    /* intersection (an iteration limit is reported conservatively) */
+    if (it == CS2_HULL4F_GJK_ITERS || vv <= CS2_HULL4F_GJK_EPS * CS2_HULL4F_GJK_EPS * mm)
+    {
+        *dist = 0.0;
+
+        return 1;
+    }
+
+    *dist = sqrt(vv);
+    cs2_vec4f_mul(w, &v, -1.0 / *dist);
+
+    return 0;
+}
+
+int cs2_hull4f_gjk_arr(double *dist, struct cs2_vec4f_s *w, const struct cs2_vec4f_s *va, size_t na, const struct cs2_vec4f_s *vb, size_t nb)
+{
+    return cs2_hull4f_gjk_arr_it(dist, w, va, na, vb, nb, NULL);
+}
+
+int cs2_hull4f_gjk(double *dist, struct cs2_vec4f_s *w, const struct cs2_hull4f_s *ha, const struct cs2_hull4f_s *hb)
+{
+    return cs2_hull4f_gjk_arr(dist, w, ha->vr, ha->nvr, hb->vr, hb->nvr);
+}
+
 void cs2_hull4f_print_json(struct cs2_hull4f_s *h, FILE *f, size_t indent)
 {
     size_t i;
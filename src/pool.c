@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/pool.h"
+#include "cs2/mem.h"
+#include "cs2/assert.h"
+
+/* alignment of objects */
+#define CS2_POOL_ALIGN 16
+
+/* objects in the first and the largest slab */
+#define CS2_POOL_GROW_MIN 64
+#define CS2_POOL_GROW_MAX 65536
+
+/* slab header, padded to the object alignment */
+struct cs2_poolslab_s
+{
+    struct cs2_poolslab_s *next;
+    char pad[CS2_POOL_ALIGN - sizeof(struct cs2_poolslab_s *)];
+};
+
+static void _cs2_pool_grow(struct cs2_pool_s *p)
+{
+    struct cs2_poolslab_s *s = (struct cs2_poolslab_s *)CS2_MEM_MALLOC_N(char, sizeof(struct cs2_poolslab_s) + p->size * p->grow);
+
+    s->next = (struct cs2_poolslab_s *)p->slabs;
+    p->slabs = s;
+
+    p->cur = (char *)(s + 1);
+    p->end = p->cur + p->size * p->grow;
+
+    /* geometric growth keeps the number of slabs logarithmic */
+    if (p->grow < CS2_POOL_GROW_MAX)
+        p->grow *= 2;
+}
+
+void cs2_pool_init(struct cs2_pool_s *p, size_t size)
+{
+    CS2_ASSERT_MSG(size > 0, "invalid object size");
+
+    /* free objects store the free list link */
+    if (size < sizeof(void *))
+        size = sizeof(void *);
+
+    p->size = (size + CS2_POOL_ALIGN - 1) / CS2_POOL_ALIGN * CS2_POOL_ALIGN;
+    p->grow = CS2_POOL_GROW_MIN;
+    p->slabs = NULL;
+    p->cur = NULL;
+    p->end = NULL;
+    p->free = NULL;
+    p->count = 0;
+}
+
+void cs2_pool_clear(struct cs2_pool_s *p)
+{
+    struct cs2_poolslab_s *n, *s = (struct cs2_poolslab_s *)p->slabs;
+
+    while (s)
+    {
+        n = s->next;
+        CS2_MEM_FREE(s);
+        s = n;
+    }
+
+    cs2_pool_init(p, p->size);
+}
+
+void *cs2_pool_alloc(struct cs2_pool_s *p)
+{
+    void *ptr;
+
+    ++p->count;
+
+    /* recycled */
+    if (p->free)
+    {
+        ptr = p->free;
+        p->free = *(void **)ptr;
+        return ptr;
+    }
+
+    if (p->cur == p->end)
+        _cs2_pool_grow(p);
+
+    ptr = p->cur;
+    p->cur += p->size;
+
+    return ptr;
+}
+
+void cs2_pool_free(struct cs2_pool_s *p, void *ptr)
+{
+    CS2_ASSERT_MSG(p->count > 0, "pool is empty");
+
+    *(void **)ptr = p->free;
+    p->free = ptr;
+
+    --p->count;
+}
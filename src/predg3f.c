@@ -29,6 +29,9 @@
 #include "cs2/mat33f.h"
 #include "cs2/mathf.h"
 #include "cs2/assert.h"
+#include "cs2/mem.h"
+#include "cs2/thread.h"
+#include "cs2/verify.h"
 #include <math.h>
 
 #define EPS (10e-8)
@@ -105,7 +108,7 @@ static void _cs2_debug_verify_eigen_decomposition(const struct cs2_predgparam3f_
         {
             len = cs2_vec4f_len(&tv);
 
-            CS2_ASSERT_MSG(len < EPS_LEN,
+            CS2_VERIFY_MSG(len < EPS_LEN,
                            "eigenvalue is zero but transformed eigenvector is non-zero: len=%.12f, e=%.12f, tv=[%.12f, %.12f, %.12f, %.12f]^T",
                            len, e, tv.x, tv.y, tv.z, tv.w);
             continue;
@@ -115,7 +118,7 @@ static void _cs2_debug_verify_eigen_decomposition(const struct cs2_predgparam3f_
         cs2_vec4f_sub(&df, &tv, &lv);
         err = cs2_vec4f_len(&df);
 
-        CS2_ASSERT_MSG(err < EPS_DIFF,
+        CS2_VERIFY_MSG(err < EPS_DIFF,
                        "failed to obtain required eigen decomposition accuracy: "
                        "eps=%.12f, err=%.12f, tv_%d=[%.12f, %.12f, %.12f, %.12f]^T, lv_%d=[%.12f, %.12f, %.12f, %.12f]^T",
                        EPS_DIFF, err, i, tv.x, tv.y, tv.z, tv.w, i, lv.x, lv.y, lv.z, lv.w);
@@ -140,7 +143,7 @@ static void _cs2_debug_verify_rotation_matrix(const struct cs2_predgparam3f_s *p
             else
                 err = fabs(dot);
 
-            CS2_ASSERT_MSG(err < EPS_DOT,
+            CS2_VERIFY_MSG(err < EPS_DOT,
                            "failed to obtain rotation matrix: "
                            "eps=%.12f, err=%.12f, dot=%.12f, ev_%d=[%.12f, %.12f, %.12f, %.12f]^T, ev_%d=[%.12f, %.12f, %.12f, %.12f]^T",
                            EPS_DOT, err, dot, i, pp->ev[i].x, pp->ev[i].y, pp->ev[i].z, pp->ev[i].w, j, pp->ev[j].x, pp->ev[j].y, pp->ev[j].z, pp->ev[j].w);
@@ -157,7 +160,7 @@ static void _cs2_debug_verify_spinor(const struct cs2_spin3f_s *s)
     len = sqrt(s->s12 * s->s12 + s->s23 * s->s23 + s->s31 * s->s31 + s->s0 * s->s0);
     err = fabs(1.0 - len);
 
-    CS2_ASSERT_MSG(err < EPS_LEN,
+    CS2_VERIFY_MSG(err < EPS_LEN,
                    "failed to obtain a valid spinor: "
                    "eps=%.12f, err=%.12f, len=%.12f, s=%.12f e12 + %.12f e23 + %.12f e31 + %.12f",
                    EPS_LEN, err, len, s->s12, s->s23, s->s31, s->s0);
@@ -171,7 +174,7 @@ static void _cs2_debug_verify_eigenvector(const struct cs2_vec4f_s *v)
 
     len = cs2_vec4f_len(v);
 
-    CS2_ASSERT_MSG(len > EPS_LEN,
+    CS2_VERIFY_MSG(len > EPS_LEN,
                    "failed to obtain a valid non-zero eigenvector: "
                    "eps=%.12f, len=%.12f, v=[%.12f, %.12f, %.12f, %.12f]^T",
                    EPS_LEN, len, v->x, v->y, v->z, v->w);
@@ -185,14 +188,14 @@ static void _cs2_debug_verify_ellipsoidal_eigenpinor(const struct cs2_pin3f_s *p
 
     len = cs2_pin3f_len(p);
 
-    CS2_ASSERT_MSG(len > EPS_LEN,
+    CS2_VERIFY_MSG(len > EPS_LEN,
                    "failed to obtain a valid ellipoidal eigen pinor: "
                    "eps=%.12f, len=%.12f, p=%.12f e12 + %.12f e23 + %.12f e31 + %.12f",
                    EPS_LEN, len, p->p12, p->p23, p->p31, p->p0);
 
     prop = 2.0 * sqrt(_cs2_clamp_0(p->p0));
 
-    CS2_ASSERT_MSG(fabs(len - prop) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(len - prop) < EPS_LEN,
                    "failed to check property of scalar in ellipoidal eigen pinor: "
                    "eps=%.12f, len=%.12f, prop=%.12f, p=%.12f e12 + %.12f e23 + %.12f e31 + %.12f",
                    EPS_LEN, len, prop, p->p12, p->p23, p->p31, p->p0);
@@ -226,62 +229,62 @@ void _cs2_debug_verify_inverse_pquvc(const struct cs2_spinquad3f_s *sq, const st
     cs2_spinquad3f_unit(&nsq, sq);
     cs2_spinquad3f_unit(&tsq, &tsq);
 
-    CS2_ASSERT_MSG(fabs(nsq.a11 - tsq.a11) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a11 - tsq.a11) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a11=%.12f, a11=%.12f",
                    EPS_LEN, nsq.a11, tsq.a11);
 
-    CS2_ASSERT_MSG(fabs(nsq.a12 - tsq.a12) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a12 - tsq.a12) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a12=%.12f, a12=%.12f",
                    EPS_LEN, nsq.a12, tsq.a12);
 
-    CS2_ASSERT_MSG(fabs(nsq.a13 - tsq.a13) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a13 - tsq.a13) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a13=%.12f, a13=%.12f",
                    EPS_LEN, nsq.a13, tsq.a13);
 
-    CS2_ASSERT_MSG(fabs(nsq.a14 - tsq.a14) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a14 - tsq.a14) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a14=%.12f, a14=%.12f",
                    EPS_LEN, nsq.a14, tsq.a14);
 
-    CS2_ASSERT_MSG(fabs(nsq.a22 - tsq.a22) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a22 - tsq.a22) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a22=%.12f, a22=%.12f",
                    EPS_LEN, nsq.a22, tsq.a22);
 
-    CS2_ASSERT_MSG(fabs(nsq.a23 - tsq.a23) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a23 - tsq.a23) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a23=%.12f, a23=%.12f",
                    EPS_LEN, nsq.a23, tsq.a23);
 
-    CS2_ASSERT_MSG(fabs(nsq.a24 - tsq.a24) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a24 - tsq.a24) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a24=%.12f, a24=%.12f",
                    EPS_LEN, nsq.a24, tsq.a24);
 
-    CS2_ASSERT_MSG(fabs(nsq.a33 - tsq.a33) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a33 - tsq.a33) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a33=%.12f, a33=%.12f",
                    EPS_LEN, nsq.a33, tsq.a33);
 
-    CS2_ASSERT_MSG(fabs(nsq.a34 - tsq.a34) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a34 - tsq.a34) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a34=%.12f, a34=%.12f",
                    EPS_LEN, nsq.a34, tsq.a34);
 
-    CS2_ASSERT_MSG(fabs(nsq.a44 - tsq.a44) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(nsq.a44 - tsq.a44) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, sq_a44=%.12f, a44=%.12f",
                    EPS_LEN, nsq.a44, tsq.a44);
 
-    CS2_ASSERT_MSG(fabs(pu) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(pu) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, pu=%.12f",
                    EPS_LEN, pu);
 
-    CS2_ASSERT_MSG(fabs(qv) < EPS_LEN,
+    CS2_VERIFY_MSG(fabs(qv) < EPS_LEN,
                    "failed to check solution to inverse spin quadric: "
                    "eps=%.12f, qv=%.12f",
                    EPS_LEN, qv);
@@ -306,7 +309,11 @@ static void _cs2_calc_ellipsoidal_eigenvector(struct cs2_vec4f_s *w, const struc
     cs2_pin3f_cl(&uhvh, &uh, &vh);
     cs2_pin3f_cl(&phxuhqhxvh, &phxuh, &qhxvh);
     cs2_pin3f_mad4(&wp, &CS2_PIN3F_ONE, 1.0, &phxuhqhxvh, a * b, &phqh, -a, &uhvh, -b);
-    _cs2_debug_verify_ellipsoidal_eigenpinor(&wp);
+
+    /* debug */
+    if (CS2_VERIFY_SAMPLE())
+        _cs2_debug_verify_ellipsoidal_eigenpinor(&wp);
+
     cs2_pin3f_mul(&ws, &wp, 0.5 / sqrt(_cs2_clamp_0(wp.p0)));
     cs2_vec4f_from_pin3f(w, &ws);
 }
@@ -360,7 +367,7 @@ static void _cs2_calc_toroidal_eigenplane(struct cs2_vec4f_s *w1, struct cs2_vec
     cs2_vec4f_unit(w2, &ozv);
 }
 
-static void _cs2_calc_eigen_decomposition(struct cs2_predgparam3f_s *pp, const struct cs2_predg3f_s *g)
+static void _cs2_calc_eigen_decomposition(struct cs2_predgparam3f_s *pp, const struct cs2_predg3f_s *g, enum cs2_predgtype3f_e pgt)
 {
     int i;
 
@@ -371,7 +378,7 @@ static void _cs2_calc_eigen_decomposition(struct cs2_predgparam3f_s *pp, const s
     pp->e[3] = pp->c - (-pp->a - pp->b);
 
     /* eigenvectors */
-    switch (cs2_predg3f_type(g))
+    switch (pgt)
     {
         case cs2_predgtype3f_improper:
             cs2_vec4f_set(&pp->ev[0], 1.0, 0.0, 0.0, 0.0);
@@ -415,11 +422,14 @@ static void _cs2_calc_eigen_decomposition(struct cs2_predgparam3f_s *pp, const s
     }
 
     /* debug */
-    for (i = 0; i < 4; ++i)
-        _cs2_debug_verify_eigenvector(&pp->ev[i]);
+    if (CS2_VERIFY_SAMPLE())
+    {
+        for (i = 0; i < 4; ++i)
+            _cs2_debug_verify_eigenvector(&pp->ev[i]);
 
-    _cs2_debug_verify_eigen_decomposition(pp, g);
-    _cs2_debug_verify_rotation_matrix(pp);
+        _cs2_debug_verify_eigen_decomposition(pp, g);
+        _cs2_debug_verify_rotation_matrix(pp);
+    }
 }
 
 static void _cs2_improper_eigen_decomposition(struct cs2_predgparam3f_s *pp, const struct cs2_predg3f_s *g)
@@ -642,6 +652,94 @@ static enum cs2_predgparamtype3f_e _cs2_toroidal_param_type(double a, double b,
     return cs2_predgparamtype3f_COUNT;
 }
 
+/* basic properties, returns the predicate type */
+static enum cs2_predgtype3f_e _cs2_predg3f_param_basic(struct cs2_predgparam3f_s *pgp, const struct cs2_predg3f_s *pg)
+{
+    int za, zb;
+
+    cs2_predg3f_pquv(&pgp->p, &pgp->q, &pgp->u, &pgp->v, pg);
+
+    pgp->a = cs2_vec3f_len(&pgp->p) * cs2_vec3f_len(&pgp->q);
+    pgp->b = cs2_vec3f_len(&pgp->u) * cs2_vec3f_len(&pgp->v);
+    pgp->c = pg->c;
+
+    /* non-zero characteristics */
+    za = _cs2_almost_zero(pgp->a);
+    zb = _cs2_almost_zero(pgp->b);
+
+    if (!za && !zb)
+        return cs2_predgtype3f_ellipsoidal;
+    else if (!za || !zb)
+        return cs2_predgtype3f_toroidal;
+    else
+        return cs2_predgtype3f_improper;
+}
+
+/* parametrization type and eigen decomposition */
+static void _cs2_predg3f_param_typed(struct cs2_predgparam3f_s *pgp, const struct cs2_predg3f_s *pg, enum cs2_predgtype3f_e pgt)
+{
+    switch (pgt)
+    {
+        case cs2_predgtype3f_ellipsoidal:
+            pgp->t = _cs2_ellipsoidal_param_type(pgp->a, pgp->b, pgp->c);
+            _cs2_calc_eigen_decomposition(pgp, pg, pgt);
+            break;
+
+        case cs2_predgtype3f_toroidal:
+            pgp->t = _cs2_toroidal_param_type(pgp->a, pgp->b, pgp->c);
+            _cs2_calc_eigen_decomposition(pgp, pg, pgt);
+            break;
+
+        case cs2_predgtype3f_improper:
+            pgp->t = _cs2_improper_param_type();
+            _cs2_improper_eigen_decomposition(pgp, pg);
+            break;
+
+        /* COUNT */
+        case cs2_predgtype3f_COUNT:
+            CS2_PANIC_MSG("invalid type");
+            break;
+    }
+}
+
+/* bulk parametrization */
+#define CS2_PREDG3F_PARAM_N_GRAIN 256
+
+struct _cs2_predg3f_param_n_s
+{
+    struct cs2_predgparam3f_s *pgp;
+    const struct cs2_predg3f_s *pg;
+
+    /* predicate types */
+    unsigned char *pgt;
+
+    /* predicate indices grouped by type */
+    size_t *idx;
+
+    /* current group */
+    enum cs2_predgtype3f_e group;
+    size_t first;
+};
+
+static void _cs2_predg3f_param_n_basic(size_t begin, size_t end, void *d)
+{
+    struct _cs2_predg3f_param_n_s *pd = (struct _cs2_predg3f_param_n_s *)d;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+        pd->pgt[i] = (unsigned char)_cs2_predg3f_param_basic(&pd->pgp[i], &pd->pg[i]);
+}
+
+static void _cs2_predg3f_param_n_group(size_t begin, size_t end, void *d)
+{
+    struct _cs2_predg3f_param_n_s *pd = (struct _cs2_predg3f_param_n_s *)d;
+    const size_t *idx = pd->idx + pd->first;
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+        _cs2_predg3f_param_typed(&pd->pgp[idx[i]], &pd->pg[idx[i]], pd->group);
+}
+
 static void _cs2_predgparam3f_eval_an_empty_set(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
 {
     (void)t12;
@@ -999,169 +1097,1339 @@ static void _cs2_predgparam3f_eval_a_yw_circle(double *t12, double *t23, double
     *t0 = sa;
 }
 
-void cs2_predg3f_set(struct cs2_predg3f_s *g, const struct cs2_vec3f_s *k, const struct cs2_vec3f_s *l, const struct cs2_vec3f_s *a, const struct cs2_vec3f_s *b, double c)
-{
-    cs2_vec3f_copy(&g->k, k);
-    cs2_vec3f_copy(&g->l, l);
-    cs2_vec3f_copy(&g->a, a);
-    cs2_vec3f_copy(&g->b, b);
-    g->c = c;
-}
+/* batch evaluation block size */
+#define CS2_PREDGPARAM3F_EVAL_N_BLOCK 256
 
-void cs2_predg3f_copy(struct cs2_predg3f_s *r, const struct cs2_predg3f_s *g)
+/* clamp small perturbations near zero to a non-negative value (branch-free, no guard) */
+static double _cs2_clamp_0_n(double x)
 {
-    cs2_vec3f_copy(&r->k, &g->k);
-    cs2_vec3f_copy(&r->l, &g->l);
-    cs2_vec3f_copy(&r->a, &g->a);
-    cs2_vec3f_copy(&r->b, &g->b);
-    r->c = g->c;
+    return x < 0.0 ? 0.0 : x;
 }
 
-void cs2_predg3f_from_predh3f(struct cs2_predg3f_s *g, const struct cs2_predh3f_s *h)
+static void _cs2_predgparam3f_eval_n_an_empty_set(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
 {
-    struct cs2_vec3f_s r, nr;
+    (void)t12;
+    (void)t23;
+    (void)t31;
+    (void)t0;
 
-    _cs2_calc_r(&r, &h->p.n);
-    cs2_vec3f_cross(&nr, &h->p.n, &r);
+    (void)pp;
 
-    g->k = nr;
-    cs2_vec3f_cross(&g->l, &h->p.n, &nr);
-    g->a = h->b;
-    cs2_vec3f_neg(&g->b, &h->b);
-    g->c = 2 * h->p.d * cs2_vec3f_sqlen(&nr);
+    (void)u;
+    (void)v;
+
+    (void)domain_component;
+
+    /* no parametrization */
+    if (n)
+        CS2_PANIC_MSG("no parametrization");
 }
 
-void cs2_predg3f_from_preds3f(struct cs2_predg3f_s *g, const struct cs2_preds3f_s *s)
+static void _cs2_predgparam3f_eval_n_a_pair_of_points(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
 {
-    g->k = s->k;
-    g->l = s->l;
-    g->a = s->a;
-    g->b = s->b;
-    g->c = 0;
+    double sgn = 0.0;
+    size_t i;
+
+    (void)pp;
+
+    (void)u;
+    (void)v;
+
+    switch (domain_component)
+    {
+        case 0:
+            sgn = 1.0;
+            break;
+
+        case 1:
+            sgn = -1.0;
+            break;
+
+        default:
+            CS2_PANIC_MSG("invalid component");
+            break;
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        t12[i] = 0.0;
+        t23[i] = 0.0;
+        t31[i] = 0.0;
+        t0[i] = sgn;
+    }
 }
 
-void cs2_predg3f_pquv(struct cs2_vec3f_s *p, struct cs2_vec3f_s *q, struct cs2_vec3f_s *u, struct cs2_vec3f_s *v, const struct cs2_predg3f_s *g)
+/*
+ * r[i] = sin(o + k * x[i]), r[i] = cos(o + k * x[i])
+ *
+ * note: sin and cos are kept in separate loops, otherwise both calls are fused into
+ *       a single sincos call which has no vector variant
+ */
+CS2_SIMD_CLONES
+static void _cs2_sin_n(double *r, const double *x, double o, double k, size_t n)
 {
-    cs2_vec3f_cross(p, &g->k, &g->l);
-    cs2_vec3f_sub(q, &g->a, &g->b);
-    cs2_vec3f_sub(u, &g->k, &g->l);
-    cs2_vec3f_cross(v, &g->a, &g->b);
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        r[i] = sin(o + k * x[i]);
 }
 
-void cs2_predg3f_from_pquvc(struct cs2_predg3f_s *pg, const struct cs2_vec3f_s *p, const struct cs2_vec3f_s *q, const struct cs2_vec3f_s *u, const struct cs2_vec3f_s *v, double c, double alpha, double beta)
+CS2_SIMD_CLONES
+static void _cs2_cos_n(double *r, const double *x, double o, double k, size_t n)
 {
-    struct cs2_vec3f_s pxu, vxq;
-    double usl = cs2_vec3f_sqlen(u);
-    double qsl = cs2_vec3f_sqlen(q);
+    size_t i;
 
-    CS2_ASSERT_MSG(!_cs2_almost_zero(usl) && !_cs2_almost_zero(qsl), "improper pred");
+    for (i = 0; i < n; ++i)
+        r[i] = cos(o + k * x[i]);
+}
 
-    cs2_vec3f_cross(&pxu, p, u);
-    cs2_vec3f_cross(&vxq, v, q);
+CS2_SIMD_CLONES
+static void _cs2_scale_n(double *r, double k, size_t n)
+{
+    size_t i;
 
-    cs2_vec3f_mad2(&pg->l, u, alpha, &pxu, 1.0 / usl);
-    cs2_vec3f_add(&pg->k, &pg->l, u);
-    cs2_vec3f_mad2(&pg->b, q, beta, &vxq, 1.0 / qsl);
-    cs2_vec3f_add(&pg->a, &pg->b, q);
-    pg->c = c;
+    for (i = 0; i < n; ++i)
+        r[i] *= k;
 }
 
-void cs2_predg3f_from_spinquad3f(struct cs2_predg3f_s *pg, const struct cs2_spinquad3f_s *sq, int sign, double alpha, double beta, double mu, double nu)
+CS2_SIMD_CLONES
+static void _cs2_predgparam3f_eval_n_ellipsoids(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, size_t n, double sgn)
 {
-    double p1 = sq->a11 - sq->a22 + sq->a33 - sq->a44;
-    double p2 = 2.0 * (sq->a12 + sq->a34);
-    double p3 = 2.0 * (sq->a13 + sq->a24);
-    double p4 = 2.0 * (sq->a14 + sq->a23);
-    double m1 = sq->a11 - sq->a22 - sq->a33 + sq->a44;
-    double m2 = 2.0 * (sq->a12 - sq->a34);
-    double m3 = 2.0 * (sq->a13 - sq->a24);
-    double m4 = 2.0 * (sq->a14 - sq->a23);
-    double t = sq->a11 + sq->a22 - sq->a33 - sq->a44;
-    double c = 0.25 * (sq->a11 + sq->a22 + sq->a33 + sq->a44);
-    struct cs2_vec3f_s g = { m2, p3, m1 };
-    struct cs2_vec3f_s h = { p1, m4, -p2 };
-    struct cs2_vec3f_s j = { p4, -t, m3 };
-    struct cs2_vec3f_s p, q, u, v;
-    struct cs2_mat33f_s m = { -h.x, -h.y, -h.z,
-                              j.x, j.y, j.z,
-                              g.x, g.y, g.z };
-    struct cs2_vec3f_s gxh, hxj, jxg, gwph, ngxh, ngwph, ngwphxngxh;
-    double gxhgxh, hxjhxj, jxgjxg, gg, hh, jj, gh, jg;
-    double g1, g2, gs, w, cond;
+    double r = 0.5 * (pp->a + pp->b + pp->c);
+    double k12 = sqrt(r / (pp->a + pp->b));
+    double k23 = sqrt(r / pp->a);
+    double k31 = sqrt(r / pp->b);
+    double sa, ca, sb, cb, x, y, z;
+    size_t i;
+
+    /* in: t12 = cos(a), t23 = sin(a), t31 = cos(b), t0 = sin(b) */
+    for (i = 0; i < n; ++i)
+    {
+        ca = t12[i];
+        sa = t23[i];
+        cb = t31[i];
+        sb = t0[i];
+
+        x = k12 * sb * ca;
+        y = k23 * sb * sa;
+        z = k31 * cb;
+
+        t12[i] = x;
+        t23[i] = y;
+        t31[i] = z;
+        t0[i] = sgn * sqrt(_cs2_clamp_0_n(1.0 - x * x - y * y - z * z));
+    }
+}
 
-    const double COND_EPS = 10e-5;
+static void _cs2_predgparam3f_eval_n_a_pair_of_separate_ellipsoids(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    double sgn = 0.0, vo = 0.0, vs = 0.0;
 
-    cs2_vec3f_cross(&gxh, &g, &h);
-    cs2_vec3f_cross(&hxj, &h, &j);
-    cs2_vec3f_cross(&jxg, &j, &g);
+    /* v' = vo + vs * v */
+    switch (domain_component)
+    {
+        case 0:
+            sgn = 1.0;
+            vo = 0.0;
+            vs = 1.0;
+            break;
 
-    gg = cs2_vec3f_sqlen(&g);
-    hh = cs2_vec3f_sqlen(&h);
-    jj = cs2_vec3f_sqlen(&j);
+        case 1:
+            sgn = -1.0;
+            vo = 1.0;
+            vs = -1.0;
+            break;
 
-    gxhgxh = cs2_vec3f_sqlen(&gxh);
-    hxjhxj = cs2_vec3f_sqlen(&hxj);
-    jxgjxg = cs2_vec3f_sqlen(&jxg);
+        default:
+            CS2_PANIC_MSG("invalid component");
+            break;
+    }
 
-    gh = cs2_vec3f_dot(&g, &h);
-    jg = cs2_vec3f_dot(&j, &g);
+    _cs2_cos_n(t12, u, 0.0, 2.0 * CS2_PI, n);
+    _cs2_sin_n(t23, u, 0.0, 2.0 * CS2_PI, n);
+    _cs2_cos_n(t31, v, vo * CS2_PI, vs * CS2_PI, n);
+    _cs2_sin_n(t0, v, vo * CS2_PI, vs * CS2_PI, n);
 
-    cond = cs2_vec3f_dot(&gxh, &j);
+    _cs2_predgparam3f_eval_n_ellipsoids(t12, t23, t31, t0, pp, n, sgn);
+}
 
-    CS2_ASSERT(fabs(cond) < COND_EPS);
+/*
+ * y-barrel and z-barrel share the same kernel
+ *
+ * 'is_z' swaps the height coordinate with the one scaled by 'ks':
+ *    y-barrel: (x, y, z) = (kx cos(2 pi u), h, ks sin(2 pi u))
+ *    z-barrel: (x, y, z) = (kx cos(2 pi u), ks sin(2 pi u), h)
+ */
+CS2_SIMD_CLONES
+static void _cs2_predgparam3f_eval_n_barrel(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *v, size_t n, double kx, double ks, int is_z)
+{
+    double r2 = pp->a + pp->b + pp->c;
+    double ab2 = 2.0 * (pp->a + pp->b);
+    double a2 = 2.0 * pp->a;
+    double b2 = 2.0 * pp->b;
+    double h, sa, ca, sgn, x, y, z, s, d;
+    size_t i;
+
+    /* in: t12 = cos(a), t23 = sin(a) */
+    for (i = 0; i < n; ++i)
+    {
+        ca = t12[i];
+        sa = t23[i];
 
-    gs = (gg + hh + jj) * (gg + hh + jj) - 4.0 * (gxhgxh + hxjhxj + jxgjxg);
-    CS2_ASSERT(gs >= 0.0);
+        /* v >= 0.5: upper half, v < 0.5: lower half */
+        sgn = v[i] >= 0.5 ? 1.0 : -1.0;
+        h = 2.0 * fabs(2.0 * v[i] - 1.0) - 1.0;
 
-    g1 = -gh * gxhgxh + jg * cs2_vec3f_dot(&jxg, &gxh);
-    CS2_ASSERT(fabs(g1) > 0.0);
+        x = kx * ca;
+        s = ks * sa;
+        h = h * sqrt(_cs2_clamp_0_n(1.0 - x * x - s * s));
 
-    g2 = gg * (gxhgxh + hxjhxj) - hh * (gxhgxh + jxgjxg);
+        y = is_z ? s : h;
+        z = is_z ? h : s;
 
-    w = (-g2 + sign * gxhgxh * sqrt(gs)) / (2.0 * g1);
+        d = sqrt(_cs2_clamp_0_n(r2 / (ab2 * x * x + a2 * y * y + b2 * z * z)));
 
-    cs2_vec3f_mad2(&gwph, &g, w, &h, 1.0);
+        x *= d;
+        y *= d;
+        z *= d;
 
-    CS2_ASSERT(cs2_vec3f_sqlen(&gxh) > 0.0);
-    CS2_ASSERT(cs2_vec3f_sqlen(&gwph) > 0.0);
+        t12[i] = x;
+        t23[i] = y;
+        t31[i] = z;
+        t0[i] = sgn * sqrt(_cs2_clamp_0_n(1.0 - x * x - y * y - z * z));
+    }
+}
 
-    cs2_vec3f_unit(&ngxh, &gxh);
-    cs2_vec3f_unit(&ngwph, &gwph);
+static void _cs2_predgparam3f_eval_n_a_pair_of_y_touching_ellipsoids(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    /* same as 'a pair of separate ellipsoids'
+     * includes a domain hole
+     */
+    _cs2_predgparam3f_eval_n_a_pair_of_separate_ellipsoids(t12, t23, t31, t0, pp, u, v, n, domain_component);
+}
 
-    cs2_vec3f_cross(&ngwphxngxh, &ngwph, &ngxh);
+static void _cs2_predgparam3f_eval_n_a_pair_of_yz_crossed_ellipsoids(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    /* same as 'a pair of separate ellipsoids'
+     * includes a domain hole
+     */
+    _cs2_predgparam3f_eval_n_a_pair_of_separate_ellipsoids(t12, t23, t31, t0, pp, u, v, n, domain_component);
+}
 
-    cs2_vec3f_mul(&p, &ngwph, 1.0 / (2.0 * mu));
-    cs2_vec3f_mul(&u, &ngwphxngxh, 1.0 / (2.0 * nu));
+static void _cs2_predgparam3f_eval_n_a_pair_of_z_touching_ellipsoids(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    /* same as 'a pair of separate ellipsoids'
+     * includes a domain hole
+     */
+    _cs2_predgparam3f_eval_n_a_pair_of_separate_ellipsoids(t12, t23, t31, t0, pp, u, v, n, domain_component);
+}
 
-    cs2_mat33f_transform(&q, &m, &ngwph);
-    cs2_vec3f_mul(&q, &q, mu / 2.0);
+static void _cs2_predgparam3f_eval_n_a_y_barrel(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    double kx = sqrt((pp->b - pp->a + pp->c) / (2.0 * pp->b));
+    double kz = sqrt((pp->b - pp->a + pp->c) / (2.0 * (pp->b - pp->a)));
 
-    cs2_mat33f_transform(&v, &m, &ngwphxngxh);
-    cs2_vec3f_mul(&v, &v, nu / 2.0);
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
 
-    _cs2_debug_verify_inverse_pquvc(sq, &p, &q, &u, &v, c);
+    _cs2_cos_n(t12, u, 0.0, 2.0 * CS2_PI, n);
+    _cs2_sin_n(t23, u, 0.0, 2.0 * CS2_PI, n);
 
-    cs2_predg3f_from_pquvc(pg, &p, &q, &u, &v, c, alpha, beta);
+    _cs2_predgparam3f_eval_n_barrel(t12, t23, t31, t0, pp, v, n, kx, kz, 0);
 }
 
-const char *cs2_predgtype3f_str(enum cs2_predgtype3f_e pgt)
+static void _cs2_predgparam3f_eval_n_a_z_barrel(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
 {
-    switch (pgt)
-    {
-    case cs2_predgtype3f_improper: return "improper";
-    case cs2_predgtype3f_ellipsoidal: return "ellipsoidal";
-    case cs2_predgtype3f_toroidal: return "toroidal";
+    double kx = sqrt((pp->a - pp->b + pp->c) / (2.0 * pp->a));
+    double ky = sqrt((pp->a - pp->b + pp->c) / (2.0 * (pp->a - pp->b)));
 
-    /* COUNT */
-    case cs2_predgtype3f_COUNT: return 0;
-    }
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
 
-    return 0;
+    _cs2_cos_n(t12, u, 0.0, 2.0 * CS2_PI, n);
+    _cs2_sin_n(t23, u, 0.0, 2.0 * CS2_PI, n);
+
+    _cs2_predgparam3f_eval_n_barrel(t12, t23, t31, t0, pp, v, n, kx, ky, 1);
 }
 
-enum cs2_predgtype3f_e cs2_predg3f_type(const struct cs2_predg3f_s *pg)
+static void _cs2_predgparam3f_eval_n_a_notched_y_barrel(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
 {
-    struct cs2_vec3f_s p, q, u, v;
+    /* same as 'a y-barrel'
+     * includes a domain hole
+     */
+    _cs2_predgparam3f_eval_n_a_y_barrel(t12, t23, t31, t0, pp, u, v, n, domain_component);
+}
+
+static void _cs2_predgparam3f_eval_n_a_notched_z_barrel(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    /* same as 'a z-barrel'
+     * includes a domain hole
+     */
+    _cs2_predgparam3f_eval_n_a_z_barrel(t12, t23, t31, t0, pp, u, v, n, domain_component);
+}
+
+CS2_SIMD_CLONES
+static void _cs2_predgparam3f_eval_n_yz_caps(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *v, size_t n, double side, double vo, double vs)
+{
+    double ky = sqrt((pp->a + pp->b - pp->c) / (2.0 * pp->b));
+    double kz = sqrt((pp->a + pp->b - pp->c) / (2.0 * pp->a));
+    double r2 = pp->a + pp->b + pp->c;
+    double ab2 = 2.0 * (pp->a + pp->b);
+    double a2 = 2.0 * pp->a;
+    double b2 = 2.0 * pp->b;
+    double w, sa, ca, sgn, x, y, z, d;
+    size_t i;
+
+    /* in: t12 = cos(a), t23 = sin(a) */
+    for (i = 0; i < n; ++i)
+    {
+        ca = t12[i];
+        sa = t23[i];
+
+        w = vo + vs * v[i];
+
+        /* w >= 0.5: upper half, w < 0.5: lower half */
+        sgn = w >= 0.5 ? 1.0 : -1.0;
+        w = fabs(2.0 * w - 1.0);
+
+        y = ky * ca;
+        z = kz * sa;
+        x = side * sqrt(_cs2_clamp_0_n(1.0 - y * y - z * z));
+
+        x = x * (1.0 - w) + side * w;
+        y = y * (1.0 - w);
+        z = z * (1.0 - w);
+
+        d = sqrt(_cs2_clamp_0_n(r2 / (ab2 * x * x + a2 * y * y + b2 * z * z)));
+
+        x *= d;
+        y *= d;
+        z *= d;
+
+        t12[i] = x;
+        t23[i] = y;
+        t31[i] = z;
+        t0[i] = sgn * sqrt(_cs2_clamp_0_n(1.0 - x * x - y * y - z * z));
+    }
+}
+
+static void _cs2_predgparam3f_eval_n_a_pair_of_separate_yz_caps(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    double side = 0.0, vo = 0.0, vs = 0.0;
+
+    /* v' = vo + vs * v */
+    switch (domain_component)
+    {
+        case 0:
+            side = 1.0;
+            vo = 0.0;
+            vs = 1.0;
+            break;
+
+        case 1:
+            side = -1.0;
+            vo = 1.0;
+            vs = -1.0;
+            break;
+
+        default:
+            CS2_PANIC_MSG("invalid component");
+            break;
+    }
+
+    _cs2_cos_n(t12, u, 0.0, 2.0 * CS2_PI, n);
+    _cs2_sin_n(t23, u, 0.0, 2.0 * CS2_PI, n);
+
+    _cs2_predgparam3f_eval_n_yz_caps(t12, t23, t31, t0, pp, v, n, side, vo, vs);
+}
+
+/*
+ * toroidal cases share the same kernel
+ *
+ *    t = kc * (cos(2 pi u) * e_ic + sin(2 pi u) * e_is) + kd * (cos(2 pi v) * e_id + sin(2 pi v) * e_ie)
+ *
+ * where e_ic, e_is, e_id, e_ie is a permutation of the unit basis
+ */
+static void _cs2_predgparam3f_eval_n_toroidal(double *t12, double *t23, double *t31, double *t0, const double *u, const double *v, size_t n, double kc, double kd, int ic, int is, int id, int ie)
+{
+    double *t[4] = { t12, t23, t31, t0 };
+
+    _cs2_cos_n(t[ic], u, 0.0, 2.0 * CS2_PI, n);
+    _cs2_sin_n(t[is], u, 0.0, 2.0 * CS2_PI, n);
+    _cs2_cos_n(t[id], v, 0.0, 2.0 * CS2_PI, n);
+    _cs2_sin_n(t[ie], v, 0.0, 2.0 * CS2_PI, n);
+
+    _cs2_scale_n(t[ic], kc, n);
+    _cs2_scale_n(t[is], kc, n);
+    _cs2_scale_n(t[id], kd, n);
+    _cs2_scale_n(t[ie], kd, n);
+}
+
+static void _cs2_predgparam3f_eval_n_a_xy_zw_torus(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    double rp = sqrt((pp->a + pp->c) / (2.0 * pp->a));
+    double rm = sqrt((pp->a - pp->c) / (2.0 * pp->a));
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_n_toroidal(t12, t23, t31, t0, u, v, n, rp, rm, 0, 1, 2, 3);
+}
+
+static void _cs2_predgparam3f_eval_n_a_xy_circle(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    /* second circle collapses to a point */
+    _cs2_predgparam3f_eval_n_toroidal(t12, t23, t31, t0, u, v, n, 1.0, 0.0, 0, 1, 2, 3);
+}
+
+static void _cs2_predgparam3f_eval_n_a_zw_circle(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    /* second circle collapses to a point */
+    _cs2_predgparam3f_eval_n_toroidal(t12, t23, t31, t0, u, v, n, 1.0, 0.0, 2, 3, 0, 1);
+}
+
+static void _cs2_predgparam3f_eval_n_a_xz_yw_torus(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    double rp = sqrt((pp->b + pp->c) / (2.0 * pp->b));
+    double rm = sqrt((pp->b - pp->c) / (2.0 * pp->b));
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_n_toroidal(t12, t23, t31, t0, u, v, n, rp, rm, 0, 2, 1, 3);
+}
+
+static void _cs2_predgparam3f_eval_n_a_xz_circle(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    /* second circle collapses to a point */
+    _cs2_predgparam3f_eval_n_toroidal(t12, t23, t31, t0, u, v, n, 1.0, 0.0, 0, 2, 1, 3);
+}
+
+static void _cs2_predgparam3f_eval_n_a_yw_circle(double *t12, double *t23, double *t31, double *t0, const struct cs2_predgparam3f_s *pp, const double *u, const double *v, size_t n, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    /* second circle collapses to a point */
+    _cs2_predgparam3f_eval_n_toroidal(t12, t23, t31, t0, u, v, n, 1.0, 0.0, 1, 3, 0, 2);
+}
+
+CS2_SIMD_CLONES
+static void _cs2_predgparam3f_rotate_n(double *s12, double *s23, double *s31, double *s0, const struct cs2_predgparam3f_s *pp, size_t n)
+{
+    const double m11 = pp->ev[0].x, m12 = pp->ev[1].x, m13 = pp->ev[2].x, m14 = pp->ev[3].x;
+    const double m21 = pp->ev[0].y, m22 = pp->ev[1].y, m23 = pp->ev[2].y, m24 = pp->ev[3].y;
+    const double m31 = pp->ev[0].z, m32 = pp->ev[1].z, m33 = pp->ev[2].z, m34 = pp->ev[3].z;
+    const double m41 = pp->ev[0].w, m42 = pp->ev[1].w, m43 = pp->ev[2].w, m44 = pp->ev[3].w;
+    double t12, t23, t31, t0;
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+    {
+        t12 = s12[i];
+        t23 = s23[i];
+        t31 = s31[i];
+        t0 = s0[i];
+
+        s12[i] = m11 * t12 + m12 * t23 + m13 * t31 + m14 * t0;
+        s23[i] = m21 * t12 + m22 * t23 + m23 * t31 + m24 * t0;
+        s31[i] = m31 * t12 + m32 * t23 + m33 * t31 + m34 * t0;
+        s0[i] = m41 * t12 + m42 * t23 + m43 * t31 + m44 * t0;
+    }
+}
+
+static void _cs2_predgplan3f_rotate(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double t12, double t23, double t31, double t0)
+{
+    s->s12 = t12 * pl->m[0][0] + t23 * pl->m[1][0] + t31 * pl->m[2][0] + t0 * pl->m[3][0];
+    s->s23 = t12 * pl->m[0][1] + t23 * pl->m[1][1] + t31 * pl->m[2][1] + t0 * pl->m[3][1];
+    s->s31 = t12 * pl->m[0][2] + t23 * pl->m[1][2] + t31 * pl->m[2][2] + t0 * pl->m[3][2];
+    s->s0 = t12 * pl->m[0][3] + t23 * pl->m[1][3] + t31 * pl->m[2][3] + t0 * pl->m[3][3];
+
+    /* debug */
+    if (CS2_VERIFY_SAMPLE())
+        _cs2_debug_verify_spinor(s);
+}
+
+static void _cs2_predgplan3f_eval_an_empty_set(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    (void)s;
+    (void)pl;
+
+    (void)u;
+    (void)v;
+
+    /* no parametrization */
+    CS2_PANIC_MSG("no parametrization");
+}
+
+/* k: spinor */
+static void _cs2_predgplan3f_eval_a_pair_of_points(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    (void)u;
+    (void)v;
+
+    cs2_spin3f_set(s, pl->k[0], pl->k[1], pl->k[2], pl->k[3]);
+}
+
+/* k: k12, k23, k31, sgn, vo * pi, vs * pi */
+static void _cs2_predgplan3f_eval_ellipsoids(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    double sa, ca, sb, cb, x, y, z;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+    cs2_sincosf(&sb, &cb, pl->k[4] + pl->k[5] * v);
+
+    x = pl->k[0] * sb * ca;
+    y = pl->k[1] * sb * sa;
+    z = pl->k[2] * cb;
+
+    _cs2_predgplan3f_rotate(s, pl, x, y, z, pl->k[3] * sqrt(_cs2_clamp_0(1.0 - x * x - y * y - z * z)));
+}
+
+/* k: kx, ky, a + b + c, 2 (a + b), 2 a, 2 b */
+static void _cs2_predgplan3f_eval_z_barrel(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    double sa, ca, sgn, x, y, z, d;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+
+    sgn = v >= 0.5 ? 1.0 : -1.0;
+
+    x = pl->k[0] * ca;
+    y = pl->k[1] * sa;
+    z = (2.0 * fabs(2.0 * v - 1.0) - 1.0) * sqrt(_cs2_clamp_0(1.0 - x * x - y * y));
+    d = sqrt(_cs2_clamp_0(pl->k[2] / (pl->k[3] * x * x + pl->k[4] * y * y + pl->k[5] * z * z)));
+
+    x *= d;
+    y *= d;
+    z *= d;
+
+    _cs2_predgplan3f_rotate(s, pl, x, y, z, sgn * sqrt(_cs2_clamp_0(1.0 - x * x - y * y - z * z)));
+}
+
+/* k: kx, kz, a + b + c, 2 (a + b), 2 a, 2 b */
+static void _cs2_predgplan3f_eval_y_barrel(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    double sa, ca, sgn, x, y, z, d;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+
+    sgn = v >= 0.5 ? 1.0 : -1.0;
+
+    x = pl->k[0] * ca;
+    z = pl->k[1] * sa;
+    y = (2.0 * fabs(2.0 * v - 1.0) - 1.0) * sqrt(_cs2_clamp_0(1.0 - x * x - z * z));
+    d = sqrt(_cs2_clamp_0(pl->k[2] / (pl->k[3] * x * x + pl->k[4] * y * y + pl->k[5] * z * z)));
+
+    x *= d;
+    y *= d;
+    z *= d;
+
+    _cs2_predgplan3f_rotate(s, pl, x, y, z, sgn * sqrt(_cs2_clamp_0(1.0 - x * x - y * y - z * z)));
+}
+
+/* k: ky, kz, a + b + c, 2 (a + b), 2 a, 2 b, side, vo */
+static void _cs2_predgplan3f_eval_yz_caps(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    double sa, ca, sgn, w, x, y, z, d;
+    double side = pl->k[6];
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+
+    /* component 1 is mirrored: w = 1 - v */
+    w = pl->k[7] + side * v;
+    sgn = w >= 0.5 ? 1.0 : -1.0;
+    w = fabs(2.0 * w - 1.0);
+
+    y = pl->k[0] * ca;
+    z = pl->k[1] * sa;
+    x = side * sqrt(_cs2_clamp_0(1.0 - y * y - z * z));
+
+    x = x * (1.0 - w) + side * w;
+    y = y * (1.0 - w);
+    z = z * (1.0 - w);
+
+    d = sqrt(_cs2_clamp_0(pl->k[2] / (pl->k[3] * x * x + pl->k[4] * y * y + pl->k[5] * z * z)));
+
+    x *= d;
+    y *= d;
+    z *= d;
+
+    _cs2_predgplan3f_rotate(s, pl, x, y, z, sgn * sqrt(_cs2_clamp_0(1.0 - x * x - y * y - z * z)));
+}
+
+/* toroidal cases: radii and the basis permutation are folded into the eigenmatrix */
+static void _cs2_predgplan3f_eval_torus(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    double sa, ca, sb, cb;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+    cs2_sincosf(&sb, &cb, v * 2.0 * CS2_PI);
+
+    _cs2_predgplan3f_rotate(s, pl, ca, sa, cb, sb);
+}
+
+static void _cs2_predgplan3f_eval_circle(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    double sa, ca;
+
+    (void)v;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+
+    _cs2_predgplan3f_rotate(s, pl, ca, sa, 0.0, 0.0);
+}
+
+static void _cs2_predgplan3f_set_columns(struct cs2_predgplan3f_s *pl, const struct cs2_predgparam3f_s *pp, double kc, double kd, int ic, int is, int id, int ie)
+{
+    const int col[4] = { ic, is, id, ie };
+    const double k[4] = { kc, kc, kd, kd };
+    int i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        pl->m[i][0] = k[i] * pp->ev[col[i]].x;
+        pl->m[i][1] = k[i] * pp->ev[col[i]].y;
+        pl->m[i][2] = k[i] * pp->ev[col[i]].z;
+        pl->m[i][3] = k[i] * pp->ev[col[i]].w;
+    }
+}
+
+static void _cs2_predgplan3f_set_ellipsoidal_invariants(struct cs2_predgplan3f_s *pl, const struct cs2_predgparam3f_s *pp)
+{
+    pl->k[2] = pp->a + pp->b + pp->c;
+    pl->k[3] = 2.0 * (pp->a + pp->b);
+    pl->k[4] = 2.0 * pp->a;
+    pl->k[5] = 2.0 * pp->b;
+}
+
+/*
+ * derivatives: t, t_u, t_v are 4-vectors (t12, t23, t31, t0) in the eigenbasis;
+ * at singular points of a parametrization (w = 0) the affected derivative is set to zero
+ */
+static double _cs2_safe_div(double x, double y)
+{
+    return _cs2_almost_zero(y) ? 0.0 : x / y;
+}
+
+/* w = sgn * sqrt(1 - |x|^2) and its derivatives */
+static void _cs2_predgparam3f_eval_d_w(double *t, double *tu, double *tv, double sgn)
+{
+    t[3] = sgn * sqrt(_cs2_clamp_0(1.0 - t[0] * t[0] - t[1] * t[1] - t[2] * t[2]));
+    tu[3] = _cs2_safe_div(-(t[0] * tu[0] + t[1] * tu[1] + t[2] * tu[2]), t[3]);
+    tv[3] = _cs2_safe_div(-(t[0] * tv[0] + t[1] * tv[1] + t[2] * tv[2]), t[3]);
+}
+
+/* (x, y, z) -> d (x, y, z), d = sqrt((a + b + c) / (2 ((a + b) x^2 + a y^2 + b z^2))), followed by w */
+static void _cs2_predgparam3f_eval_d_project(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double sgn)
+{
+    const double k[3] = { 2.0 * (pp->a + pp->b), 2.0 * pp->a, 2.0 * pp->b };
+    double q = 0.0, qu = 0.0, qv = 0.0, d, du, dv;
+    int i;
+
+    for (i = 0; i < 3; ++i)
+    {
+        q += k[i] * t[i] * t[i];
+        qu += 2.0 * k[i] * t[i] * tu[i];
+        qv += 2.0 * k[i] * t[i] * tv[i];
+    }
+
+    d = sqrt(_cs2_clamp_0((pp->a + pp->b + pp->c) / q));
+    du = -0.5 * d * qu / q;
+    dv = -0.5 * d * qv / q;
+
+    for (i = 0; i < 3; ++i)
+    {
+        tu[i] = tu[i] * d + t[i] * du;
+        tv[i] = tv[i] * d + t[i] * dv;
+        t[i] *= d;
+    }
+
+    _cs2_predgparam3f_eval_d_w(t, tu, tv, sgn);
+}
+
+static void _cs2_predgparam3f_eval_d_an_empty_set(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    (void)t;
+    (void)tu;
+    (void)tv;
+
+    (void)pp;
+
+    (void)u;
+    (void)v;
+
+    (void)domain_component;
+
+    /* no parametrization */
+    CS2_PANIC_MSG("no parametrization");
+}
+
+static void _cs2_predgparam3f_eval_d_a_pair_of_points(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    /* constant */
+    _cs2_predgparam3f_eval_a_pair_of_points(&t[0], &t[1], &t[2], &t[3], pp, u, v, domain_component);
+
+    tu[0] = tu[1] = tu[2] = tu[3] = 0.0;
+    tv[0] = tv[1] = tv[2] = tv[3] = 0.0;
+}
+
+static void _cs2_predgparam3f_eval_d_a_pair_of_separate_ellipsoids(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    double sgn = 0.0, vs = 0.0;
+    double r = 0.5 * (pp->a + pp->b + pp->c);
+    double k12 = sqrt(r / (pp->a + pp->b));
+    double k23 = sqrt(r / pp->a);
+    double k31 = sqrt(r / pp->b);
+    double sa, ca, sb, cb, au, bv;
+
+    switch (domain_component)
+    {
+        case 0:
+            sgn = 1.0;
+            vs = 1.0;
+            break;
+
+        case 1:
+            sgn = -1.0;
+            vs = -1.0;
+            v = 1 - v;
+            break;
+
+        default:
+            CS2_PANIC_MSG("invalid component");
+            break;
+    }
+
+    /* a = 2 pi u, b = pi v */
+    au = 2.0 * CS2_PI;
+    bv = vs * CS2_PI;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+    cs2_sincosf(&sb, &cb, v * CS2_PI);
+
+    t[0] = k12 * sb * ca;
+    t[1] = k23 * sb * sa;
+    t[2] = k31 * cb;
+
+    tu[0] = -k12 * sb * sa * au;
+    tu[1] = k23 * sb * ca * au;
+    tu[2] = 0.0;
+
+    tv[0] = k12 * cb * ca * bv;
+    tv[1] = k23 * cb * sa * bv;
+    tv[2] = -k31 * sb * bv;
+
+    _cs2_predgparam3f_eval_d_w(t, tu, tv, sgn);
+}
+
+static void _cs2_predgparam3f_eval_d_a_pair_of_y_touching_ellipsoids(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    /* same as 'a pair of separate ellipsoids' */
+    _cs2_predgparam3f_eval_d_a_pair_of_separate_ellipsoids(t, tu, tv, pp, u, v, domain_component);
+}
+
+static void _cs2_predgparam3f_eval_d_a_pair_of_yz_crossed_ellipsoids(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    /* same as 'a pair of separate ellipsoids' */
+    _cs2_predgparam3f_eval_d_a_pair_of_separate_ellipsoids(t, tu, tv, pp, u, v, domain_component);
+}
+
+static void _cs2_predgparam3f_eval_d_a_pair_of_z_touching_ellipsoids(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    /* same as 'a pair of separate ellipsoids' */
+    _cs2_predgparam3f_eval_d_a_pair_of_separate_ellipsoids(t, tu, tv, pp, u, v, domain_component);
+}
+
+/*
+ * barrels: (x, s) = (kx cos(2 pi u), ks sin(2 pi u)), h = 2 |2v - 1| - 1,
+ * the height coordinate (y or z, index 'ih') is h sqrt(1 - x^2 - s^2), 's' is at index 'is'
+ */
+static void _cs2_predgparam3f_eval_d_barrel(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, double kx, double ks, int ih, int is)
+{
+    double sa, ca, sgn, h, hv, r, ru, au = 2.0 * CS2_PI;
+
+    sgn = v >= 0.5 ? 1.0 : -1.0;
+    h = 2.0 * fabs(2.0 * v - 1.0) - 1.0;
+    hv = 4.0 * sgn;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+
+    t[0] = kx * ca;
+    t[is] = ks * sa;
+
+    tu[0] = -kx * sa * au;
+    tu[is] = ks * ca * au;
+
+    tv[0] = 0.0;
+    tv[is] = 0.0;
+
+    r = sqrt(_cs2_clamp_0(1.0 - t[0] * t[0] - t[is] * t[is]));
+    ru = _cs2_safe_div(-(t[0] * tu[0] + t[is] * tu[is]), r);
+
+    t[ih] = h * r;
+    tu[ih] = h * ru;
+    tv[ih] = hv * r;
+
+    _cs2_predgparam3f_eval_d_project(t, tu, tv, pp, sgn);
+}
+
+static void _cs2_predgparam3f_eval_d_a_y_barrel(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_barrel(t, tu, tv, pp, u, v,
+                                    sqrt((pp->b - pp->a + pp->c) / (2.0 * pp->b)),
+                                    sqrt((pp->b - pp->a + pp->c) / (2.0 * (pp->b - pp->a))),
+                                    1, 2);
+}
+
+static void _cs2_predgparam3f_eval_d_a_z_barrel(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_barrel(t, tu, tv, pp, u, v,
+                                    sqrt((pp->a - pp->b + pp->c) / (2.0 * pp->a)),
+                                    sqrt((pp->a - pp->b + pp->c) / (2.0 * (pp->a - pp->b))),
+                                    2, 1);
+}
+
+static void _cs2_predgparam3f_eval_d_a_notched_y_barrel(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    /* same as 'a y-barrel' */
+    _cs2_predgparam3f_eval_d_a_y_barrel(t, tu, tv, pp, u, v, domain_component);
+}
+
+static void _cs2_predgparam3f_eval_d_a_notched_z_barrel(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    /* same as 'a z-barrel' */
+    _cs2_predgparam3f_eval_d_a_z_barrel(t, tu, tv, pp, u, v, domain_component);
+}
+
+static void _cs2_predgparam3f_eval_d_a_pair_of_separate_yz_caps(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    double ky = sqrt((pp->a + pp->b - pp->c) / (2.0 * pp->b));
+    double kz = sqrt((pp->a + pp->b - pp->c) / (2.0 * pp->a));
+    double sa, ca, sgn, side = 0.0, w, wv, au = 2.0 * CS2_PI;
+    double x0, y0, z0, x0u, y0u, z0u;
+
+    switch (domain_component)
+    {
+        case 0:
+            side = 1.0;
+            break;
+
+        case 1:
+            side = -1.0;
+            v = 1 - v;
+            break;
+
+        default:
+            CS2_PANIC_MSG("invalid component");
+            break;
+    }
+
+    /* w = |2v - 1|, dv/dv' = side */
+    sgn = v >= 0.5 ? 1.0 : -1.0;
+    w = fabs(2.0 * v - 1.0);
+    wv = 2.0 * sgn * side;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+
+    y0 = ky * ca;
+    z0 = kz * sa;
+    x0 = side * sqrt(_cs2_clamp_0(1.0 - y0 * y0 - z0 * z0));
+
+    y0u = -ky * sa * au;
+    z0u = kz * ca * au;
+    x0u = _cs2_safe_div(-(y0 * y0u + z0 * z0u), x0);
+
+    t[0] = x0 * (1.0 - w) + side * w;
+    t[1] = y0 * (1.0 - w);
+    t[2] = z0 * (1.0 - w);
+
+    tu[0] = x0u * (1.0 - w);
+    tu[1] = y0u * (1.0 - w);
+    tu[2] = z0u * (1.0 - w);
+
+    tv[0] = (side - x0) * wv;
+    tv[1] = -y0 * wv;
+    tv[2] = -z0 * wv;
+
+    _cs2_predgparam3f_eval_d_project(t, tu, tv, pp, sgn);
+}
+
+/* toroidal cases: t = kc (cos(2 pi u) e_ic + sin(2 pi u) e_is) + kd (cos(2 pi v) e_id + sin(2 pi v) e_ie) */
+static void _cs2_predgparam3f_eval_d_toroidal(double *t, double *tu, double *tv, double u, double v, double kc, double kd, int ic, int is, int id, int ie)
+{
+    double sa, ca, sb, cb, au = 2.0 * CS2_PI;
+
+    cs2_sincosf(&sa, &ca, u * 2.0 * CS2_PI);
+    cs2_sincosf(&sb, &cb, v * 2.0 * CS2_PI);
+
+    t[ic] = kc * ca;
+    t[is] = kc * sa;
+    t[id] = kd * cb;
+    t[ie] = kd * sb;
+
+    tu[ic] = -kc * sa * au;
+    tu[is] = kc * ca * au;
+    tu[id] = 0.0;
+    tu[ie] = 0.0;
+
+    tv[ic] = 0.0;
+    tv[is] = 0.0;
+    tv[id] = -kd * sb * au;
+    tv[ie] = kd * cb * au;
+}
+
+static void _cs2_predgparam3f_eval_d_a_xy_zw_torus(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_toroidal(t, tu, tv, u, v, sqrt((pp->a + pp->c) / (2.0 * pp->a)), sqrt((pp->a - pp->c) / (2.0 * pp->a)), 0, 1, 2, 3);
+}
+
+static void _cs2_predgparam3f_eval_d_a_xy_circle(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_toroidal(t, tu, tv, u, v, 1.0, 0.0, 0, 1, 2, 3);
+}
+
+static void _cs2_predgparam3f_eval_d_a_zw_circle(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_toroidal(t, tu, tv, u, v, 1.0, 0.0, 2, 3, 0, 1);
+}
+
+static void _cs2_predgparam3f_eval_d_a_xz_yw_torus(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_toroidal(t, tu, tv, u, v, sqrt((pp->b + pp->c) / (2.0 * pp->b)), sqrt((pp->b - pp->c) / (2.0 * pp->b)), 0, 2, 1, 3);
+}
+
+static void _cs2_predgparam3f_eval_d_a_xz_circle(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_toroidal(t, tu, tv, u, v, 1.0, 0.0, 0, 2, 1, 3);
+}
+
+static void _cs2_predgparam3f_eval_d_a_yw_circle(double *t, double *tu, double *tv, const struct cs2_predgparam3f_s *pp, double u, double v, int domain_component)
+{
+    (void)pp;
+
+    CS2_ASSERT_MSG(domain_component == 0, "invalid component");
+
+    _cs2_predgparam3f_eval_d_toroidal(t, tu, tv, u, v, 1.0, 0.0, 1, 3, 0, 2);
+}
+
+static void _cs2_predgparam3f_rotate_d(struct cs2_spin3f_s *s, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    s->s12 = pp->ev[0].x * t[0] + pp->ev[1].x * t[1] + pp->ev[2].x * t[2] + pp->ev[3].x * t[3];
+    s->s23 = pp->ev[0].y * t[0] + pp->ev[1].y * t[1] + pp->ev[2].y * t[2] + pp->ev[3].y * t[3];
+    s->s31 = pp->ev[0].z * t[0] + pp->ev[1].z * t[1] + pp->ev[2].z * t[2] + pp->ev[3].z * t[3];
+    s->s0 = pp->ev[0].w * t[0] + pp->ev[1].w * t[1] + pp->ev[2].w * t[2] + pp->ev[3].w * t[3];
+}
+
+/*
+ * inverse: t = (t12, t23, t31, t0) is the spin in the eigenbasis,
+ * closed form initial guess for (u, v, domain_component)
+ */
+static double _cs2_clamp_1(double x)
+{
+    return x < -1.0 ? -1.0 : (x > 1.0 ? 1.0 : x);
+}
+
+/* u = atan2(y, x) / 2 pi in [0, 1) */
+static double _cs2_inv_angle(double y, double x)
+{
+    double u = atan2(y, x) / (2.0 * CS2_PI);
+
+    return u < 0.0 ? u + 1.0 : u;
+}
+
+static void _cs2_predgparam3f_inv_an_empty_set(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)u;
+    (void)v;
+    (void)domain_component;
+
+    (void)pp;
+    (void)t;
+
+    /* no parametrization */
+    CS2_PANIC_MSG("no parametrization");
+}
+
+static void _cs2_predgparam3f_inv_a_pair_of_points(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)pp;
+
+    *u = 0.0;
+    *v = 0.0;
+    *domain_component = t[3] >= 0.0 ? 0 : 1;
+}
+
+static void _cs2_predgparam3f_inv_a_pair_of_separate_ellipsoids(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    double r = 0.5 * (pp->a + pp->b + pp->c);
+    double k12 = sqrt(r / (pp->a + pp->b));
+    double k23 = sqrt(r / pp->a);
+    double k31 = sqrt(r / pp->b);
+    double b;
+
+    *domain_component = t[3] >= 0.0 ? 0 : 1;
+
+    /* t12 = k12 sin(b) cos(a), t23 = k23 sin(b) sin(a), t31 = k31 cos(b) */
+    *u = _cs2_inv_angle(t[1] / k23, t[0] / k12);
+    b = acos(_cs2_clamp_1(t[2] / k31)) / CS2_PI;
+    *v = *domain_component == 0 ? b : 1.0 - b;
+}
+
+static void _cs2_predgparam3f_inv_a_pair_of_y_touching_ellipsoids(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    /* same as 'a pair of separate ellipsoids' */
+    _cs2_predgparam3f_inv_a_pair_of_separate_ellipsoids(u, v, domain_component, pp, t);
+}
+
+static void _cs2_predgparam3f_inv_a_pair_of_yz_crossed_ellipsoids(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    /* same as 'a pair of separate ellipsoids' */
+    _cs2_predgparam3f_inv_a_pair_of_separate_ellipsoids(u, v, domain_component, pp, t);
+}
+
+static void _cs2_predgparam3f_inv_a_pair_of_z_touching_ellipsoids(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    /* same as 'a pair of separate ellipsoids' */
+    _cs2_predgparam3f_inv_a_pair_of_separate_ellipsoids(u, v, domain_component, pp, t);
+}
+
+/* barrels: (t0, t_is) = d (kx cos(a), ks sin(a)), t_ih = d h sqrt(1 - (kx cos(a))^2 - (ks sin(a))^2) */
+static void _cs2_predgparam3f_inv_barrel(double *u, double *v, int *domain_component, const double *t, double kx, double ks, int ih, int is)
+{
+    double sa, ca, x, s, l, d, r, h, sgn;
+
+    sgn = t[3] >= 0.0 ? 1.0 : -1.0;
+
+    *domain_component = 0;
+    *u = _cs2_inv_angle(t[is] / ks, t[0] / kx);
+
+    cs2_sincosf(&sa, &ca, *u * 2.0 * CS2_PI);
+
+    x = kx * ca;
+    s = ks * sa;
+    l = sqrt(x * x + s * s);
+    d = _cs2_almost_zero(l) ? 0.0 : sqrt(t[0] * t[0] + t[is] * t[is]) / l;
+    r = sqrt(_cs2_clamp_0(1.0 - x * x - s * s));
+    h = _cs2_almost_zero(r * d) ? 0.0 : _cs2_clamp_1(t[ih] / (r * d));
+
+    /* h = 2 |2v - 1| - 1 */
+    *v = 0.5 + 0.25 * sgn * (h + 1.0);
+}
+
+static void _cs2_predgparam3f_inv_a_y_barrel(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    _cs2_predgparam3f_inv_barrel(u, v, domain_component, t,
+                                 sqrt((pp->b - pp->a + pp->c) / (2.0 * pp->b)),
+                                 sqrt((pp->b - pp->a + pp->c) / (2.0 * (pp->b - pp->a))),
+                                 1, 2);
+}
+
+static void _cs2_predgparam3f_inv_a_z_barrel(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    _cs2_predgparam3f_inv_barrel(u, v, domain_component, t,
+                                 sqrt((pp->a - pp->b + pp->c) / (2.0 * pp->a)),
+                                 sqrt((pp->a - pp->b + pp->c) / (2.0 * (pp->a - pp->b))),
+                                 2, 1);
+}
+
+static void _cs2_predgparam3f_inv_a_notched_y_barrel(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    /* same as 'a y-barrel' */
+    _cs2_predgparam3f_inv_a_y_barrel(u, v, domain_component, pp, t);
+}
+
+static void _cs2_predgparam3f_inv_a_notched_z_barrel(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    /* same as 'a z-barrel' */
+    _cs2_predgparam3f_inv_a_z_barrel(u, v, domain_component, pp, t);
+}
+
+static void _cs2_predgparam3f_inv_a_pair_of_separate_yz_caps(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    double ky = sqrt((pp->a + pp->b - pp->c) / (2.0 * pp->b));
+    double kz = sqrt((pp->a + pp->b - pp->c) / (2.0 * pp->a));
+    double sa, ca, x0, y0, z0, l, q, rho, w, sgn, side;
+
+    side = t[0] >= 0.0 ? 1.0 : -1.0;
+    sgn = t[3] >= 0.0 ? 1.0 : -1.0;
+
+    *domain_component = side > 0.0 ? 0 : 1;
+    *u = _cs2_inv_angle(t[2] / kz, t[1] / ky);
+
+    cs2_sincosf(&sa, &ca, *u * 2.0 * CS2_PI);
+
+    y0 = ky * ca;
+    z0 = kz * sa;
+    x0 = side * sqrt(_cs2_clamp_0(1.0 - y0 * y0 - z0 * z0));
+
+    /* (t12, t23, t31) = q (x0, y0, z0) + d w (side, 0, 0), q = (1 - w) d */
+    l = sqrt(y0 * y0 + z0 * z0);
+    q = _cs2_almost_zero(l) ? 0.0 : sqrt(t[1] * t[1] + t[2] * t[2]) / l;
+
+    if (_cs2_almost_zero(q))
+    {
+        w = 1.0;
+    }
+    else
+    {
+        /* w / (1 - w) = side (t12 - q x0) / q */
+        rho = side * (t[0] - q * x0) / q;
+        w = rho <= 0.0 ? 0.0 : rho / (1.0 + rho);
+    }
+
+    /* w = |2v - 1| */
+    w = 0.5 + 0.5 * sgn * w;
+    *v = *domain_component == 0 ? w : 1.0 - w;
+}
+
+static void _cs2_predgparam3f_inv_toroidal(double *u, double *v, int *domain_component, const double *t, int ic, int is, int id, int ie)
+{
+    *domain_component = 0;
+    *u = _cs2_inv_angle(t[is], t[ic]);
+    *v = _cs2_inv_angle(t[ie], t[id]);
+}
+
+static void _cs2_predgparam3f_inv_a_xy_zw_torus(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)pp;
+
+    _cs2_predgparam3f_inv_toroidal(u, v, domain_component, t, 0, 1, 2, 3);
+}
+
+static void _cs2_predgparam3f_inv_a_xy_circle(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)pp;
+
+    _cs2_predgparam3f_inv_toroidal(u, v, domain_component, t, 0, 1, 2, 3);
+    *v = 0.0;
+}
+
+static void _cs2_predgparam3f_inv_a_zw_circle(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)pp;
+
+    _cs2_predgparam3f_inv_toroidal(u, v, domain_component, t, 2, 3, 0, 1);
+    *v = 0.0;
+}
+
+static void _cs2_predgparam3f_inv_a_xz_yw_torus(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)pp;
+
+    _cs2_predgparam3f_inv_toroidal(u, v, domain_component, t, 0, 2, 1, 3);
+}
+
+static void _cs2_predgparam3f_inv_a_xz_circle(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)pp;
+
+    _cs2_predgparam3f_inv_toroidal(u, v, domain_component, t, 0, 2, 1, 3);
+    *v = 0.0;
+}
+
+static void _cs2_predgparam3f_inv_a_yw_circle(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pp, const double *t)
+{
+    (void)pp;
+
+    _cs2_predgparam3f_inv_toroidal(u, v, domain_component, t, 1, 3, 0, 2);
+    *v = 0.0;
+}
+
+void cs2_predg3f_set(struct cs2_predg3f_s *g, const struct cs2_vec3f_s *k, const struct cs2_vec3f_s *l, const struct cs2_vec3f_s *a, const struct cs2_vec3f_s *b, double c)
+{
+    cs2_vec3f_copy(&g->k, k);
+    cs2_vec3f_copy(&g->l, l);
+    cs2_vec3f_copy(&g->a, a);
+    cs2_vec3f_copy(&g->b, b);
+    g->c = c;
+}
+
+void cs2_predg3f_copy(struct cs2_predg3f_s *r, const struct cs2_predg3f_s *g)
+{
+    cs2_vec3f_copy(&r->k, &g->k);
+    cs2_vec3f_copy(&r->l, &g->l);
+    cs2_vec3f_copy(&r->a, &g->a);
+    cs2_vec3f_copy(&r->b, &g->b);
+    r->c = g->c;
+}
+
+void cs2_predg3f_from_predh3f(struct cs2_predg3f_s *g, const struct cs2_predh3f_s *h)
+{
+    struct cs2_vec3f_s r, nr;
+
+    _cs2_calc_r(&r, &h->p.n);
+    cs2_vec3f_cross(&nr, &h->p.n, &r);
+
+    g->k = nr;
+    cs2_vec3f_cross(&g->l, &h->p.n, &nr);
+    g->a = h->b;
+    cs2_vec3f_neg(&g->b, &h->b);
+    g->c = 2 * h->p.d * cs2_vec3f_sqlen(&nr);
+}
+
+void cs2_predg3f_from_preds3f(struct cs2_predg3f_s *g, const struct cs2_preds3f_s *s)
+{
+    g->k = s->k;
+    g->l = s->l;
+    g->a = s->a;
+    g->b = s->b;
+    g->c = 0;
+}
+
+void cs2_predg3f_pquv(struct cs2_vec3f_s *p, struct cs2_vec3f_s *q, struct cs2_vec3f_s *u, struct cs2_vec3f_s *v, const struct cs2_predg3f_s *g)
+{
+    cs2_vec3f_cross(p, &g->k, &g->l);
+    cs2_vec3f_sub(q, &g->a, &g->b);
+    cs2_vec3f_sub(u, &g->k, &g->l);
+    cs2_vec3f_cross(v, &g->a, &g->b);
+}
+
+void cs2_predg3f_from_pquvc(struct cs2_predg3f_s *pg, const struct cs2_vec3f_s *p, const struct cs2_vec3f_s *q, const struct cs2_vec3f_s *u, const struct cs2_vec3f_s *v, double c, double alpha, double beta)
+{
+    struct cs2_vec3f_s pxu, vxq;
+    double usl = cs2_vec3f_sqlen(u);
+    double qsl = cs2_vec3f_sqlen(q);
+
+    CS2_ASSERT_MSG(!_cs2_almost_zero(usl) && !_cs2_almost_zero(qsl), "improper pred");
+
+    cs2_vec3f_cross(&pxu, p, u);
+    cs2_vec3f_cross(&vxq, v, q);
+
+    cs2_vec3f_mad2(&pg->l, u, alpha, &pxu, 1.0 / usl);
+    cs2_vec3f_add(&pg->k, &pg->l, u);
+    cs2_vec3f_mad2(&pg->b, q, beta, &vxq, 1.0 / qsl);
+    cs2_vec3f_add(&pg->a, &pg->b, q);
+    pg->c = c;
+}
+
+void cs2_predg3f_from_spinquad3f(struct cs2_predg3f_s *pg, const struct cs2_spinquad3f_s *sq, int sign, double alpha, double beta, double mu, double nu)
+{
+    double p1 = sq->a11 - sq->a22 + sq->a33 - sq->a44;
+    double p2 = 2.0 * (sq->a12 + sq->a34);
+    double p3 = 2.0 * (sq->a13 + sq->a24);
+    double p4 = 2.0 * (sq->a14 + sq->a23);
+    double m1 = sq->a11 - sq->a22 - sq->a33 + sq->a44;
+    double m2 = 2.0 * (sq->a12 - sq->a34);
+    double m3 = 2.0 * (sq->a13 - sq->a24);
+    double m4 = 2.0 * (sq->a14 - sq->a23);
+    double t = sq->a11 + sq->a22 - sq->a33 - sq->a44;
+    double c = 0.25 * (sq->a11 + sq->a22 + sq->a33 + sq->a44);
+    struct cs2_vec3f_s g = { m2, p3, m1 };
+    struct cs2_vec3f_s h = { p1, m4, -p2 };
+    struct cs2_vec3f_s j = { p4, -t, m3 };
+    struct cs2_vec3f_s p, q, u, v;
+    struct cs2_mat33f_s m = { -h.x, -h.y, -h.z,
+                              j.x, j.y, j.z,
+                              g.x, g.y, g.z };
+    struct cs2_vec3f_s gxh, hxj, jxg, gwph, ngxh, ngwph, ngwphxngxh;
+    double gxhgxh, hxjhxj, jxgjxg, gg, hh, jj, gh, jg;
+    double g1, g2, gs, w, cond;
+
+    const double COND_EPS = 10e-5;
+
+    cs2_vec3f_cross(&gxh, &g, &h);
+    cs2_vec3f_cross(&hxj, &h, &j);
+    cs2_vec3f_cross(&jxg, &j, &g);
+
+    gg = cs2_vec3f_sqlen(&g);
+    hh = cs2_vec3f_sqlen(&h);
+    jj = cs2_vec3f_sqlen(&j);
+
+    gxhgxh = cs2_vec3f_sqlen(&gxh);
+    hxjhxj = cs2_vec3f_sqlen(&hxj);
+    jxgjxg = cs2_vec3f_sqlen(&jxg);
+
+    gh = cs2_vec3f_dot(&g, &h);
+    jg = cs2_vec3f_dot(&j, &g);
+
+    cond = cs2_vec3f_dot(&gxh, &j);
+
+    CS2_ASSERT(fabs(cond) < COND_EPS);
+
+    gs = (gg + hh + jj) * (gg + hh + jj) - 4.0 * (gxhgxh + hxjhxj + jxgjxg);
+    CS2_ASSERT(gs >= 0.0);
+
+    g1 = -gh * gxhgxh + jg * cs2_vec3f_dot(&jxg, &gxh);
+    CS2_ASSERT(fabs(g1) > 0.0);
+
+    g2 = gg * (gxhgxh + hxjhxj) - hh * (gxhgxh + jxgjxg);
+
+    w = (-g2 + sign * gxhgxh * sqrt(gs)) / (2.0 * g1);
+
+    cs2_vec3f_mad2(&gwph, &g, w, &h, 1.0);
+
+    CS2_ASSERT(cs2_vec3f_sqlen(&gxh) > 0.0);
+    CS2_ASSERT(cs2_vec3f_sqlen(&gwph) > 0.0);
+
+    cs2_vec3f_unit(&ngxh, &gxh);
+    cs2_vec3f_unit(&ngwph, &gwph);
+
+    cs2_vec3f_cross(&ngwphxngxh, &ngwph, &ngxh);
+
+    cs2_vec3f_mul(&p, &ngwph, 1.0 / (2.0 * mu));
+    cs2_vec3f_mul(&u, &ngwphxngxh, 1.0 / (2.0 * nu));
+
+    cs2_mat33f_transform(&q, &m, &ngwph);
+    cs2_vec3f_mul(&q, &q, mu / 2.0);
+
+    cs2_mat33f_transform(&v, &m, &ngwphxngxh);
+    cs2_vec3f_mul(&v, &v, nu / 2.0);
+
+    /* debug */
+    if (CS2_VERIFY_SAMPLE())
+        _cs2_debug_verify_inverse_pquvc(sq, &p, &q, &u, &v, c);
+
+    cs2_predg3f_from_pquvc(pg, &p, &q, &u, &v, c, alpha, beta);
+}
+
+const char *cs2_predgtype3f_str(enum cs2_predgtype3f_e pgt)
+{
+    switch (pgt)
+    {
+    case cs2_predgtype3f_improper: return "improper";
+    case cs2_predgtype3f_ellipsoidal: return "ellipsoidal";
+    case cs2_predgtype3f_toroidal: return "toroidal";
+
+    /* COUNT */
+    case cs2_predgtype3f_COUNT: return 0;
+    }
+
+    return 0;
+}
+
+enum cs2_predgtype3f_e cs2_predg3f_type(const struct cs2_predg3f_s *pg)
+{
+    struct cs2_vec3f_s p, q, u, v;
     double a, b;
     int za, zb;
 
@@ -1391,32 +2659,53 @@ int cs2_predgparamtype3f_is_connected(enum cs2_predgparamtype3f_e pgpt)
 
 void cs2_predg3f_param(struct cs2_predgparam3f_s *pgp, const struct cs2_predg3f_s *pg)
 {
-    int za, zb;
+    _cs2_predg3f_param_typed(pgp, pg, _cs2_predg3f_param_basic(pgp, pg));
+}
 
-    /* basic properties */
-    cs2_predg3f_pquv(&pgp->p, &pgp->q, &pgp->u, &pgp->v, pg);
+void cs2_predg3f_param_n(struct cs2_predgparam3f_s *pgp, const struct cs2_predg3f_s *pg, size_t n)
+{
+    struct _cs2_predg3f_param_n_s d;
+    size_t count[cs2_predgtype3f_COUNT], first[cs2_predgtype3f_COUNT];
+    size_t i;
+    int t;
 
-    pgp->a = cs2_vec3f_len(&pgp->p) * cs2_vec3f_len(&pgp->q);
-    pgp->b = cs2_vec3f_len(&pgp->u) * cs2_vec3f_len(&pgp->v);
-    pgp->c = pg->c;
+    if (n == 0)
+        return;
 
-    /* non-zero characteristics */
-    za = _cs2_almost_zero(pgp->a);
-    zb = _cs2_almost_zero(pgp->b);
+    d.pgp = pgp;
+    d.pg = pg;
+    d.pgt = CS2_MEM_MALLOC_N(unsigned char, n);
+    d.idx = CS2_MEM_MALLOC_N(size_t, n);
 
-    /* parametrization type */
-    if (!za && !zb)
-        pgp->t = _cs2_ellipsoidal_param_type(pgp->a, pgp->b, pgp->c);
-    else if (!za || !zb)
-        pgp->t = _cs2_toroidal_param_type(pgp->a, pgp->b, pgp->c);
-    else
-        pgp->t = _cs2_improper_param_type();
+    /* basic properties and predicate types */
+    cs2_thread_parallel_for(n, CS2_PREDG3F_PARAM_N_GRAIN, _cs2_predg3f_param_n_basic, &d);
 
-    /* eigen decomposition */
-    if (!za || !zb)
-        _cs2_calc_eigen_decomposition(pgp, pg);
-    else
-        _cs2_improper_eigen_decomposition(pgp, pg);
+    /* group by predicate type (counting sort keeps the input order within a group) */
+    for (t = 0; t < cs2_predgtype3f_COUNT; ++t)
+        count[t] = 0;
+
+    for (i = 0; i < n; ++i)
+        ++count[d.pgt[i]];
+
+    first[0] = 0;
+
+    for (t = 1; t < cs2_predgtype3f_COUNT; ++t)
+        first[t] = first[t - 1] + count[t - 1];
+
+    for (i = 0; i < n; ++i)
+        d.idx[first[d.pgt[i]]++] = i;
+
+    /* parametrization type and eigen decomposition: one homogeneous pass per group */
+    for (t = 0; t < cs2_predgtype3f_COUNT; ++t)
+    {
+        d.group = (enum cs2_predgtype3f_e)t;
+        d.first = first[t] - count[t];
+
+        cs2_thread_parallel_for(count[t], CS2_PREDG3F_PARAM_N_GRAIN, _cs2_predg3f_param_n_group, &d);
+    }
+
+    CS2_MEM_FREE(d.idx);
+    CS2_MEM_FREE(d.pgt);
 }
 
 void cs2_predgparam3f_eval(struct cs2_spin3f_s *s, const struct cs2_predgparam3f_s *pgp, double u, double v, int domain_component)
@@ -1460,5 +2749,335 @@ void cs2_predgparam3f_eval(struct cs2_spin3f_s *s, const struct cs2_predgparam3f
     s->s0 = pgp->ev[0].w * t12 + pgp->ev[1].w * t23 + pgp->ev[2].w * t31 + pgp->ev[3].w * t0;
 
     /* debug */
-    _cs2_debug_verify_spinor(s);
+    if (CS2_VERIFY_SAMPLE())
+        _cs2_debug_verify_spinor(s);
+}
+
+void cs2_predgparam3f_eval_n(double *s12, double *s23, double *s31, double *s0, const struct cs2_predgparam3f_s *pgp, const double *u, const double *v, size_t n, int domain_component)
+{
+    struct cs2_spin3f_s s;
+    size_t i, m;
+
+    CS2_ASSERT_MSG(pgp->t >= 0 && pgp->t < cs2_predgparamtype3f_COUNT, "invalid param type");
+
+    for (i = 0; i < n; ++i)
+        CS2_ASSERT_MSG(u[i] >= 0.0 && u[i] <= 1.0 && v[i] >= 0.0 && v[i] <= 1.0, "param outside domain");
+
+    static void (* const eval_n_tab[cs2_predgparamtype3f_COUNT])(double *, double *, double *, double *, const struct cs2_predgparam3f_s *, const double *, const double *, size_t, int) = {
+        /* common */
+        _cs2_predgparam3f_eval_n_an_empty_set,
+
+        /* ellipsoidal */
+        _cs2_predgparam3f_eval_n_a_pair_of_points,
+        _cs2_predgparam3f_eval_n_a_pair_of_separate_ellipsoids,
+        _cs2_predgparam3f_eval_n_a_pair_of_y_touching_ellipsoids,
+        _cs2_predgparam3f_eval_n_a_pair_of_yz_crossed_ellipsoids,
+        _cs2_predgparam3f_eval_n_a_pair_of_z_touching_ellipsoids,
+        _cs2_predgparam3f_eval_n_a_y_barrel,
+        _cs2_predgparam3f_eval_n_a_z_barrel,
+        _cs2_predgparam3f_eval_n_a_notched_y_barrel,
+        _cs2_predgparam3f_eval_n_a_notched_z_barrel,
+        _cs2_predgparam3f_eval_n_a_pair_of_separate_yz_caps,
+
+        /* toroidal */
+        _cs2_predgparam3f_eval_n_a_xy_zw_torus,
+        _cs2_predgparam3f_eval_n_a_xy_circle,
+        _cs2_predgparam3f_eval_n_a_zw_circle,
+        _cs2_predgparam3f_eval_n_a_xz_yw_torus,
+        _cs2_predgparam3f_eval_n_a_xz_circle,
+        _cs2_predgparam3f_eval_n_a_yw_circle
+    };
+
+    /* blocks are small enough to keep all passes in l1 cache */
+    for (i = 0; i < n; i += CS2_PREDGPARAM3F_EVAL_N_BLOCK)
+    {
+        m = n - i < CS2_PREDGPARAM3F_EVAL_N_BLOCK ? n - i : CS2_PREDGPARAM3F_EVAL_N_BLOCK;
+
+        /* parametrization is computed in place of the output */
+        eval_n_tab[pgp->t](s12 + i, s23 + i, s31 + i, s0 + i, pgp, u + i, v + i, m, domain_component);
+
+        /* eigenmatrix rotation */
+        _cs2_predgparam3f_rotate_n(s12 + i, s23 + i, s31 + i, s0 + i, pgp, m);
+    }
+
+    /* debug */
+    for (i = 0; i < n; ++i)
+    {
+        if (CS2_VERIFY_SAMPLE())
+        {
+            cs2_spin3f_set(&s, s12[i], s23[i], s31[i], s0[i]);
+            _cs2_debug_verify_spinor(&s);
+        }
+    }
+}
+
+void cs2_predgparam3f_eval_d(struct cs2_spin3f_s *s, struct cs2_spin3f_s *su, struct cs2_spin3f_s *sv, const struct cs2_predgparam3f_s *pgp, double u, double v, int domain_component)
+{
+    double t[4], tu[4], tv[4];
+
+    CS2_ASSERT_MSG(u >= 0.0 && u <= 1.0 && v >= 0.0 && v <= 1.0, "param outside domain");
+    CS2_ASSERT_MSG(pgp->t >= 0 && pgp->t < cs2_predgparamtype3f_COUNT, "invalid param type");
+
+    static void (* const eval_d_tab[cs2_predgparamtype3f_COUNT])(double *, double *, double *, const struct cs2_predgparam3f_s *, double, double, int) = {
+        /* common */
+        _cs2_predgparam3f_eval_d_an_empty_set,
+
+        /* ellipsoidal */
+        _cs2_predgparam3f_eval_d_a_pair_of_points,
+        _cs2_predgparam3f_eval_d_a_pair_of_separate_ellipsoids,
+        _cs2_predgparam3f_eval_d_a_pair_of_y_touching_ellipsoids,
+        _cs2_predgparam3f_eval_d_a_pair_of_yz_crossed_ellipsoids,
+        _cs2_predgparam3f_eval_d_a_pair_of_z_touching_ellipsoids,
+        _cs2_predgparam3f_eval_d_a_y_barrel,
+        _cs2_predgparam3f_eval_d_a_z_barrel,
+        _cs2_predgparam3f_eval_d_a_notched_y_barrel,
+        _cs2_predgparam3f_eval_d_a_notched_z_barrel,
+        _cs2_predgparam3f_eval_d_a_pair_of_separate_yz_caps,
+
+        /* toroidal */
+        _cs2_predgparam3f_eval_d_a_xy_zw_torus,
+        _cs2_predgparam3f_eval_d_a_xy_circle,
+        _cs2_predgparam3f_eval_d_a_zw_circle,
+        _cs2_predgparam3f_eval_d_a_xz_yw_torus,
+        _cs2_predgparam3f_eval_d_a_xz_circle,
+        _cs2_predgparam3f_eval_d_a_yw_circle
+    };
+
+    eval_d_tab[pgp->t](t, tu, tv, pgp, u, v, domain_component);
+
+    /* eigenmatrix rotation (linear, applies to derivatives as well) */
+    _cs2_predgparam3f_rotate_d(s, pgp, t);
+    _cs2_predgparam3f_rotate_d(su, pgp, tu);
+    _cs2_predgparam3f_rotate_d(sv, pgp, tv);
+
+    /* debug */
+    if (CS2_VERIFY_SAMPLE())
+        _cs2_debug_verify_spinor(s);
+}
+
+/* residual: |eval(u, v, domain_component) - s| */
+static double _cs2_predgparam3f_residual(struct cs2_spin3f_s *r, struct cs2_spin3f_s *ru, struct cs2_spin3f_s *rv, const struct cs2_predgparam3f_s *pgp, double u, double v, int domain_component, const struct cs2_spin3f_s *s)
+{
+    cs2_predgparam3f_eval_d(r, ru, rv, pgp, u, v, domain_component);
+
+    r->s12 -= s->s12;
+    r->s23 -= s->s23;
+    r->s31 -= s->s31;
+    r->s0 -= s->s0;
+
+    return sqrt(r->s12 * r->s12 + r->s23 * r->s23 + r->s31 * r->s31 + r->s0 * r->s0);
+}
+
+static double _cs2_spin3f_dot(const struct cs2_spin3f_s *a, const struct cs2_spin3f_s *b)
+{
+    return a->s12 * b->s12 + a->s23 * b->s23 + a->s31 * b->s31 + a->s0 * b->s0;
+}
+
+double cs2_predgparam3f_inv(double *u, double *v, int *domain_component, const struct cs2_predgparam3f_s *pgp, const struct cs2_spin3f_s *s)
+{
+    struct cs2_spin3f_s r, ru, rv;
+    double t[4], res, tres, tu, tv, guu, guv, gvv, bu, bv, det, du, dv;
+    int i, dim;
+
+    const int ITER = 8;
+    const double EPS_RES = 10e-13;
+
+    CS2_ASSERT_MSG(pgp->t >= 0 && pgp->t < cs2_predgparamtype3f_COUNT, "invalid param type");
+
+    static void (* const inv_tab[cs2_predgparamtype3f_COUNT])(double *, double *, int *, const struct cs2_predgparam3f_s *, const double *) = {
+        /* common */
+        _cs2_predgparam3f_inv_an_empty_set,
+
+        /* ellipsoidal */
+        _cs2_predgparam3f_inv_a_pair_of_points,
+        _cs2_predgparam3f_inv_a_pair_of_separate_ellipsoids,
+        _cs2_predgparam3f_inv_a_pair_of_y_touching_ellipsoids,
+        _cs2_predgparam3f_inv_a_pair_of_yz_crossed_ellipsoids,
+        _cs2_predgparam3f_inv_a_pair_of_z_touching_ellipsoids,
+        _cs2_predgparam3f_inv_a_y_barrel,
+        _cs2_predgparam3f_inv_a_z_barrel,
+        _cs2_predgparam3f_inv_a_notched_y_barrel,
+        _cs2_predgparam3f_inv_a_notched_z_barrel,
+        _cs2_predgparam3f_inv_a_pair_of_separate_yz_caps,
+
+        /* toroidal */
+        _cs2_predgparam3f_inv_a_xy_zw_torus,
+        _cs2_predgparam3f_inv_a_xy_circle,
+        _cs2_predgparam3f_inv_a_zw_circle,
+        _cs2_predgparam3f_inv_a_xz_yw_torus,
+        _cs2_predgparam3f_inv_a_xz_circle,
+        _cs2_predgparam3f_inv_a_yw_circle
+    };
+
+    /* project through the eigenvectors: t = ev^T s */
+    for (i = 0; i < 4; ++i)
+        t[i] = pgp->ev[i].x * s->s12 + pgp->ev[i].y * s->s23 + pgp->ev[i].z * s->s31 + pgp->ev[i].w * s->s0;
+
+    /* closed form */
+    inv_tab[pgp->t](u, v, domain_component, pgp, t);
+
+    res = _cs2_predgparam3f_residual(&r, &ru, &rv, pgp, *u, *v, *domain_component, s);
+    dim = cs2_predgparamtype3f_dim(pgp->t);
+
+    /* gauss-newton polishing for spins off the zero set */
+    for (i = 0; i < ITER && res > EPS_RES && dim > 0; ++i)
+    {
+        guu = _cs2_spin3f_dot(&ru, &ru);
+        guv = _cs2_spin3f_dot(&ru, &rv);
+        gvv = _cs2_spin3f_dot(&rv, &rv);
+        bu = -_cs2_spin3f_dot(&ru, &r);
+        bv = -_cs2_spin3f_dot(&rv, &r);
+
+        if (dim == 1)
+        {
+            if (_cs2_almost_zero(guu))
+                break;
+
+            du = bu / guu;
+            dv = 0.0;
+        }
+        else
+        {
+            det = guu * gvv - guv * guv;
+
+            if (_cs2_almost_zero(det))
+                break;
+
+            du = (bu * gvv - bv * guv) / det;
+            dv = (bv * guu - bu * guv) / det;
+        }
+
+        /* u is periodic, v is clamped */
+        tu = *u + du;
+        tu -= floor(tu);
+        tv = *v + dv;
+        tv = tv < 0.0 ? 0.0 : (tv > 1.0 ? 1.0 : tv);
+
+        tres = _cs2_predgparam3f_residual(&r, &ru, &rv, pgp, tu, tv, *domain_component, s);
+
+        if (tres >= res)
+            break;
+
+        *u = tu;
+        *v = tv;
+        res = tres;
+    }
+
+    return res;
+}
+
+void cs2_predgparam3f_plan(struct cs2_predgplan3f_s *pl, const struct cs2_predgparam3f_s *pgp, int domain_component)
+{
+    double r, sgn;
+    int i;
+
+    CS2_ASSERT_MSG(pgp->t >= 0 && pgp->t < cs2_predgparamtype3f_COUNT, "invalid param type");
+    CS2_ASSERT_MSG(pgp->t == cs2_predgparamtype3f_an_empty_set || (domain_component >= 0 && domain_component < cs2_predgparamtype3f_domain_components(pgp->t)), "invalid component");
+
+    pl->t = pgp->t;
+    pl->dc = domain_component;
+
+    for (i = 0; i < 8; ++i)
+        pl->k[i] = 0.0;
+
+    /* plain eigenmatrix by default */
+    _cs2_predgplan3f_set_columns(pl, pgp, 1.0, 1.0, 0, 1, 2, 3);
+
+    sgn = domain_component == 0 ? 1.0 : -1.0;
+
+    switch (pgp->t)
+    {
+        case cs2_predgparamtype3f_an_empty_set:
+            pl->f = _cs2_predgplan3f_eval_an_empty_set;
+            break;
+
+        case cs2_predgparamtype3f_a_pair_of_points:
+            /* constant: sgn * ev[3] */
+            pl->k[0] = sgn * pgp->ev[3].x;
+            pl->k[1] = sgn * pgp->ev[3].y;
+            pl->k[2] = sgn * pgp->ev[3].z;
+            pl->k[3] = sgn * pgp->ev[3].w;
+            pl->f = _cs2_predgplan3f_eval_a_pair_of_points;
+            break;
+
+        case cs2_predgparamtype3f_a_pair_of_separate_ellipsoids:
+        case cs2_predgparamtype3f_a_pair_of_y_touching_ellipsoids:
+        case cs2_predgparamtype3f_a_pair_of_yz_crossed_ellipsoids:
+        case cs2_predgparamtype3f_a_pair_of_z_touching_ellipsoids:
+            r = 0.5 * (pgp->a + pgp->b + pgp->c);
+            pl->k[0] = sqrt(r / (pgp->a + pgp->b));
+            pl->k[1] = sqrt(r / pgp->a);
+            pl->k[2] = sqrt(r / pgp->b);
+            pl->k[3] = sgn;
+            pl->k[4] = domain_component == 0 ? 0.0 : CS2_PI;
+            pl->k[5] = sgn * CS2_PI;
+            pl->f = _cs2_predgplan3f_eval_ellipsoids;
+            break;
+
+        case cs2_predgparamtype3f_a_y_barrel:
+        case cs2_predgparamtype3f_a_notched_y_barrel:
+            pl->k[0] = sqrt((pgp->b - pgp->a + pgp->c) / (2.0 * pgp->b));
+            pl->k[1] = sqrt((pgp->b - pgp->a + pgp->c) / (2.0 * (pgp->b - pgp->a)));
+            _cs2_predgplan3f_set_ellipsoidal_invariants(pl, pgp);
+            pl->f = _cs2_predgplan3f_eval_y_barrel;
+            break;
+
+        case cs2_predgparamtype3f_a_z_barrel:
+        case cs2_predgparamtype3f_a_notched_z_barrel:
+            pl->k[0] = sqrt((pgp->a - pgp->b + pgp->c) / (2.0 * pgp->a));
+            pl->k[1] = sqrt((pgp->a - pgp->b + pgp->c) / (2.0 * (pgp->a - pgp->b)));
+            _cs2_predgplan3f_set_ellipsoidal_invariants(pl, pgp);
+            pl->f = _cs2_predgplan3f_eval_z_barrel;
+            break;
+
+        case cs2_predgparamtype3f_a_pair_of_separate_yz_caps:
+            pl->k[0] = sqrt((pgp->a + pgp->b - pgp->c) / (2.0 * pgp->b));
+            pl->k[1] = sqrt((pgp->a + pgp->b - pgp->c) / (2.0 * pgp->a));
+            _cs2_predgplan3f_set_ellipsoidal_invariants(pl, pgp);
+            pl->k[6] = sgn;
+            pl->k[7] = domain_component == 0 ? 0.0 : 1.0;
+            pl->f = _cs2_predgplan3f_eval_yz_caps;
+            break;
+
+        case cs2_predgparamtype3f_a_xy_zw_torus:
+            _cs2_predgplan3f_set_columns(pl, pgp, sqrt((pgp->a + pgp->c) / (2.0 * pgp->a)), sqrt((pgp->a - pgp->c) / (2.0 * pgp->a)), 0, 1, 2, 3);
+            pl->f = _cs2_predgplan3f_eval_torus;
+            break;
+
+        case cs2_predgparamtype3f_a_xy_circle:
+            _cs2_predgplan3f_set_columns(pl, pgp, 1.0, 0.0, 0, 1, 2, 3);
+            pl->f = _cs2_predgplan3f_eval_circle;
+            break;
+
+        case cs2_predgparamtype3f_a_zw_circle:
+            _cs2_predgplan3f_set_columns(pl, pgp, 1.0, 0.0, 2, 3, 0, 1);
+            pl->f = _cs2_predgplan3f_eval_circle;
+            break;
+
+        case cs2_predgparamtype3f_a_xz_yw_torus:
+            _cs2_predgplan3f_set_columns(pl, pgp, sqrt((pgp->b + pgp->c) / (2.0 * pgp->b)), sqrt((pgp->b - pgp->c) / (2.0 * pgp->b)), 0, 2, 1, 3);
+            pl->f = _cs2_predgplan3f_eval_torus;
+            break;
+
+        case cs2_predgparamtype3f_a_xz_circle:
+            _cs2_predgplan3f_set_columns(pl, pgp, 1.0, 0.0, 0, 2, 1, 3);
+            pl->f = _cs2_predgplan3f_eval_circle;
+            break;
+
+        case cs2_predgparamtype3f_a_yw_circle:
+            _cs2_predgplan3f_set_columns(pl, pgp, 1.0, 0.0, 1, 3, 0, 2);
+            pl->f = _cs2_predgplan3f_eval_circle;
+            break;
+
+        default:
+            CS2_PANIC_MSG("invalid param type");
+            break;
+    }
+}
+
+void cs2_predgplan3f_eval(struct cs2_spin3f_s *s, const struct cs2_predgplan3f_s *pl, double u, double v)
+{
+    CS2_ASSERT_MSG(u >= 0.0 && u <= 1.0 && v >= 0.0 && v <= 1.0, "param outside domain");
+
+    pl->f(s, pl, u, v);
 }
@@ -23,7 +23,22 @@
  * SOFTWARE.
  */
 #include "cs2/predg3x.h"
+#include "cs2/filter3x.h"
+#include "cs2/xctx.h"
 #include <cs2/assert.h>
+#include <float.h>
+#include <math.h>
+
+/* the cross product filter tests overflow with isfinite */
+#if defined(__FAST_MATH__) || (defined(__FINITE_MATH_ONLY__) && __FINITE_MATH_ONLY__)
+#error "predg3x must be built without fast math"
+#endif
+
+/* relative error bound of a floating-point 2x2 determinant with rounded inputs */
+#define CS2_PREDG3X_FILTER_EPS (8.0 * DBL_EPSILON)
+
+/* below this magnitude integers and their pairwise products are exact doubles */
+#define CS2_PREDG3X_FILTER_EXACT 0x1p26
 
 static void _cs2_calc_r(struct cs2_vec3x_s *r, const struct cs2_vec3x_s *v)
 {
@@ -66,13 +81,18 @@ void cs2_predg3x_clear(struct cs2_predg3x_s *g)
 }
 
 void cs2_predg3x_from_predh3x(struct cs2_predg3x_s *g, const struct cs2_predh3x_s *h)
+{
+    cs2_predg3x_from_predh3x_ctx(g, h, cs2_xctx_thread());
+}
+
+void cs2_predg3x_from_predh3x_ctx(struct cs2_predg3x_s *g, const struct cs2_predh3x_s *h, struct cs2_xctx_s *xc)
 {
     _cs2_calc_r(&g->l, &h->p.n);
-    cs2_vec3x_cross(&g->k, &h->p.n, &g->l);
-    cs2_vec3x_cross(&g->l, &h->p.n, &g->k);
+    cs2_vec3x_cross_ctx(&g->k, &h->p.n, &g->l, xc);
+    cs2_vec3x_cross_ctx(&g->l, &h->p.n, &g->k, xc);
     cs2_vec3x_copy(&g->a, &h->b);
     cs2_vec3x_neg(&g->b, &h->b);
-    cs2_vec3x_sqlen(g->c, &g->k);
+    cs2_vec3x_sqlen_ctx(g->c, &g->k, xc);
     mpz_mul(g->c, g->c, h->p.d);
     mpz_mul_2exp(g->c, g->c, 1);
 }
@@ -88,10 +108,15 @@ void cs2_predg3x_from_preds3x(struct cs2_predg3x_s *g, const struct cs2_preds3x_
 
 void cs2_predg3x_pquv(struct cs2_vec3x_s *p, struct cs2_vec3x_s *q, struct cs2_vec3x_s *u, struct cs2_vec3x_s *v, const struct cs2_predg3x_s *g)
 {
-    cs2_vec3x_cross(p, &g->k, &g->l);
+    cs2_predg3x_pquv_ctx(p, q, u, v, g, cs2_xctx_thread());
+}
+
+void cs2_predg3x_pquv_ctx(struct cs2_vec3x_s *p, struct cs2_vec3x_s *q, struct cs2_vec3x_s *u, struct cs2_vec3x_s *v, const struct cs2_predg3x_s *g, struct cs2_xctx_s *xc)
+{
+    cs2_vec3x_cross_ctx(p, &g->k, &g->l, xc);
     cs2_vec3x_sub(q, &g->a, &g->b);
     cs2_vec3x_sub(u, &g->k, &g->l);
-    cs2_vec3x_cross(v, &g->a, &g->b);
+    cs2_vec3x_cross_ctx(v, &g->a, &g->b, xc);
 }
 
 const char *cs2_predgtype3x_str(enum cs2_predgtype3x_e pgt)
@@ -111,25 +136,106 @@ const char *cs2_predgtype3x_str(enum cs2_predgtype3x_e pgt)
 
 enum cs2_predgtype3x_e cs2_predg3x_type(const struct cs2_predg3x_s *pg)
 {
-    struct cs2_vec3x_s p, q, u, v;
+    return cs2_predg3x_type_ctx(pg, cs2_xctx_thread());
+}
+
+enum cs2_predgtype3x_e cs2_predg3x_type_ctx(const struct cs2_predg3x_s *pg, struct cs2_xctx_s *xc)
+{
+    struct cs2_vec3x_s *p, *q, *u, *v;
     int pq, uv;
     enum cs2_predgtype3x_e t;
-    cs2_vec3x_init(&p);
-    cs2_vec3x_init(&q);
-    cs2_vec3x_init(&u);
-    cs2_vec3x_init(&v);
-    cs2_predg3x_pquv(&p, &q, &u, &v, pg);
-    pq = !cs2_vec3x_is_zero(&p) && !cs2_vec3x_is_zero(&q);
-    uv = !cs2_vec3x_is_zero(&u) && !cs2_vec3x_is_zero(&v);
+    p = cs2_xctx_get_vec3x(xc);
+    q = cs2_xctx_get_vec3x(xc);
+    u = cs2_xctx_get_vec3x(xc);
+    v = cs2_xctx_get_vec3x(xc);
+    cs2_predg3x_pquv_ctx(p, q, u, v, pg, xc);
+    pq = !cs2_vec3x_is_zero(p) && !cs2_vec3x_is_zero(q);
+    uv = !cs2_vec3x_is_zero(u) && !cs2_vec3x_is_zero(v);
     if (pq && uv)
         t = cs2_predgtype3x_ellipsoidal;
     else if (pq || uv)
         t = cs2_predgtype3x_toroidal;
     else
         t = cs2_predgtype3x_improper;
-    cs2_vec3x_clear(&p);
-    cs2_vec3x_clear(&q);
-    cs2_vec3x_clear(&u);
-    cs2_vec3x_clear(&v);
+    cs2_xctx_put_vec3x(xc, 4);
     return t;
 }
+
+/* is a x b zero: 1 if zero, 0 if not, -1 if uncertain */
+static int _cs2_filter_cross_is_zero(const struct cs2_vec3x_s *a, const struct cs2_vec3x_s *b)
+{
+    double ax = cs2_filter3x_get_d(a->x), ay = cs2_filter3x_get_d(a->y), az = cs2_filter3x_get_d(a->z);
+    double bx = cs2_filter3x_get_d(b->x), by = cs2_filter3x_get_d(b->y), bz = cs2_filter3x_get_d(b->z);
+    double c[3], m[3], e;
+    int i, exact;
+
+    c[0] = ay * bz - az * by;
+    c[1] = az * bx - ax * bz;
+    c[2] = ax * by - ay * bx;
+
+    m[0] = fabs(ay * bz) + fabs(az * by);
+    m[1] = fabs(az * bx) + fabs(ax * bz);
+    m[2] = fabs(ax * by) + fabs(ay * bx);
+
+    exact = fabs(ax) < CS2_PREDG3X_FILTER_EXACT && fabs(ay) < CS2_PREDG3X_FILTER_EXACT && fabs(az) < CS2_PREDG3X_FILTER_EXACT &&
+            fabs(bx) < CS2_PREDG3X_FILTER_EXACT && fabs(by) < CS2_PREDG3X_FILTER_EXACT && fabs(bz) < CS2_PREDG3X_FILTER_EXACT;
+
+    for (i = 0; i < 3; ++i)
+    {
+        if (!isfinite(m[i]))
+            return -1;
+
+        e = CS2_PREDG3X_FILTER_EPS * m[i];
+
+        if (c[i] > e || c[i] < -e)
+            return 0;
+    }
+
+    /* small inputs are computed without error */
+    if (exact)
+        return c[0] == 0.0 && c[1] == 0.0 && c[2] == 0.0;
+
+    return -1;
+}
+
+static int _cs2_vec3x_eq(const struct cs2_vec3x_s *a, const struct cs2_vec3x_s *b)
+{
+    return !mpz_cmp(a->x, b->x) && !mpz_cmp(a->y, b->y) && !mpz_cmp(a->z, b->z);
+}
+
+enum cs2_predgtype3x_e cs2_predg3x_type_filtered(const struct cs2_predg3x_s *pg)
+{
+    return cs2_predg3x_type_filtered_ctx(pg, cs2_xctx_thread());
+}
+
+enum cs2_predgtype3x_e cs2_predg3x_type_filtered_ctx(const struct cs2_predg3x_s *pg, struct cs2_xctx_s *xc)
+{
+    int zp, zq, zu, zv, pq, uv;
+
+    /* q = a - b, u = k - l */
+    zq = _cs2_vec3x_eq(&pg->a, &pg->b);
+    zu = _cs2_vec3x_eq(&pg->k, &pg->l);
+
+    /* p = k x l, v = a x b */
+    zp = zu ? 1 : _cs2_filter_cross_is_zero(&pg->k, &pg->l);
+    zv = zq ? 1 : _cs2_filter_cross_is_zero(&pg->a, &pg->b);
+
+    if (zp < 0 || zv < 0)
+    {
+        /* uncertain, exact fallback */
+        cs2_filter3x_record(cs2_filter3x_predg3x_type, 0);
+        return cs2_predg3x_type_ctx(pg, xc);
+    }
+
+    cs2_filter3x_record(cs2_filter3x_predg3x_type, 1);
+
+    pq = !zp && !zq;
+    uv = !zu && !zv;
+
+    if (pq && uv)
+        return cs2_predgtype3x_ellipsoidal;
+    else if (pq || uv)
+        return cs2_predgtype3x_toroidal;
+    else
+        return cs2_predgtype3x_improper;
+}
@@ -25,8 +25,17 @@
 #include "cs2/spinquad3f.h"
 #include "cs2/vec3f.h"
 #include "cs2/assert.h"
+#include <float.h>
 #include <math.h>
 
+/* range bounds assume every operation is rounded once, in program order */
+#if defined(__FAST_MATH__)
+#error "spinquad3f must be built without fast math"
+#endif
+
+/* relative rounding error bound of range evaluation (a few dozen operations) */
+#define CS2_SPINQUAD3F_RANGE_EPS (64.0 * DBL_EPSILON)
+
 void cs2_spinquad3f_from_predh3f(struct cs2_spinquad3f_s *sq, const struct cs2_predh3f_s *ph)
 {
     struct cs2_predg3f_s g;
@@ -102,6 +111,209 @@ double cs2_spinquad3f_eval(const struct cs2_spinquad3f_s *sq, const struct cs2_s
                 sq->a34 * s->s31 * s->s0);
 }
 
+static void _cs2_spinquad3f_mat(double q[4][4], const struct cs2_spinquad3f_s *sq)
+{
+    q[0][0] = sq->a11; q[0][1] = sq->a12; q[0][2] = sq->a13; q[0][3] = sq->a14;
+    q[1][0] = sq->a12; q[1][1] = sq->a22; q[1][2] = sq->a23; q[1][3] = sq->a24;
+    q[2][0] = sq->a13; q[2][1] = sq->a23; q[2][2] = sq->a33; q[2][3] = sq->a34;
+    q[3][0] = sq->a14; q[3][1] = sq->a24; q[3][2] = sq->a34; q[3][3] = sq->a44;
+}
+
+static void _cs2_spin3f_vec(double x[4], const struct cs2_spin3f_s *s)
+{
+    x[0] = s->s12;
+    x[1] = s->s23;
+    x[2] = s->s31;
+    x[3] = s->s0;
+}
+
+/* [lo, hi] * [lo, hi] */
+static void _cs2_interval_sqr(double *rlo, double *rhi, double lo, double hi)
+{
+    if (lo >= 0.0)
+    {
+        *rlo = lo * lo;
+        *rhi = hi * hi;
+    }
+    else if (hi <= 0.0)
+    {
+        *rlo = hi * hi;
+        *rhi = lo * lo;
+    }
+    else
+    {
+        *rlo = 0.0;
+        *rhi = fmax(lo * lo, hi * hi);
+    }
+}
+
+/* [alo, ahi] * [blo, bhi] */
+static void _cs2_interval_mul(double *rlo, double *rhi, double alo, double ahi, double blo, double bhi)
+{
+    double p0 = alo * blo, p1 = alo * bhi, p2 = ahi * blo, p3 = ahi * bhi;
+
+    *rlo = fmin(fmin(p0, p1), fmin(p2, p3));
+    *rhi = fmax(fmax(p0, p1), fmax(p2, p3));
+}
+
+/* k * [lo, hi] accumulated into [rlo, rhi] */
+static void _cs2_interval_madd(double *rlo, double *rhi, double k, double lo, double hi)
+{
+    if (k >= 0.0)
+    {
+        *rlo += k * lo;
+        *rhi += k * hi;
+    }
+    else
+    {
+        *rlo += k * hi;
+        *rhi += k * lo;
+    }
+}
+
+void cs2_spinquad3f_eval_box(double *rmin, double *rmax, const struct cs2_spinquad3f_s *sq, const struct cs2_spinbox3f_s *b)
+{
+    double q[4][4], lo[4], hi[4], c[4], h[4], m[4];
+    double nlo = 0.0, nhi = 0.0, clo, chi, g, t, fc = 0.0, dlo = 0.0, dhi = 0.0, lin = 0.0, quad = 0.0, mag = 0.0, err;
+    int i, j;
+
+    _cs2_spinquad3f_mat(q, sq);
+    _cs2_spin3f_vec(lo, &b->lo);
+    _cs2_spin3f_vec(hi, &b->hi);
+
+    CS2_ASSERT_MSG(lo[0] <= hi[0] && lo[1] <= hi[1] && lo[2] <= hi[2] && lo[3] <= hi[3], "invalid spin box");
+
+    for (i = 0; i < 4; ++i)
+    {
+        c[i] = 0.5 * (lo[i] + hi[i]);
+        h[i] = 0.5 * (hi[i] - lo[i]);
+        m[i] = fmax(fabs(lo[i]), fabs(hi[i]));
+    }
+
+    /* natural interval extension: diagonal terms use exact square ranges */
+    for (i = 0; i < 4; ++i)
+    {
+        _cs2_interval_sqr(&clo, &chi, lo[i], hi[i]);
+        _cs2_interval_madd(&nlo, &nhi, q[i][i], clo, chi);
+
+        for (j = i + 1; j < 4; ++j)
+        {
+            _cs2_interval_mul(&clo, &chi, lo[i], hi[i], lo[j], hi[j]);
+            _cs2_interval_madd(&nlo, &nhi, 2.0 * q[i][j], clo, chi);
+        }
+    }
+
+    /* centered form: F(c + d) = F(c) + 2 (Q c) d + d^T Q d, |d_i| <= h_i */
+    for (i = 0; i < 4; ++i)
+    {
+        g = 0.0;
+
+        for (j = 0; j < 4; ++j)
+        {
+            g += q[i][j] * c[j];
+            mag += fabs(q[i][j]) * m[i] * m[j];
+        }
+
+        fc += g * c[i];
+        lin += fabs(g) * h[i];
+
+        /* diagonal of d^T Q d keeps its sign */
+        t = q[i][i] * h[i] * h[i];
+
+        if (t >= 0.0)
+            dhi += t;
+        else
+            dlo += t;
+
+        for (j = 0; j < 4; ++j)
+            if (j != i)
+                quad += fabs(q[i][j]) * h[i] * h[j];
+    }
+
+    clo = fc + dlo - 2.0 * lin - quad;
+    chi = fc + dhi + 2.0 * lin + quad;
+
+    /* every intermediate term is bounded by the magnitude of F on the box */
+    err = CS2_SPINQUAD3F_RANGE_EPS * mag;
+
+    *rmin = fmax(nlo, clo) - err;
+    *rmax = fmin(nhi, chi) + err;
+}
+
+int cs2_spinquad3f_sign_box(const struct cs2_spinquad3f_s *sq, const struct cs2_spinbox3f_s *b)
+{
+    double rmin, rmax;
+
+    cs2_spinquad3f_eval_box(&rmin, &rmax, sq, b);
+
+    if (rmin > 0.0)
+        return 1;
+
+    if (rmax < 0.0)
+        return -1;
+
+    return 0;
+}
+
+void cs2_spinquad3f_eval_cap(double *rmin, double *rmax, const struct cs2_spinquad3f_s *sq, const struct cs2_spin3f_s *c, double r)
+{
+    double q[4][4], x[4], g, gl = 0.0, fc = 0.0, nf = 0.0, mu, d, err;
+    int i, j;
+
+    CS2_ASSERT_MSG(r >= 0.0, "invalid cap radius");
+
+    _cs2_spinquad3f_mat(q, sq);
+    _cs2_spin3f_vec(x, c);
+
+    /* on the unit sphere F(s) = mu + s^T (Q - mu I) s; the shift by the mean eigenvalue shrinks the norm */
+    mu = 0.25 * (q[0][0] + q[1][1] + q[2][2] + q[3][3]);
+
+    for (i = 0; i < 4; ++i)
+        q[i][i] -= mu;
+
+    for (i = 0; i < 4; ++i)
+    {
+        g = 0.0;
+
+        for (j = 0; j < 4; ++j)
+        {
+            g += q[i][j] * x[j];
+            nf += q[i][j] * q[i][j];
+        }
+
+        fc += g * x[i];
+        gl += g * g;
+    }
+
+    /* |s - c| <= r and |s| = 1 never exceed the diameter */
+    r = fmin(r, 2.0);
+    nf = sqrt(nf);
+
+    /* F(c + d) = mu + F'(c) + 2 (Q' c) d + d^T Q' d, |d| <= r, |d^T Q' d| <= |Q'|_F r^2 */
+    d = 2.0 * sqrt(gl) * r + nf * r * r;
+
+    err = CS2_SPINQUAD3F_RANGE_EPS * (fabs(mu) + nf * (1.0 + r) * (1.0 + r));
+
+    /* global range on the sphere: |F'(s)| <= |Q'|_F */
+    *rmin = mu + fmax(fc - d, -nf) - err;
+    *rmax = mu + fmin(fc + d, nf) + err;
+}
+
+int cs2_spinquad3f_sign_cap(const struct cs2_spinquad3f_s *sq, const struct cs2_spin3f_s *c, double r)
+{
+    double rmin, rmax;
+
+    cs2_spinquad3f_eval_cap(&rmin, &rmax, sq, c, r);
+
+    if (rmin > 0.0)
+        return 1;
+
+    if (rmax < 0.0)
+        return -1;
+
+    return 0;
+}
+
 double cs2_spinquad3f_len(const struct cs2_spinquad3f_s *sq)
 {
     return sqrt(sq->a11 * sq->a11 + sq->a12 * sq->a12 + sq->a13 * sq->a13 + sq->a14 * sq->a14 +
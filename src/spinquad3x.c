@@ -24,6 +24,18 @@
  */
 #include "cs2/spinquad3x.h"
 #include "cs2/vec3x.h"
+#include "cs2/filter3x.h"
+#include "cs2/xctx.h"
+#include <float.h>
+#include <math.h>
+
+/* the sign filter tests overflow with isfinite */
+#if defined(__FAST_MATH__) || (defined(__FINITE_MATH_ONLY__) && __FINITE_MATH_ONLY__)
+#error "spinquad3x must be built without fast math"
+#endif
+
+/* relative error bound of the floating-point evaluation (rounded inputs, products and sums) */
+#define CS2_SPINQUAD3X_FILTER_EPS (16.0 * DBL_EPSILON)
 
 void cs2_spinquad3x_init(struct cs2_spinquad3x_s *sq)
 {
@@ -56,68 +68,214 @@ void cs2_spinquad3x_clear(struct cs2_spinquad3x_s *sq)
 void cs2_spinquad3x_from_predh3x(struct cs2_spinquad3x_s *sq, const struct cs2_predh3x_s *ph)
 {
     struct cs2_predg3x_s g;
-    cs2_predg3x_from_predh3x(&g, ph);
-    cs2_spinquad3x_from_predg3x(sq, &g);
+    struct cs2_xctx_s *xc = cs2_xctx_thread();
+    cs2_predg3x_init(&g);
+    cs2_predg3x_from_predh3x_ctx(&g, ph, xc);
+    cs2_spinquad3x_from_predg3x_ctx(sq, &g, xc);
+    cs2_predg3x_clear(&g);
 }
 
 void cs2_spinquad3x_from_preds3x(struct cs2_spinquad3x_s *sq, const struct cs2_preds3x_s *ps)
 {
     struct cs2_predg3x_s g;
+    cs2_predg3x_init(&g);
     cs2_predg3x_from_preds3x(&g, ps);
     cs2_spinquad3x_from_predg3x(sq, &g);
+    cs2_predg3x_clear(&g);
+}
+
+#if defined(CS2_FILTER3X_INT128)
+/* 128-bit spin quadric of a predicate with coordinates of at most 40 bits, 0 if inputs are too large */
+static int _cs2_spinquad3x_from_predg3x_i128(struct cs2_spinquad3x_s *sq, const struct cs2_predg3x_s *pg)
+{
+    const struct cs2_vec3x_s *in[4] = { &pg->k, &pg->l, &pg->a, &pg->b };
+    long x[4][3], c;
+    cs2_int128_t px, py, pz, qx, qy, qz, ux, uy, uz, vx, vy, vz;
+    cs2_int128_t pxqx, pxqy, pxqz, pyqx, pyqy, pyqz, pzqx, pzqy, pzqz, uxvx, uxvy, uxvz, uyvx, uyvy, uyvz, uzvx, uzvy, uzvz;
+    int i, b;
+
+    /* |p|, |v| < 2^81, |q|, |u| < 2^41, coefficients < 2^125 + |c| */
+    for (i = 0; i < 4; ++i)
+    {
+        b = cs2_filter3x_get_si(&x[i][0], in[i]->x);
+
+        if (b < 0 || b > 40)
+            return 0;
+
+        b = cs2_filter3x_get_si(&x[i][1], in[i]->y);
+
+        if (b < 0 || b > 40)
+            return 0;
+
+        b = cs2_filter3x_get_si(&x[i][2], in[i]->z);
+
+        if (b < 0 || b > 40)
+            return 0;
+    }
+
+    if (cs2_filter3x_get_si(&c, pg->c) < 0)
+        return 0;
+
+    /* p = k x l, q = a - b, u = k - l, v = a x b */
+    px = (cs2_int128_t)x[0][1] * x[1][2] - (cs2_int128_t)x[0][2] * x[1][1];
+    py = (cs2_int128_t)x[0][2] * x[1][0] - (cs2_int128_t)x[0][0] * x[1][2];
+    pz = (cs2_int128_t)x[0][0] * x[1][1] - (cs2_int128_t)x[0][1] * x[1][0];
+    qx = (cs2_int128_t)x[2][0] - x[3][0];
+    qy = (cs2_int128_t)x[2][1] - x[3][1];
+    qz = (cs2_int128_t)x[2][2] - x[3][2];
+    ux = (cs2_int128_t)x[0][0] - x[1][0];
+    uy = (cs2_int128_t)x[0][1] - x[1][1];
+    uz = (cs2_int128_t)x[0][2] - x[1][2];
+    vx = (cs2_int128_t)x[2][1] * x[3][2] - (cs2_int128_t)x[2][2] * x[3][1];
+    vy = (cs2_int128_t)x[2][2] * x[3][0] - (cs2_int128_t)x[2][0] * x[3][2];
+    vz = (cs2_int128_t)x[2][0] * x[3][1] - (cs2_int128_t)x[2][1] * x[3][0];
+
+    /* multiplies */
+    pxqx = px * qx;
+    pxqy = px * qy;
+    pxqz = px * qz;
+    pyqx = py * qx;
+    pyqy = py * qy;
+    pyqz = py * qz;
+    pzqx = pz * qx;
+    pzqy = pz * qy;
+    pzqz = pz * qz;
+    uxvx = ux * vx;
+    uxvy = ux * vy;
+    uxvz = ux * vz;
+    uyvx = uy * vx;
+    uyvy = uy * vy;
+    uyvz = uy * vz;
+    uzvx = uz * vx;
+    uzvy = uz * vy;
+    uzvz = uz * vz;
+
+    /* reduced spin quadric */
+    cs2_filter3x_set_i128(sq->a11, - uxvx - uyvy + uzvz - pxqx - pyqy + pzqz + c);
+    cs2_filter3x_set_i128(sq->a22,   uxvx - uyvy - uzvz + pxqx - pyqy - pzqz + c);
+    cs2_filter3x_set_i128(sq->a33, - uxvx + uyvy - uzvz - pxqx + pyqy - pzqz + c);
+    cs2_filter3x_set_i128(sq->a44,   uxvx + uyvy + uzvz + pxqx + pyqy + pzqz + c);
+    cs2_filter3x_set_i128(sq->a12,   uxvz + pzqx + uzvx + pxqz);
+    cs2_filter3x_set_i128(sq->a13,   uyvz + pzqy + uzvy + pyqz);
+    cs2_filter3x_set_i128(sq->a14,   uxvy - uyvx - pyqx + pxqy);
+    cs2_filter3x_set_i128(sq->a23,   uxvy + uyvx + pyqx + pxqy);
+    cs2_filter3x_set_i128(sq->a24,   uyvz - pzqy - uzvy + pyqz);
+    cs2_filter3x_set_i128(sq->a34, - uxvz + pzqx + uzvx - pxqz);
+
+    return 1;
 }
 
+/* 128-bit evaluation, 0 if F(p) could overflow */
+static int _cs2_spinquad3x_eval_i128(mpz_ptr s, const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p)
+{
+    mpz_srcptr in[14] = { sq->a11, sq->a22, sq->a33, sq->a44, sq->a12, sq->a13, sq->a14, sq->a23, sq->a24, sq->a34, p->p12, p->p23, p->p31, p->p0 };
+    long x[14];
+    int i, b, ba = 0, bp = 0;
+    cs2_int128_t f;
+
+    for (i = 0; i < 14; ++i)
+    {
+        b = cs2_filter3x_get_si(&x[i], in[i]);
+
+        if (b < 0)
+            return 0;
+
+        if (i < 10)
+            ba = b > ba ? b : ba;
+        else
+            bp = b > bp ? b : bp;
+    }
+
+    /* |F| < 16 * 2^(ba + 2 bp) */
+    if (ba + 2 * bp > 122)
+        return 0;
+
+    f = (cs2_int128_t)x[4] * x[10] * x[11] +
+        (cs2_int128_t)x[5] * x[10] * x[12] +
+        (cs2_int128_t)x[6] * x[10] * x[13] +
+        (cs2_int128_t)x[7] * x[11] * x[12] +
+        (cs2_int128_t)x[8] * x[11] * x[13] +
+        (cs2_int128_t)x[9] * x[12] * x[13];
+
+    f = 2 * f +
+        (cs2_int128_t)x[0] * x[10] * x[10] +
+        (cs2_int128_t)x[1] * x[11] * x[11] +
+        (cs2_int128_t)x[2] * x[12] * x[12] +
+        (cs2_int128_t)x[3] * x[13] * x[13];
+
+    cs2_filter3x_set_i128(s, f);
+
+    return 1;
+}
+#endif /* defined(CS2_FILTER3X_INT128) */
+
 void cs2_spinquad3x_from_predg3x(struct cs2_spinquad3x_s *sq, const struct cs2_predg3x_s *pg)
 {
-    struct cs2_vec3x_s p, q, u, v;
-    mpz_t pxqx, pxqy, pxqz, pyqx, pyqy, pyqz, pzqx, pzqy, pzqz, uxvx, uxvy, uxvz, uyvx, uyvy, uyvz, uzvx, uzvy, uzvz;
+    cs2_spinquad3x_from_predg3x_ctx(sq, pg, cs2_xctx_thread());
+}
+
+void cs2_spinquad3x_from_predg3x_ctx(struct cs2_spinquad3x_s *sq, const struct cs2_predg3x_s *pg, struct cs2_xctx_s *xc)
+{
+    struct cs2_vec3x_s *p, *q, *u, *v;
+    mpz_ptr pxqx, pxqy, pxqz, pyqx, pyqy, pyqz, pzqx, pzqy, pzqz, uxvx, uxvy, uxvz, uyvx, uyvy, uyvz, uzvx, uzvy, uzvz;
+
+#if defined(CS2_FILTER3X_INT128)
+    /* fixed-width fast path */
+    if (_cs2_spinquad3x_from_predg3x_i128(sq, pg))
+    {
+        cs2_filter3x_record(cs2_filter3x_spinquad3x_from_predg3x, 1);
+        return;
+    }
+
+    cs2_filter3x_record(cs2_filter3x_spinquad3x_from_predg3x, 0);
+#endif /* defined(CS2_FILTER3X_INT128) */
 
     /* init */
-    cs2_vec3x_init(&p);
-    cs2_vec3x_init(&q);
-    cs2_vec3x_init(&u);
-    cs2_vec3x_init(&v);
-    mpz_init(pxqx);
-    mpz_init(pxqy);
-    mpz_init(pxqz);
-    mpz_init(pyqx);
-    mpz_init(pyqy);
-    mpz_init(pyqz);
-    mpz_init(pzqx);
-    mpz_init(pzqy);
-    mpz_init(pzqz);
-    mpz_init(uxvx);
-    mpz_init(uxvy);
-    mpz_init(uxvz);
-    mpz_init(uyvx);
-    mpz_init(uyvy);
-    mpz_init(uyvz);
-    mpz_init(uzvx);
-    mpz_init(uzvy);
-    mpz_init(uzvz);
+    p = cs2_xctx_get_vec3x(xc);
+    q = cs2_xctx_get_vec3x(xc);
+    u = cs2_xctx_get_vec3x(xc);
+    v = cs2_xctx_get_vec3x(xc);
+    pxqx = cs2_xctx_get_mpz(xc);
+    pxqy = cs2_xctx_get_mpz(xc);
+    pxqz = cs2_xctx_get_mpz(xc);
+    pyqx = cs2_xctx_get_mpz(xc);
+    pyqy = cs2_xctx_get_mpz(xc);
+    pyqz = cs2_xctx_get_mpz(xc);
+    pzqx = cs2_xctx_get_mpz(xc);
+    pzqy = cs2_xctx_get_mpz(xc);
+    pzqz = cs2_xctx_get_mpz(xc);
+    uxvx = cs2_xctx_get_mpz(xc);
+    uxvy = cs2_xctx_get_mpz(xc);
+    uxvz = cs2_xctx_get_mpz(xc);
+    uyvx = cs2_xctx_get_mpz(xc);
+    uyvy = cs2_xctx_get_mpz(xc);
+    uyvz = cs2_xctx_get_mpz(xc);
+    uzvx = cs2_xctx_get_mpz(xc);
+    uzvy = cs2_xctx_get_mpz(xc);
+    uzvz = cs2_xctx_get_mpz(xc);
 
     /* p, q, u, v */
-    cs2_predg3x_pquv(&p, &q, &u, &v, pg);
+    cs2_predg3x_pquv_ctx(p, q, u, v, pg, xc);
 
     /* multiplies */
-    mpz_mul(pxqx, p.x, q.x);
-    mpz_mul(pxqy, p.x, q.y);
-    mpz_mul(pxqz, p.x, q.z);
-    mpz_mul(pyqx, p.y, q.x);
-    mpz_mul(pyqy, p.y, q.y);
-    mpz_mul(pyqz, p.y, q.z);
-    mpz_mul(pzqx, p.z, q.x);
-    mpz_mul(pzqy, p.z, q.y);
-    mpz_mul(pzqz, p.z, q.z);
-    mpz_mul(uxvx, u.x, v.x);
-    mpz_mul(uxvy, u.x, v.y);
-    mpz_mul(uxvz, u.x, v.z);
-    mpz_mul(uyvx, u.y, v.x);
-    mpz_mul(uyvy, u.y, v.y);
-    mpz_mul(uyvz, u.y, v.z);
-    mpz_mul(uzvx, u.z, v.x);
-    mpz_mul(uzvy, u.z, v.y);
-    mpz_mul(uzvz, u.z, v.z);
+    mpz_mul(pxqx, p->x, q->x);
+    mpz_mul(pxqy, p->x, q->y);
+    mpz_mul(pxqz, p->x, q->z);
+    mpz_mul(pyqx, p->y, q->x);
+    mpz_mul(pyqy, p->y, q->y);
+    mpz_mul(pyqz, p->y, q->z);
+    mpz_mul(pzqx, p->z, q->x);
+    mpz_mul(pzqy, p->z, q->y);
+    mpz_mul(pzqz, p->z, q->z);
+    mpz_mul(uxvx, u->x, v->x);
+    mpz_mul(uxvy, u->x, v->y);
+    mpz_mul(uxvz, u->x, v->z);
+    mpz_mul(uyvx, u->y, v->x);
+    mpz_mul(uyvy, u->y, v->y);
+    mpz_mul(uyvz, u->y, v->z);
+    mpz_mul(uzvx, u->z, v->x);
+    mpz_mul(uzvy, u->z, v->y);
+    mpz_mul(uzvz, u->z, v->z);
 
     /* base spin quadric */
     /* s12^2 */
@@ -185,34 +343,31 @@ void cs2_spinquad3x_from_predg3x(struct cs2_spinquad3x_s *sq, const struct cs2_p
     mpz_add(sq->a44, sq->a44, pg->c);
 
     /* clear */
-    cs2_vec3x_clear(&p);
-    cs2_vec3x_clear(&q);
-    cs2_vec3x_clear(&u);
-    cs2_vec3x_clear(&v);
-    mpz_clear(pxqx);
-    mpz_clear(pxqy);
-    mpz_clear(pxqz);
-    mpz_clear(pyqx);
-    mpz_clear(pyqy);
-    mpz_clear(pyqz);
-    mpz_clear(pzqx);
-    mpz_clear(pzqy);
-    mpz_clear(pzqz);
-    mpz_clear(uxvx);
-    mpz_clear(uxvy);
-    mpz_clear(uxvz);
-    mpz_clear(uyvx);
-    mpz_clear(uyvy);
-    mpz_clear(uyvz);
-    mpz_clear(uzvx);
-    mpz_clear(uzvy);
-    mpz_clear(uzvz);
+    cs2_xctx_put_mpz(xc, 18);
+    cs2_xctx_put_vec3x(xc, 4);
 }
 
 void cs2_spinquad3x_eval(mpz_ptr s, const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_spinquad3x_eval_ctx(s, sq, p, cs2_xctx_thread());
+}
+
+void cs2_spinquad3x_eval_ctx(mpz_ptr s, const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t;
+
+#if defined(CS2_FILTER3X_INT128)
+    /* fixed-width fast path */
+    if (_cs2_spinquad3x_eval_i128(s, sq, p))
+    {
+        cs2_filter3x_record(cs2_filter3x_spinquad3x_eval, 1);
+        return;
+    }
+
+    cs2_filter3x_record(cs2_filter3x_spinquad3x_eval, 0);
+#endif /* defined(CS2_FILTER3X_INT128) */
+
+    t = cs2_xctx_get_mpz(xc);
     mpz_mul(s, p->p12, p->p23);
     mpz_mul(s, s, sq->a12);
     mpz_mul(t, p->p12, p->p31);
@@ -243,5 +398,69 @@ void cs2_spinquad3x_eval(mpz_ptr s, const struct cs2_spinquad3x_s *sq, const str
     mpz_mul(t, p->p0, p->p0);
     mpz_mul(t, t, sq->a44);
     mpz_add(s, s, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
+}
+
+int cs2_spinquad3x_sign(const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p)
+{
+    return cs2_spinquad3x_sign_ctx(sq, p, cs2_xctx_thread());
+}
+
+int cs2_spinquad3x_sign_ctx(const struct cs2_spinquad3x_s *sq, const struct cs2_pin3x_s *p, struct cs2_xctx_s *xc)
+{
+    double p12, p23, p31, p0, a11, a22, a33, a44, a12, a13, a14, a23, a24, a34, f, m;
+    mpz_ptr s;
+    int sign;
+
+    p12 = cs2_filter3x_get_d(p->p12);
+    p23 = cs2_filter3x_get_d(p->p23);
+    p31 = cs2_filter3x_get_d(p->p31);
+    p0 = cs2_filter3x_get_d(p->p0);
+    a11 = cs2_filter3x_get_d(sq->a11);
+    a22 = cs2_filter3x_get_d(sq->a22);
+    a33 = cs2_filter3x_get_d(sq->a33);
+    a44 = cs2_filter3x_get_d(sq->a44);
+    a12 = cs2_filter3x_get_d(sq->a12);
+    a13 = cs2_filter3x_get_d(sq->a13);
+    a14 = cs2_filter3x_get_d(sq->a14);
+    a23 = cs2_filter3x_get_d(sq->a23);
+    a24 = cs2_filter3x_get_d(sq->a24);
+    a34 = cs2_filter3x_get_d(sq->a34);
+
+    f = a11 * p12 * p12 + a22 * p23 * p23 + a33 * p31 * p31 + a44 * p0 * p0 +
+        2 * (a12 * p12 * p23 + a13 * p12 * p31 + a14 * p12 * p0 +
+             a23 * p23 * p31 + a24 * p23 * p0 + a34 * p31 * p0);
+
+    /* magnitude: the same sum of absolute terms */
+    m = fabs(a11) * p12 * p12 + fabs(a22) * p23 * p23 + fabs(a33) * p31 * p31 + fabs(a44) * p0 * p0 +
+        2 * (fabs(a12 * p12 * p23) + fabs(a13 * p12 * p31) + fabs(a14 * p12 * p0) +
+             fabs(a23 * p23 * p31) + fabs(a24 * p23 * p0) + fabs(a34 * p31 * p0));
+
+    /* non-zero integers never round to zero, so every term vanishes exactly */
+    if (m == 0.0)
+    {
+        cs2_filter3x_record(cs2_filter3x_spinquad3x_sign, 1);
+        return 0;
+    }
+
+    if (isfinite(m))
+    {
+        m *= CS2_SPINQUAD3X_FILTER_EPS;
+
+        if (f > m || f < -m)
+        {
+            cs2_filter3x_record(cs2_filter3x_spinquad3x_sign, 1);
+            return f > 0.0 ? 1 : -1;
+        }
+    }
+
+    /* uncertain, exact fallback */
+    cs2_filter3x_record(cs2_filter3x_spinquad3x_sign, 0);
+
+    s = cs2_xctx_get_mpz(xc);
+    cs2_spinquad3x_eval_ctx(s, sq, p, xc);
+    sign = mpz_sgn(s);
+    cs2_xctx_put_mpz(xc, 1);
+
+    return sign;
 }
@@ -0,0 +1,227 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/spinquadbank3f.h"
+#include "cs2/assert.h"
+#include "cs2/mem.h"
+#include <string.h>
+
+/* quadrics per mask word */
+#define CS2_SPINQUADBANK3F_WORD 64
+
+/* number of coefficients */
+#define CS2_SPINQUADBANK3F_COEFFS 10
+
+/* spin monomials in coefficient order */
+static void _cs2_spinquadbank3f_monomials(double *p, double s12, double s23, double s31, double s0)
+{
+    p[0] = s12 * s12;
+    p[1] = s23 * s23;
+    p[2] = s31 * s31;
+    p[3] = s0 * s0;
+    p[4] = s12 * s23;
+    p[5] = s12 * s31;
+    p[6] = s12 * s0;
+    p[7] = s23 * s31;
+    p[8] = s23 * s0;
+    p[9] = s31 * s0;
+}
+
+/* f[i] = sum_k c[k * cap + i] p[k], i = begin, ..., end - 1 */
+CS2_SIMD_CLONES
+static void _cs2_spinquadbank3f_eval_range(double *f, const double *c, size_t cap, const double *p, size_t begin, size_t end)
+{
+    const double *c0 = c, *c1 = c + cap, *c2 = c + 2 * cap, *c3 = c + 3 * cap, *c4 = c + 4 * cap;
+    const double *c5 = c + 5 * cap, *c6 = c + 6 * cap, *c7 = c + 7 * cap, *c8 = c + 8 * cap, *c9 = c + 9 * cap;
+    const double p0 = p[0], p1 = p[1], p2 = p[2], p3 = p[3], p4 = p[4], p5 = p[5], p6 = p[6], p7 = p[7], p8 = p[8], p9 = p[9];
+    size_t i;
+
+    for (i = begin; i < end; ++i)
+        f[i - begin] = c0[i] * p0 + c1[i] * p1 + c2[i] * p2 + c3[i] * p3 + c4[i] * p4 +
+                       c5[i] * p5 + c6[i] * p6 + c7[i] * p7 + c8[i] * p8 + c9[i] * p9;
+}
+
+/* gathers the low bits of 8 bytes (0 or 1 each) into one byte */
+static uint64_t _cs2_spinquadbank3f_gather8(const unsigned char *b)
+{
+    uint64_t x;
+
+    memcpy(&x, b, sizeof(x));
+
+    return (x * 0x0102040810204080ULL) >> 56;
+}
+
+/* packs signs of one block of 64 values; comparisons vectorize, gathering is a multiply per byte */
+CS2_SIMD_CLONES
+static void _cs2_spinquadbank3f_pack(uint64_t *pos, uint64_t *neg, const double *f)
+{
+    unsigned char bp[CS2_SPINQUADBANK3F_WORD], bn[CS2_SPINQUADBANK3F_WORD];
+    uint64_t mp = 0, mn = 0;
+    int i;
+
+    for (i = 0; i < CS2_SPINQUADBANK3F_WORD; ++i)
+    {
+        bp[i] = f[i] > 0.0;
+        bn[i] = f[i] < 0.0;
+    }
+
+    for (i = 0; i < CS2_SPINQUADBANK3F_WORD / 8; ++i)
+    {
+        mp |= _cs2_spinquadbank3f_gather8(bp + 8 * i) << (8 * i);
+        mn |= _cs2_spinquadbank3f_gather8(bn + 8 * i) << (8 * i);
+    }
+
+    *pos = mp;
+
+    if (neg)
+        *neg = mn;
+}
+
+static void _cs2_spinquadbank3f_sign(uint64_t *pos, uint64_t *neg, const struct cs2_spinquadbank3f_s *b, const double *p)
+{
+    double f[CS2_SPINQUADBANK3F_WORD];
+    size_t w, words = cs2_spinquadbank3f_mask_size(b);
+
+    /* padding is zero, so bits past n are never set */
+    for (w = 0; w < words; ++w)
+    {
+        _cs2_spinquadbank3f_eval_range(f, b->c, b->cap, p, w * CS2_SPINQUADBANK3F_WORD, (w + 1) * CS2_SPINQUADBANK3F_WORD);
+        _cs2_spinquadbank3f_pack(&pos[w], neg ? &neg[w] : NULL, f);
+    }
+}
+
+void cs2_spinquadbank3f_init(struct cs2_spinquadbank3f_s *b)
+{
+    b->c = NULL;
+    b->n = 0;
+    b->cap = 0;
+}
+
+void cs2_spinquadbank3f_clear(struct cs2_spinquadbank3f_s *b)
+{
+    CS2_MEM_FREE(b->c);
+
+    b->c = NULL;
+    b->n = 0;
+    b->cap = 0;
+}
+
+void cs2_spinquadbank3f_reserve(struct cs2_spinquadbank3f_s *b, size_t n)
+{
+    double *c;
+    size_t cap, k;
+
+    if (n <= b->cap)
+        return;
+
+    cap = (n + CS2_SPINQUADBANK3F_WORD - 1) / CS2_SPINQUADBANK3F_WORD * CS2_SPINQUADBANK3F_WORD;
+    c = CS2_MEM_MALLOC_N(double, CS2_SPINQUADBANK3F_COEFFS * cap);
+
+    memset(c, 0, sizeof(double) * CS2_SPINQUADBANK3F_COEFFS * cap);
+
+    for (k = 0; k < CS2_SPINQUADBANK3F_COEFFS && b->n > 0; ++k)
+        memcpy(c + k * cap, b->c + k * b->cap, sizeof(double) * b->n);
+
+    CS2_MEM_FREE(b->c);
+
+    b->c = c;
+    b->cap = cap;
+}
+
+size_t cs2_spinquadbank3f_add(struct cs2_spinquadbank3f_s *b, const struct cs2_spinquad3f_s *sq)
+{
+    size_t i = b->n, cap = b->cap;
+
+    /* geometric growth */
+    if (i == cap)
+        cs2_spinquadbank3f_reserve(b, cap ? 2 * cap : CS2_SPINQUADBANK3F_WORD);
+
+    cap = b->cap;
+
+    b->c[0 * cap + i] = sq->a11;
+    b->c[1 * cap + i] = sq->a22;
+    b->c[2 * cap + i] = sq->a33;
+    b->c[3 * cap + i] = sq->a44;
+    b->c[4 * cap + i] = 2.0 * sq->a12;
+    b->c[5 * cap + i] = 2.0 * sq->a13;
+    b->c[6 * cap + i] = 2.0 * sq->a14;
+    b->c[7 * cap + i] = 2.0 * sq->a23;
+    b->c[8 * cap + i] = 2.0 * sq->a24;
+    b->c[9 * cap + i] = 2.0 * sq->a34;
+
+    ++b->n;
+
+    return i;
+}
+
+void cs2_spinquadbank3f_get(struct cs2_spinquad3f_s *sq, const struct cs2_spinquadbank3f_s *b, size_t i)
+{
+    size_t cap = b->cap;
+
+    CS2_ASSERT_MSG(i < b->n, "index out of range");
+
+    sq->a11 = b->c[0 * cap + i];
+    sq->a22 = b->c[1 * cap + i];
+    sq->a33 = b->c[2 * cap + i];
+    sq->a44 = b->c[3 * cap + i];
+    sq->a12 = 0.5 * b->c[4 * cap + i];
+    sq->a13 = 0.5 * b->c[5 * cap + i];
+    sq->a14 = 0.5 * b->c[6 * cap + i];
+    sq->a23 = 0.5 * b->c[7 * cap + i];
+    sq->a24 = 0.5 * b->c[8 * cap + i];
+    sq->a34 = 0.5 * b->c[9 * cap + i];
+}
+
+size_t cs2_spinquadbank3f_mask_size(const struct cs2_spinquadbank3f_s *b)
+{
+    return (b->n + CS2_SPINQUADBANK3F_WORD - 1) / CS2_SPINQUADBANK3F_WORD;
+}
+
+void cs2_spinquadbank3f_eval(double *f, const struct cs2_spinquadbank3f_s *b, const struct cs2_spin3f_s *s)
+{
+    double p[CS2_SPINQUADBANK3F_COEFFS];
+
+    _cs2_spinquadbank3f_monomials(p, s->s12, s->s23, s->s31, s->s0);
+    _cs2_spinquadbank3f_eval_range(f, b->c, b->cap, p, 0, b->n);
+}
+
+void cs2_spinquadbank3f_sign(uint64_t *pos, uint64_t *neg, const struct cs2_spinquadbank3f_s *b, const struct cs2_spin3f_s *s)
+{
+    double p[CS2_SPINQUADBANK3F_COEFFS];
+
+    _cs2_spinquadbank3f_monomials(p, s->s12, s->s23, s->s31, s->s0);
+    _cs2_spinquadbank3f_sign(pos, neg, b, p);
+}
+
+void cs2_spinquadbank3f_sign_n(uint64_t *pos, uint64_t *neg, const struct cs2_spinquadbank3f_s *b, const double *s12, const double *s23, const double *s31, const double *s0, size_t n)
+{
+    double p[CS2_SPINQUADBANK3F_COEFFS];
+    size_t j, words = cs2_spinquadbank3f_mask_size(b);
+
+    for (j = 0; j < n; ++j)
+    {
+        _cs2_spinquadbank3f_monomials(p, s12[j], s23[j], s31[j], s0[j]);
+        _cs2_spinquadbank3f_sign(pos + j * words, neg ? neg + j * words : NULL, b, p);
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/thread.h"
+#include "cs2/assert.h"
+#include "cs2/mem.h"
+#include <pthread.h>
+#include <unistd.h>
+
+/* upper bound for the number of worker threads */
+#define CS2_THREAD_MAX 256
+
+static int g_thread_count = 0;
+
+struct _cs2_thread_job_s
+{
+    size_t n, grain;
+    size_t next;
+    cs2_thread_range_func_t f;
+    void *d;
+};
+
+static void *_cs2_thread_worker(void *arg)
+{
+    struct _cs2_thread_job_s *job = (struct _cs2_thread_job_s *)arg;
+    size_t begin, end;
+
+    /* dynamic scheduling: idle threads grab the next range */
+    for (;;)
+    {
+        begin = __atomic_fetch_add(&job->next, job->grain, __ATOMIC_RELAXED);
+
+        if (begin >= job->n)
+            break;
+
+        end = job->n - begin < job->grain ? job->n : begin + job->grain;
+        job->f(begin, end, job->d);
+    }
+
+    return NULL;
+}
+
+int cs2_thread_count(void)
+{
+    long count = g_thread_count;
+
+    if (count <= 0)
+        count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (count < 1)
+        count = 1;
+
+    if (count > CS2_THREAD_MAX)
+        count = CS2_THREAD_MAX;
+
+    return (int)count;
+}
+
+void cs2_thread_set_count(int count)
+{
+    CS2_ASSERT_MSG(count >= 0, "invalid thread count");
+
+    g_thread_count = count;
+}
+
+void cs2_thread_parallel_for(size_t n, size_t grain, cs2_thread_range_func_t f, void *d)
+{
+    struct _cs2_thread_job_s job;
+    pthread_t *threads;
+    size_t count, i, started;
+
+    if (n == 0)
+        return;
+
+    if (grain == 0)
+        grain = 1;
+
+    job.n = n;
+    job.grain = grain;
+    job.next = 0;
+    job.f = f;
+    job.d = d;
+
+    /* no more threads than ranges */
+    count = (size_t)cs2_thread_count();
+
+    if (count > (n + grain - 1) / grain)
+        count = (n + grain - 1) / grain;
+
+    /* serial */
+    if (count <= 1)
+    {
+        f(0, n, d);
+        return;
+    }
+
+    threads = CS2_MEM_MALLOC_N(pthread_t, (count - 1));
+
+    /* a failed thread creation only reduces parallelism */
+    for (started = 0; started < count - 1; ++started)
+        if (pthread_create(&threads[started], NULL, _cs2_thread_worker, &job) != 0)
+            break;
+
+    _cs2_thread_worker(&job);
+
+    for (i = 0; i < started; ++i)
+        (void)pthread_join(threads[i], NULL);
+
+    CS2_MEM_FREE(threads);
+}
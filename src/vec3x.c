@@ -23,6 +23,7 @@
  * SOFTWARE.
  */
 #include "cs2/vec3x.h"
+#include "cs2/xctx.h"
 #include "cs2/assert.h"
 
 void cs2_vec3x_init(struct cs2_vec3x_s *v)
@@ -102,8 +103,12 @@ void cs2_vec3x_mul(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcp
 
 void cs2_vec3x_cl(struct cs2_pin3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_vec3x_cl_ctx(v, va, vb, cs2_xctx_thread());
+}
+
+void cs2_vec3x_cl_ctx(struct cs2_pin3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t = cs2_xctx_get_mpz(xc);
     mpz_mul(v->p12, va->x, vb->y);
     mpz_mul(t, va->y, vb->x);
     mpz_sub(v->p12, v->p12, t);
@@ -118,13 +123,17 @@ void cs2_vec3x_cl(struct cs2_pin3x_s *v, const struct cs2_vec3x_s *va, const str
     mpz_add(v->p0, v->p0, t);
     mpz_mul(t, va->z, vb->z);
     mpz_add(v->p0, v->p0, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_mad2(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_vec3x_mad2_ctx(v, va, sa, vb, sb, cs2_xctx_thread());
+}
+
+void cs2_vec3x_mad2_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t = cs2_xctx_get_mpz(xc);
     mpz_mul(v->x, va->x, sa);
     mpz_mul(t, vb->x, sb);
     mpz_add(v->x, v->x, t);
@@ -134,13 +143,17 @@ void cs2_vec3x_mad2(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_src
     mpz_mul(v->z, va->z, sa);
     mpz_mul(t, vb->z, sb);
     mpz_add(v->z, v->z, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_mad3(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_vec3x_mad3_ctx(v, va, sa, vb, sb, vc, sc, cs2_xctx_thread());
+}
+
+void cs2_vec3x_mad3_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t = cs2_xctx_get_mpz(xc);
     mpz_mul(v->x, va->x, sa);
     mpz_mul(t, vb->x, sb);
     mpz_add(v->x, v->x, t);
@@ -156,13 +169,17 @@ void cs2_vec3x_mad3(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_src
     mpz_add(v->z, v->z, t);
     mpz_mul(t, vc->z, sc);
     mpz_add(v->z, v->z, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_mad4(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_vec3x_mad4_ctx(v, va, sa, vb, sb, vc, sc, vd, sd, cs2_xctx_thread());
+}
+
+void cs2_vec3x_mad4_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t = cs2_xctx_get_mpz(xc);
     mpz_mul(v->x, va->x, sa);
     mpz_mul(t, vb->x, sb);
     mpz_add(v->x, v->x, t);
@@ -184,13 +201,17 @@ void cs2_vec3x_mad4(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_src
     mpz_add(v->z, v->z, t);
     mpz_mul(t, vd->z, sd);
     mpz_add(v->z, v->z, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_mad5(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd, const struct cs2_vec3x_s *ve, mpz_srcptr se)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_vec3x_mad5_ctx(v, va, sa, vb, sb, vc, sc, vd, sd, ve, se, cs2_xctx_thread());
+}
+
+void cs2_vec3x_mad5_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_srcptr sa, const struct cs2_vec3x_s *vb, mpz_srcptr sb, const struct cs2_vec3x_s *vc, mpz_srcptr sc, const struct cs2_vec3x_s *vd, mpz_srcptr sd, const struct cs2_vec3x_s *ve, mpz_srcptr se, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t = cs2_xctx_get_mpz(xc);
     mpz_mul(v->x, va->x, sa);
     mpz_mul(t, vb->x, sb);
     mpz_add(v->x, v->x, t);
@@ -218,26 +239,35 @@ void cs2_vec3x_mad5(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, mpz_src
     mpz_add(v->z, v->z, t);
     mpz_mul(t, ve->z, se);
     mpz_add(v->z, v->z, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_dot(mpz_ptr s, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_vec3x_dot_ctx(s, va, vb, cs2_xctx_thread());
+}
+
+void cs2_vec3x_dot_ctx(mpz_ptr s, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t = cs2_xctx_get_mpz(xc);
     mpz_mul(s, va->x, vb->x);
     mpz_mul(t, va->y, vb->y);
     mpz_add(s, s, t);
     mpz_mul(t, va->z, vb->z);
     mpz_add(s, s, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_cross(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb)
 {
+    cs2_vec3x_cross_ctx(v, va, vb, cs2_xctx_thread());
+}
+
+void cs2_vec3x_cross_ctx(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, const struct cs2_vec3x_s *vb, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t;
     CS2_ASSERT(va != vb);
-    mpz_t t;
-    mpz_init(t);
+    t = cs2_xctx_get_mpz(xc);
     mpz_mul(v->x, va->y, vb->z);
     mpz_mul(t, va->z, vb->y);
     mpz_sub(v->x, v->x, t);
@@ -247,19 +277,23 @@ void cs2_vec3x_cross(struct cs2_vec3x_s *v, const struct cs2_vec3x_s *va, const
     mpz_mul(v->z, va->x, vb->y);
     mpz_mul(t, va->y, vb->x);
     mpz_sub(v->z, v->z, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_sqlen(mpz_ptr s, const struct cs2_vec3x_s *v)
 {
-    mpz_t t;
-    mpz_init(t);
+    cs2_vec3x_sqlen_ctx(s, v, cs2_xctx_thread());
+}
+
+void cs2_vec3x_sqlen_ctx(mpz_ptr s, const struct cs2_vec3x_s *v, struct cs2_xctx_s *xc)
+{
+    mpz_ptr t = cs2_xctx_get_mpz(xc);
     mpz_mul(s, v->x, v->x);
     mpz_mul(t, v->y, v->y);
     mpz_add(s, s, t);
     mpz_mul(t, v->z, v->z);
     mpz_add(s, s, t);
-    mpz_clear(t);
+    cs2_xctx_put_mpz(xc, 1);
 }
 
 void cs2_vec3x_tr(mpz_ptr s, const struct cs2_vec3x_s *v)
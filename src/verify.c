@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/verify.h"
+#include "cs2/assert.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#if !defined(CS2_VERIFY_DEFAULT_LEVEL)
+#define CS2_VERIFY_DEFAULT_LEVEL cs2_verify_level_full
+#endif /* !defined(CS2_VERIFY_DEFAULT_LEVEL) */
+
+#if !defined(CS2_VERIFY_DEFAULT_SAMPLE_RATE)
+#define CS2_VERIFY_DEFAULT_SAMPLE_RATE 1024
+#endif /* !defined(CS2_VERIFY_DEFAULT_SAMPLE_RATE) */
+
+static enum cs2_verify_level_e g_verify_level = CS2_VERIFY_DEFAULT_LEVEL;
+static unsigned g_verify_sample_rate = CS2_VERIFY_DEFAULT_SAMPLE_RATE;
+static int g_verify_fatal = 1;
+
+/* stats */
+static uint64_t g_verify_checks = 0;
+static uint64_t g_verify_failures = 0;
+static const char *g_verify_last_file = NULL;
+static int g_verify_last_line = 0;
+
+/* sampling is per thread to avoid contention */
+static __thread unsigned g_verify_countdown = 0;
+
+const char *cs2_verify_level_str(enum cs2_verify_level_e level)
+{
+    switch (level)
+    {
+    case cs2_verify_level_off: return "off";
+    case cs2_verify_level_sampled: return "sampled";
+    case cs2_verify_level_full: return "full";
+
+    /* COUNT */
+    case cs2_verify_level_COUNT: return "invalid";
+    }
+
+    CS2_PANIC_MSG("invalid verify level");
+    return "invalid";
+}
+
+enum cs2_verify_level_e cs2_verify_level(void)
+{
+    return g_verify_level;
+}
+
+void cs2_verify_set_level(enum cs2_verify_level_e level)
+{
+    CS2_ASSERT_MSG(level >= 0 && level < cs2_verify_level_COUNT, "invalid verify level");
+
+    g_verify_level = level;
+}
+
+unsigned cs2_verify_sample_rate(void)
+{
+    return g_verify_sample_rate;
+}
+
+void cs2_verify_set_sample_rate(unsigned rate)
+{
+    CS2_ASSERT_MSG(rate > 0, "invalid sample rate");
+
+    g_verify_sample_rate = rate;
+}
+
+int cs2_verify_fatal(void)
+{
+    return g_verify_fatal;
+}
+
+void cs2_verify_set_fatal(int fatal)
+{
+    g_verify_fatal = fatal;
+}
+
+void cs2_verify_stats(struct cs2_verify_stats_s *stats)
+{
+    stats->checks = __atomic_load_n(&g_verify_checks, __ATOMIC_RELAXED);
+    stats->failures = __atomic_load_n(&g_verify_failures, __ATOMIC_RELAXED);
+    stats->last_file = g_verify_last_file;
+    stats->last_line = g_verify_last_line;
+}
+
+void cs2_verify_reset_stats(void)
+{
+    __atomic_store_n(&g_verify_checks, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_verify_failures, 0, __ATOMIC_RELAXED);
+    g_verify_last_file = NULL;
+    g_verify_last_line = 0;
+}
+
+int cs2_verify_sample(void)
+{
+    switch (g_verify_level)
+    {
+        case cs2_verify_level_off:
+            return 0;
+
+        case cs2_verify_level_sampled:
+            if (g_verify_countdown > 0)
+            {
+                --g_verify_countdown;
+                return 0;
+            }
+
+            g_verify_countdown = g_verify_sample_rate - 1;
+            return 1;
+
+        case cs2_verify_level_full:
+            return 1;
+
+        /* COUNT */
+        case cs2_verify_level_COUNT:
+            break;
+    }
+
+    return 0;
+}
+
+int cs2_verify_check(int value, const char *cond, const char *file, int line, const char *msg, ...)
+{
+    va_list args;
+
+    __atomic_fetch_add(&g_verify_checks, 1, __ATOMIC_RELAXED);
+
+    if (value)
+        return 1;
+
+    __atomic_fetch_add(&g_verify_failures, 1, __ATOMIC_RELAXED);
+    g_verify_last_file = file;
+    g_verify_last_line = line;
+
+    if (!g_verify_fatal)
+        return 0;
+
+    /* same report as a failed assertion */
+    fprintf(stderr, "libcs2: verification '%s' failed at %s:%d with message '", cond, file, line);
+
+    va_start(args, msg);
+    vfprintf(stderr, msg, args);
+    va_end(args);
+
+    fprintf(stderr, "'\n");
+    fflush(stderr);
+
+    cs2_assert(0, cond, file, line);
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/xctx.h"
+#include "cs2/assert.h"
+#include "cs2/mem.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* initial number of temporaries */
+#define CS2_XCTX_INITIAL 16
+
+/* per-thread contexts, destroyed at thread exit (and at process exit for the exiting thread) */
+static pthread_key_t g_xctx_key;
+static pthread_once_t g_xctx_once = PTHREAD_ONCE_INIT;
+static __thread struct cs2_xctx_s *g_xctx = NULL;
+
+static void _cs2_xctx_destroy(void *d)
+{
+    cs2_xctx_clear((struct cs2_xctx_s *)d);
+    CS2_MEM_FREE(d);
+}
+
+static void _cs2_xctx_key_init(void)
+{
+    if (pthread_key_create(&g_xctx_key, _cs2_xctx_destroy) != 0)
+        CS2_PANIC_MSG("failed to create thread key");
+
+    /* key destructors do not run for the thread calling exit (usually main) */
+    if (atexit(cs2_xctx_cleanup) != 0)
+        CS2_PANIC_MSG("failed to register exit handler");
+}
+
+static void _cs2_xctx_grow_mpz(struct cs2_xctx_s *xc)
+{
+    size_t i, cap = xc->zcap ? 2 * xc->zcap : CS2_XCTX_INITIAL;
+    mpz_ptr *z = CS2_MEM_MALLOC_N(mpz_ptr, cap);
+
+    if (xc->zcap > 0)
+        memcpy(z, xc->z, sizeof(mpz_ptr) * xc->zcap);
+
+    /* temporaries never move, pointers handed out stay valid */
+    for (i = xc->zcap; i < cap; ++i)
+    {
+        z[i] = CS2_MEM_MALLOC(__mpz_struct);
+        mpz_init(z[i]);
+    }
+
+    CS2_MEM_FREE(xc->z);
+
+    xc->z = z;
+    xc->zcap = cap;
+}
+
+static void _cs2_xctx_grow_vec3x(struct cs2_xctx_s *xc)
+{
+    size_t i, cap = xc->vcap ? 2 * xc->vcap : CS2_XCTX_INITIAL;
+    struct cs2_vec3x_s **v = CS2_MEM_MALLOC_N(struct cs2_vec3x_s *, cap);
+
+    if (xc->vcap > 0)
+        memcpy(v, xc->v, sizeof(struct cs2_vec3x_s *) * xc->vcap);
+
+    for (i = xc->vcap; i < cap; ++i)
+    {
+        v[i] = CS2_MEM_MALLOC(struct cs2_vec3x_s);
+        cs2_vec3x_init(v[i]);
+    }
+
+    CS2_MEM_FREE(xc->v);
+
+    xc->v = v;
+    xc->vcap = cap;
+}
+
+void cs2_xctx_init(struct cs2_xctx_s *xc)
+{
+    xc->z = NULL;
+    xc->ztop = 0;
+    xc->zcap = 0;
+    xc->v = NULL;
+    xc->vtop = 0;
+    xc->vcap = 0;
+}
+
+void cs2_xctx_clear(struct cs2_xctx_s *xc)
+{
+    size_t i;
+
+    CS2_ASSERT_MSG(xc->ztop == 0 && xc->vtop == 0, "temporaries still in use");
+
+    for (i = 0; i < xc->zcap; ++i)
+    {
+        mpz_clear(xc->z[i]);
+        CS2_MEM_FREE(xc->z[i]);
+    }
+
+    for (i = 0; i < xc->vcap; ++i)
+    {
+        cs2_vec3x_clear(xc->v[i]);
+        CS2_MEM_FREE(xc->v[i]);
+    }
+
+    CS2_MEM_FREE(xc->z);
+    CS2_MEM_FREE(xc->v);
+
+    cs2_xctx_init(xc);
+}
+
+struct cs2_xctx_s *cs2_xctx_thread(void)
+{
+    if (!g_xctx)
+    {
+        (void)pthread_once(&g_xctx_once, _cs2_xctx_key_init);
+
+        g_xctx = CS2_MEM_MALLOC(struct cs2_xctx_s);
+        cs2_xctx_init(g_xctx);
+
+        (void)pthread_setspecific(g_xctx_key, g_xctx);
+    }
+
+    return g_xctx;
+}
+
+void cs2_xctx_cleanup(void)
+{
+    if (!g_xctx)
+        return;
+
+    (void)pthread_setspecific(g_xctx_key, NULL);
+
+    _cs2_xctx_destroy(g_xctx);
+    g_xctx = NULL;
+}
+
+mpz_ptr cs2_xctx_get_mpz(struct cs2_xctx_s *xc)
+{
+    if (xc->ztop == xc->zcap)
+        _cs2_xctx_grow_mpz(xc);
+
+    return xc->z[xc->ztop++];
+}
+
+void cs2_xctx_put_mpz(struct cs2_xctx_s *xc, size_t n)
+{
+    CS2_ASSERT_MSG(n <= xc->ztop, "unbalanced temporaries");
+
+    xc->ztop -= n;
+}
+
+struct cs2_vec3x_s *cs2_xctx_get_vec3x(struct cs2_xctx_s *xc)
+{
+    if (xc->vtop == xc->vcap)
+        _cs2_xctx_grow_vec3x(xc);
+
+    return xc->v[xc->vtop++];
+}
+
+void cs2_xctx_put_vec3x(struct cs2_xctx_s *xc, size_t n)
+{
+    CS2_ASSERT_MSG(n <= xc->vtop, "unbalanced temporaries");
+
+    xc->vtop -= n;
+}
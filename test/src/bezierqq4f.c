@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/bezierqq4f.h"
+#include "test/test.h"
+#include <math.h>
+
+#define EPS (10e-8)
+
+/* a patch along the x = y diagonal, slightly bent in z and w */
+static void diag_coeff(struct cs2_bezierqq4f_coeff_s *c, double dx, double dy)
+{
+    struct cs2_vec4f_s *cc[9] = { &c->c00, &c->c01, &c->c02, &c->c10, &c->c11, &c->c12, &c->c20, &c->c21, &c->c22 };
+    int i, j;
+
+    for (i = 0; i < 3; ++i)
+        for (j = 0; j < 3; ++j)
+            cs2_vec4f_set(cc[3 * i + j], 0.5 * (i + j) + dx, 0.5 * (i + j) + dy, 0.1 * i * j, 0.1 * (i - j) * (i - j));
+}
+
+static int contains(const struct cs2_bezierqq4f_s *b, const struct cs2_vec4f_s *p)
+{
+    struct cs2_vec4f_s d;
+    double x[4] = { p->x, p->y, p->z, p->w }, t;
+    int k;
+
+    /* aabb and diagonal slabs */
+    for (k = 0; k < 4; ++k)
+        if (x[k] < b->kmin[k] - EPS || x[k] > b->kmax[k] + EPS)
+            return 0;
+
+    if (p->x - p->y < b->kmin[5] - EPS || p->x - p->y > b->kmax[5] + EPS)
+        return 0;
+
+    /* sphere */
+    cs2_vec4f_sub(&d, p, &b->sc);
+
+    if (cs2_vec4f_len(&d) > b->sr + EPS)
+        return 0;
+
+    /* oriented box */
+    for (k = 0; k < 4; ++k)
+    {
+        t = cs2_vec4f_dot(p, &b->ox[k]);
+
+        if (t < b->omin[k] - EPS || t > b->omax[k] + EPS)
+            return 0;
+    }
+
+    return 1;
+}
+
+TEST_SUITE(bezierqq4f)
+
+TEST_CASE(bezierqq4f, bv_contains_patch)
+{
+    struct cs2_bezierqq4f_s b;
+    struct cs2_bezierqq4f_coeff_s c;
+    struct cs2_vec4f_s p;
+    int i, j, k;
+
+    diag_coeff(&c, 0.0, 0.0);
+
+    cs2_bezierqq4f_init(&b);
+    cs2_bezierqq4f_from_qq(&b, &c);
+
+    /* the exact hull is not built yet */
+    TEST_ASSERT_TRUE(!b.hv);
+
+    /* oriented box axes are orthonormal */
+    for (i = 0; i < 4; ++i)
+        for (j = 0; j < 4; ++j)
+            TEST_ASSERT_TRUE(fabs(cs2_vec4f_dot(&b.ox[i], &b.ox[j]) - (i == j)) < EPS);
+
+    for (i = 0; i <= 10; ++i)
+    {
+        for (j = 0; j <= 10; ++j)
+        {
+            cs2_bezierqq4f_eval(&p, &b, 0.1 * i, 0.1 * j);
+            TEST_ASSERT_TRUE(contains(&b, &p));
+        }
+    }
+
+    for (k = cs2_bezierbvqq4f_aabb; k < cs2_bezierbvqq4f_COUNT; ++k)
+    {
+        TEST_ASSERT_TRUE(cs2_bezierqq4f_vol(&b, (enum cs2_bezierbvqq4f_e)k) > 0.0);
+        TEST_ASSERT_TRUE(cs2_bezierqq4f_area(&b, (enum cs2_bezierbvqq4f_e)k) > 0.0);
+    }
+
+    TEST_ASSERT_TRUE(!b.hv);
+
+    cs2_bezierqq4f_clear(&b);
+}
+
+TEST_CASE(bezierqq4f, bv_inter)
+{
+    struct cs2_bezierqq4f_s p, q, r;
+    struct cs2_bezierqq4f_coeff_s c;
+    int k;
+
+    cs2_bezierqq4f_init(&p);
+    cs2_bezierqq4f_init(&q);
+    cs2_bezierqq4f_init(&r);
+
+    diag_coeff(&c, 0.0, 0.0);
+    cs2_bezierqq4f_from_qq(&p, &c);
+
+    /* shifted across the diagonal: boxes overlap, diagonal slabs do not */
+    diag_coeff(&c, 1.0, -1.0);
+    cs2_bezierqq4f_from_qq(&q, &c);
+
+    /* far away */
+    diag_coeff(&c, 10.0, 10.0);
+    cs2_bezierqq4f_from_qq(&r, &c);
+
+    TEST_ASSERT_TRUE(cs2_bezierqq4f_inter_bv(&p, &q, cs2_bezierbvqq4f_aabb));
+    TEST_ASSERT_TRUE(!cs2_bezierqq4f_inter_bv(&p, &q, cs2_bezierbvqq4f_kdop));
+
+    for (k = cs2_bezierbvqq4f_aabb; k < cs2_bezierbvqq4f_COUNT; ++k)
+    {
+        TEST_ASSERT_TRUE(!cs2_bezierqq4f_inter_bv(&p, &r, (enum cs2_bezierbvqq4f_e)k));
+        TEST_ASSERT_TRUE(!cs2_bezierqq4f_inter_bv(&r, &p, (enum cs2_bezierbvqq4f_e)k));
+        TEST_ASSERT_TRUE(cs2_bezierqq4f_inter_bv(&p, &p, (enum cs2_bezierbvqq4f_e)k));
+    }
+
+    /* conclusive without the exact hulls */
+    TEST_ASSERT_TRUE(!cs2_bezierqq4f_inter(&p, &q));
+    TEST_ASSERT_TRUE(!cs2_bezierqq4f_inter(&p, &r));
+    TEST_ASSERT_TRUE(!p.hv && !q.hv && !r.hv);
+
+    cs2_bezierqq4f_clear(&p);
+    cs2_bezierqq4f_clear(&q);
+    cs2_bezierqq4f_clear(&r);
+}
+
+TEST_CASE(bezierqq4f, flatness)
+{
+    struct cs2_bezierqq4f_s b;
+    struct cs2_vec4f_s p[9];
+    int i, j;
+
+    cs2_bezierqq4f_init(&b);
+
+    /* a bilinear net is flat */
+    for (i = 0; i < 3; ++i)
+        for (j = 0; j < 3; ++j)
+            cs2_vec4f_set(&p[3 * i + j], 0.5 * i, 0.5 * j, 0.1 * i * j, 1.0);
+
+    cs2_bezierqq4f_from_cp(&b, p);
+
+    TEST_ASSERT_TRUE(fabs(cs2_bezierqq4f_flatness(&b)) < EPS);
+
+    /* lifting the center lifts the flatness by the same distance */
+    p[4].w += 0.25;
+    cs2_bezierqq4f_from_cp(&b, p);
+
+    TEST_ASSERT_TRUE(fabs(cs2_bezierqq4f_flatness(&b) - 0.25) < EPS);
+    TEST_ASSERT_TRUE(!b.hv);
+
+    cs2_bezierqq4f_clear(&b);
+}
+
+TEST_CASE(bezierqq4f, hull_vol)
+{
+    struct cs2_bezierqq4f_s b, e;
+    struct cs2_vec4f_s p[9];
+    double vol, area;
+    int i;
+
+    /* a bent net */
+    for (i = 0; i < 9; ++i)
+        cs2_vec4f_set(&p[i], 0.5 * (i / 3), 0.5 * (i % 3), 0.1 * (i / 3) * (i % 3), 0.1 * (i / 3 - i % 3) * (i / 3 - i % 3) + 0.05 * (i == 4));
+
+    cs2_bezierqq4f_init(&b);
+    cs2_bezierqq4f_from_cp(&b, p);
+
+    /* the volume alone does not build the hull */
+    vol = cs2_bezierqq4f_vol(&b, cs2_bezierbvqq4f_hull);
+    area = cs2_bezierqq4f_area(&b, cs2_bezierbvqq4f_hull);
+
+    TEST_ASSERT_TRUE(vol > 0.0 && area > 0.0);
+    TEST_ASSERT_TRUE(b.hm && !b.hv);
+
+    /* the hull built on demand agrees */
+    TEST_ASSERT_TRUE(fabs(cs2_bezierqq4f_hull(&b)->vol - vol) < EPS);
+    TEST_ASSERT_TRUE(fabs(cs2_bezierqq4f_hull(&b)->area - area) < EPS);
+
+    /* new control points are measured again */
+    p[4].w += 0.5;
+    cs2_bezierqq4f_from_cp(&b, p);
+
+    TEST_ASSERT_TRUE(!b.hm && !b.hv);
+    TEST_ASSERT_TRUE(cs2_bezierqq4f_vol(&b, cs2_bezierbvqq4f_hull) > vol);
+
+    /* overlapping patches: the read-only test builds temporary hulls, the lazy one keeps them */
+    cs2_bezierqq4f_init(&e);
+    cs2_bezierqq4f_from_cp(&e, p);
+
+    TEST_ASSERT_TRUE(cs2_bezierqq4f_inter(&b, &e));
+    TEST_ASSERT_TRUE(!b.hv && !e.hv);
+
+    TEST_ASSERT_TRUE(cs2_bezierqq4f_inter_lazy(&b, &e));
+    TEST_ASSERT_TRUE(b.hv && e.hv && cs2_bezierqq4f_inter(&b, &e));
+
+    cs2_bezierqq4f_clear(&e);
+    cs2_bezierqq4f_clear(&b);
+}
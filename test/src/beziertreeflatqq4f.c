@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/beziertreeflatqq4f.h"
+#include "cs2/predg3f.h"
+#include "cs2/rand.h"
+#include "test/test.h"
+#include <math.h>
+
+#define EPS (10e-8)
+#define test_almost_equal(x, y) TEST_ASSERT_TRUE(fabs((x) - (y)) < EPS)
+
+struct predbb_func_s
+{
+    struct cs2_predg3f_s p;
+    struct cs2_predgparam3f_s pp;
+};
+
+static void predbb_func(struct cs2_vec4f_s *r, double u, double v, void *data)
+{
+    struct predbb_func_s *f = (struct predbb_func_s *)data;
+    struct cs2_spin3f_s s;
+    cs2_predgparam3f_eval(&s, &f->pp, u, v, 0);
+    r->x = s.s12;
+    r->y = s.s23;
+    r->z = s.s31;
+    r->w = s.s0;
+}
+
+static void create_z_barrel(struct cs2_predg3f_s *p)
+{
+    /* an example z-barrel */
+    cs2_vec3f_set(&p->k, 1.0, 1.0, 1.0);
+    cs2_vec3f_set(&p->l, 1.0, 0.0, 2.0);
+    cs2_vec3f_set(&p->a, 0.0, 1.0, 1.0);
+    cs2_vec3f_set(&p->b, 0.0, 2.0, 1.0);
+    p->c = 0.5;
+}
+
+static struct cs2_beziertreenodeqq4f_s *locate(struct cs2_beziertreenodeqq4f_s *n, double u, double v)
+{
+    while (!cs2_beziertreenodeqq4f_is_leaf(n))
+        n = n->c[u >= n->u1][v >= n->v1];
+
+    return n;
+}
+
+TEST_SUITE(beziertreeflatqq4f)
+
+TEST_CASE(beziertreeflatqq4f, from_tree)
+{
+    struct cs2_beziertreeqq4f_s t;
+    struct cs2_beziertreeleafsqq4f_s l;
+    struct cs2_beziertreeleafqq4f_s *ll;
+    struct cs2_beziertreeflatqq4f_s fl;
+    struct cs2_beziertreenodeqq4f_s *n;
+    struct cs2_vec4f_s a, b;
+    struct predbb_func_s f;
+    struct cs2_rand_s r;
+    double u, v;
+    uint32_t i, c;
+    size_t leaves;
+    int k;
+
+    create_z_barrel(&f.p);
+
+    cs2_predg3f_param(&f.pp, &f.p);
+
+    cs2_beziertreeqq4f_init(&t);
+    cs2_beziertreeqq4f_from_func(&t, &predbb_func, &f);
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.001);
+
+    cs2_beziertreeflatqq4f_init(&fl);
+    cs2_beziertreeflatqq4f_from_tree(&fl, &t);
+
+    TEST_ASSERT_TRUE(fl.n == t.np.count);
+    TEST_ASSERT_TRUE(cs2_beziertreeflatqq4f_vol(&fl, 0) == cs2_beziertreeqq4f_vol(&t));
+
+    /* topology */
+    leaves = 0;
+
+    for (i = 0; i < fl.n; ++i)
+    {
+        if (cs2_beziertreeflatqq4f_is_leaf(&fl, i))
+        {
+            ++leaves;
+            continue;
+        }
+
+        for (k = 0; k < 4; ++k)
+        {
+            c = cs2_beziertreeflatqq4f_child(&fl, i, k);
+
+            TEST_ASSERT_TRUE(c > i && c < fl.n);
+            TEST_ASSERT_TRUE(cs2_beziertreeflatqq4f_parent(&fl, c) == i);
+            TEST_ASSERT_TRUE(fl.u0[c] == (k / 2 ? 0.5 * (fl.u0[i] + fl.u2[i]) : fl.u0[i]));
+            TEST_ASSERT_TRUE(fl.v0[c] == (k % 2 ? 0.5 * (fl.v0[i] + fl.v2[i]) : fl.v0[i]));
+        }
+    }
+
+    TEST_ASSERT_TRUE(leaves == l.c);
+
+    /* hulls of all patches are pooled, but not kept on the tree */
+    for (i = 1; i < fl.n; ++i)
+        TEST_ASSERT_TRUE(fl.ho[i + 1] > fl.ho[i] && fl.vo[i + 1] > fl.vo[i]);
+
+    for (ll = l.l; ll; ll = ll->next)
+        TEST_ASSERT_TRUE(!ll->n->b.hv);
+
+    /* point location and evaluation */
+    cs2_rand_seed(&r);
+
+    for (k = 0; k < 1000; ++k)
+    {
+        u = cs2_rand_u1f(&r, 0.0, 1.0);
+        v = cs2_rand_u1f(&r, 0.0, 1.0);
+
+        i = cs2_beziertreeflatqq4f_locate(&fl, u, v);
+        n = locate(t.rn, u, v);
+
+        TEST_ASSERT_TRUE(fl.u0[i] == n->u0 && fl.v0[i] == n->v0 && fl.u2[i] == n->u2 && fl.v2[i] == n->v2);
+        TEST_ASSERT_TRUE(fl.u0[i] <= u && u <= fl.u2[i] && fl.v0[i] <= v && v <= fl.v2[i]);
+
+        cs2_beziertreeflatqq4f_eval(&a, &fl, i, u, v);
+        cs2_bezierqq4f_eval(&b, &n->b, (u - n->u0) / (n->u2 - n->u0), (v - n->v0) / (n->v2 - n->v0));
+
+        test_almost_equal(a.x, b.x);
+        test_almost_equal(a.y, b.y);
+        test_almost_equal(a.z, b.z);
+        test_almost_equal(a.w, b.w);
+    }
+
+    /* clear */
+    cs2_beziertreeflatqq4f_clear(&fl);
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+TEST_CASE(beziertreeflatqq4f, inter)
+{
+    struct cs2_beziertreeqq4f_s ta, tb;
+    struct cs2_beziertreeleafsqq4f_s la, lb;
+    struct cs2_beziertreeflatqq4f_s fa, fb;
+    struct cs2_beziertreepairsqq4f_s ps;
+    struct cs2_beziertreeflatpairsqq4f_s fps;
+    struct predbb_func_s f, g;
+    uint32_t a, b;
+    size_t i, j, found;
+
+    create_z_barrel(&f.p);
+    create_z_barrel(&g.p);
+    cs2_vec3f_set(&g.p.a, 1.0, 1.0, 0.0);
+
+    cs2_predg3f_param(&f.pp, &f.p);
+    cs2_predg3f_param(&g.pp, &g.p);
+
+    cs2_beziertreeqq4f_init(&ta);
+    cs2_beziertreeqq4f_from_func(&ta, &predbb_func, &f);
+    cs2_beziertreeleafsqq4f_init(&la, &ta);
+    cs2_beziertreeleafsqq4f_sub_vol(&la, 0.001);
+
+    cs2_beziertreeqq4f_init(&tb);
+    cs2_beziertreeqq4f_from_func(&tb, &predbb_func, &g);
+    cs2_beziertreeleafsqq4f_init(&lb, &tb);
+    cs2_beziertreeleafsqq4f_sub_vol(&lb, 0.001);
+
+    /* live traversal on refined trees does not split */
+    cs2_beziertreepairsqq4f_init(&ps);
+    cs2_beziertreeqq4f_inter(&ps, &ta, &tb, 0.001, 0);
+
+    cs2_beziertreeflatqq4f_init(&fa);
+    cs2_beziertreeflatqq4f_from_tree(&fa, &ta);
+    cs2_beziertreeflatqq4f_init(&fb);
+    cs2_beziertreeflatqq4f_from_tree(&fb, &tb);
+
+    cs2_beziertreeflatpairsqq4f_init(&fps);
+    cs2_beziertreeflatqq4f_inter(&fps, &fa, &fb);
+
+    /* flat pairs are leaves, and a superset of the live pairs (which also test oriented boxes) */
+    TEST_ASSERT_TRUE(fps.n >= ps.n && fps.n < la.c * lb.c);
+
+    for (j = 0; j < fps.n; ++j)
+        TEST_ASSERT_TRUE(cs2_beziertreeflatqq4f_is_leaf(&fa, fps.p[j].a) && cs2_beziertreeflatqq4f_is_leaf(&fb, fps.p[j].b));
+
+    for (i = 0; i < ps.n; ++i)
+    {
+        a = cs2_beziertreeflatqq4f_locate(&fa, ps.p[i].a->u1, ps.p[i].a->v1);
+        b = cs2_beziertreeflatqq4f_locate(&fb, ps.p[i].b->u1, ps.p[i].b->v1);
+        found = 0;
+
+        for (j = 0; j < fps.n; ++j)
+            found += fps.p[j].a == a && fps.p[j].b == b;
+
+        TEST_ASSERT_TRUE(found == 1);
+    }
+
+    /* clear */
+    cs2_beziertreeflatpairsqq4f_clear(&fps);
+    cs2_beziertreepairsqq4f_clear(&ps);
+    cs2_beziertreeflatqq4f_clear(&fa);
+    cs2_beziertreeflatqq4f_clear(&fb);
+    cs2_beziertreeleafsqq4f_clear(&la);
+    cs2_beziertreeleafsqq4f_clear(&lb);
+    cs2_beziertreeqq4f_clear(&ta);
+    cs2_beziertreeqq4f_clear(&tb);
+}
@@ -24,8 +24,14 @@
  */
 #include "cs2/beziertreeqq4f.h"
 #include "cs2/predg3f.h"
+#include "cs2/thread.h"
 #include "test/test.h"
 #include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
 
 #define EPS (10e-8)
 #define test_almost_equal(x, y) TEST_ASSERT_TRUE(fabs((x) - (y)) < EPS)
@@ -47,6 +53,19 @@ static void predbb_func(struct cs2_vec4f_s *r, double u, double v, void *data)
     r->w = s.s0;
 }
 
+struct counted_func_s
+{
+    struct predbb_func_s f;
+    size_t calls;
+};
+
+static void counted_func(struct cs2_vec4f_s *r, double u, double v, void *data)
+{
+    struct counted_func_s *f = (struct counted_func_s *)data;
+    ++f->calls;
+    predbb_func(r, u, v, &f->f);
+}
+
 static void create_z_barrel(struct cs2_predg3f_s *p)
 {
     /* an example z-barrel */
@@ -137,6 +156,854 @@ TEST_CASE(beziertreeqq4f, sub_vol)
 
     TEST_ASSERT_TRUE(pc == tc);
 
+    /* leaf entries come from the tree pool */
+    TEST_ASSERT_TRUE(t.lp.count == tc);
+
+    cs2_beziertreeleafsqq4f_clear(&l);
+
+    TEST_ASSERT_TRUE(t.lp.count == 0);
+
+    /* clear */
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+TEST_CASE(beziertreeqq4f, sub_vol_par)
+{
+    struct cs2_beziertreeqq4f_s t, tp;
+    struct cs2_beziertreeleafsqq4f_s l, lp;
+    struct cs2_beziertreeleafqq4f_s *ll, *llp;
+    struct predbb_func_s f;
+    int count = cs2_thread_count();
+
+    create_z_barrel(&f.p);
+
+    cs2_predg3f_param(&f.pp, &f.p);
+
+    /* serial and parallel refinement */
+    cs2_beziertreeqq4f_init(&t);
+    cs2_beziertreeqq4f_from_func(&t, &predbb_func, &f);
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.001);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.0001);
+
+    cs2_thread_set_count(4);
+
+    cs2_beziertreeqq4f_init(&tp);
+    cs2_beziertreeqq4f_from_func(&tp, &predbb_func, &f);
+    cs2_beziertreeleafsqq4f_init(&lp, &tp);
+    cs2_beziertreeleafsqq4f_sub_vol_par(&lp, 0.001);
+    cs2_beziertreeleafsqq4f_sub_vol_par(&lp, 0.0001);
+
+    cs2_thread_set_count(count);
+
+    /* identical leaves in identical order */
+    TEST_ASSERT_TRUE(l.c == lp.c);
+
+    for (ll = l.l, llp = lp.l; ll && llp; ll = ll->next, llp = llp->next)
+    {
+        TEST_ASSERT_TRUE(ll->n->u0 == llp->n->u0 && ll->n->u2 == llp->n->u2);
+        TEST_ASSERT_TRUE(ll->n->v0 == llp->n->v0 && ll->n->v2 == llp->n->v2);
+        TEST_ASSERT_TRUE(ll->n->vol == llp->n->vol);
+    }
+
+    TEST_ASSERT_TRUE(!ll && !llp);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_vol(&t) == cs2_beziertreeqq4f_vol(&tp));
+
+    /* clear */
+    cs2_beziertreeleafsqq4f_clear(&lp);
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&tp);
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+static double area_prio(const struct cs2_beziertreenodeqq4f_s *n, void *d)
+{
+    (void)d;
+    return n->area;
+}
+
+static double zero_prio(const struct cs2_beziertreenodeqq4f_s *n, void *d)
+{
+    (void)n;
+    (void)d;
+    return 0.0;
+}
+
+TEST_CASE(beziertreeqq4f, refine)
+{
+    struct cs2_beziertreeqq4f_s t, tr;
+    struct cs2_beziertreeleafsqq4f_s l, lr;
+    struct cs2_beziertreeleafqq4f_s *ll, *llr;
+    struct cs2_beziertreerefineqq4f_s r;
+    struct cs2_beziertreebudgetqq4f_s b;
+    struct predbb_func_s f;
+    double top;
+
+    create_z_barrel(&f.p);
+
+    cs2_predg3f_param(&f.pp, &f.p);
+
+    /* threshold refinement */
+    cs2_beziertreeqq4f_init(&t);
+    cs2_beziertreeqq4f_from_func(&t, &predbb_func, &f);
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.0001);
+
+    /* budgeted refinement, resumed in steps */
+    cs2_beziertreeqq4f_init(&tr);
+    cs2_beziertreeqq4f_from_func(&tr, &predbb_func, &f);
+    cs2_beziertreeleafsqq4f_init(&lr, &tr);
+    cs2_beziertreerefineqq4f_init(&r, &lr, NULL, NULL);
+
+    memset(&b, 0, sizeof(b));
+    b.leaves = 40;
+
+    TEST_ASSERT_TRUE(cs2_beziertreerefineqq4f_run(&r, &b) > 0);
+    TEST_ASSERT_TRUE(lr.c <= 40 && lr.c + 3 > 40);
+
+    /* nothing left within the budget */
+    TEST_ASSERT_TRUE(cs2_beziertreerefineqq4f_run(&r, &b) == 0);
+
+    /* largest leaves are split first */
+    top = cs2_beziertreerefineqq4f_top(&r);
+
+    for (ll = lr.l; ll; ll = ll->next)
+        TEST_ASSERT_TRUE(ll->n->vol <= top);
+
+    /* resume down to the threshold: same leaves as threshold refinement */
+    b.leaves = 0;
+    b.prio = 0.0001;
+
+    cs2_beziertreerefineqq4f_run(&r, &b);
+
+    TEST_ASSERT_TRUE(l.c == lr.c);
+
+    for (ll = l.l, llr = lr.l; ll && llr; ll = ll->next, llr = llr->next)
+        TEST_ASSERT_TRUE(ll->n->u0 == llr->n->u0 && ll->n->v0 == llr->n->v0 && ll->n->u2 == llr->n->u2 && ll->n->v2 == llr->n->v2);
+
+    TEST_ASSERT_TRUE(!ll && !llr);
+
+    cs2_beziertreerefineqq4f_clear(&r);
+
+    /* memory budget and a custom priority */
+    cs2_beziertreerefineqq4f_init(&r, &lr, area_prio, NULL);
+
+    memset(&b, 0, sizeof(b));
+    b.prio = -INFINITY;
+    b.bytes = cs2_beziertreeqq4f_bytes(&tr) + 65536;
+
+    TEST_ASSERT_TRUE(cs2_beziertreerefineqq4f_run(&r, &b) > 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_bytes(&tr) <= b.bytes);
+
+    /* time budget, at least one split */
+    memset(&b, 0, sizeof(b));
+    b.prio = -INFINITY;
+    b.usec = 1;
+
+    TEST_ASSERT_TRUE(cs2_beziertreerefineqq4f_run(&r, &b) >= 1);
+
+    cs2_beziertreerefineqq4f_clear(&r);
+
+    /* a zero threshold is a threshold, no threshold splits leaves of zero priority too */
+    cs2_beziertreerefineqq4f_init(&r, &lr, zero_prio, NULL);
+
+    memset(&b, 0, sizeof(b));
+    b.leaves = lr.c + 12;
+
+    TEST_ASSERT_TRUE(cs2_beziertreerefineqq4f_run(&r, &b) == 0);
+
+    b.prio = -INFINITY;
+
+    TEST_ASSERT_TRUE(cs2_beziertreerefineqq4f_run(&r, &b) == 4);
+
+    /* clear */
+    cs2_beziertreerefineqq4f_clear(&r);
+    cs2_beziertreeleafsqq4f_clear(&lr);
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&tr);
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+TEST_CASE(beziertreeqq4f, sample_cache)
+{
+    struct cs2_beziertreeqq4f_s t;
+    struct cs2_beziertreeleafsqq4f_s l;
+    struct cs2_beziertreeleafqq4f_s *ll;
+    struct counted_func_s f;
+    struct cs2_bezierqq4f_coeff_s c;
+    struct cs2_bezierqq4f_s b;
+    struct cs2_vec4f_s pa[9], pb[9];
+    size_t hits, misses, bytes, calls;
+
+    create_z_barrel(&f.f.p);
+
+    cs2_predg3f_param(&f.f.pp, &f.f.p);
+    f.calls = 0;
+
+    cs2_beziertreeqq4f_init(&t);
+    cs2_beziertreeqq4f_from_func(&t, &counted_func, &f);
+
+    /* first level subdivision: 4 x 9 control samples on a 5 x 5 grid */
+    cs2_beziertreenodeqq4f_sub(t.rn);
+    cs2_beziertreeqq4f_cache_stats(&t, &hits, &misses);
+
+    TEST_ASSERT_TRUE(f.calls == 25);
+    TEST_ASSERT_TRUE(misses == 25 && hits == 11);
+
+    /* second level subdivision of one child: 9 x 9 grid, 5 x 5 of it already known */
+    cs2_beziertreenodeqq4f_sub(t.rn->c[0][0]);
+
+    TEST_ASSERT_TRUE(f.calls == 25 + 16);
+
+    /* cached samples are exact */
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.001);
+
+    for (ll = l.l; ll; ll = ll->next)
+    {
+        predbb_func(&c.c00, ll->n->u0, ll->n->v0, &f.f);
+        predbb_func(&c.c01, ll->n->u0, ll->n->v1, &f.f);
+        predbb_func(&c.c02, ll->n->u0, ll->n->v2, &f.f);
+        predbb_func(&c.c10, ll->n->u1, ll->n->v0, &f.f);
+        predbb_func(&c.c11, ll->n->u1, ll->n->v1, &f.f);
+        predbb_func(&c.c12, ll->n->u1, ll->n->v2, &f.f);
+        predbb_func(&c.c20, ll->n->u2, ll->n->v0, &f.f);
+        predbb_func(&c.c21, ll->n->u2, ll->n->v1, &f.f);
+        predbb_func(&c.c22, ll->n->u2, ll->n->v2, &f.f);
+
+        cs2_bezierqq4f_init(&b);
+        cs2_bezierqq4f_from_qq(&b, &c);
+
+        cs2_bezierqq4f_cp(pa, &b);
+        cs2_bezierqq4f_cp(pb, &ll->n->b);
+
+        TEST_ASSERT_TRUE(memcmp(pa, pb, sizeof(pa)) == 0);
+
+        cs2_bezierqq4f_clear(&b);
+    }
+
+    cs2_beziertreeqq4f_cache_stats(&t, &hits, &misses);
+
+    TEST_ASSERT_TRUE(misses == f.calls && hits > misses);
+
+    /* a dropped cache frees its samples, refinement evaluates them again */
+    bytes = cs2_beziertreeqq4f_bytes(&t);
+    calls = f.calls;
+    cs2_beziertreeqq4f_drop_cache(&t);
+
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_bytes(&t) < bytes);
+
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.0005);
+    cs2_beziertreeqq4f_cache_stats(&t, &hits, &misses);
+
+    TEST_ASSERT_TRUE(f.calls > calls && misses == f.calls);
+
+    /* clear */
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+TEST_CASE(beziertreeqq4f, bv_aabb)
+{
+    struct cs2_beziertreeqq4f_s t;
+    struct cs2_beziertreeleafsqq4f_s l;
+    struct cs2_beziertreeleafqq4f_s *ll;
+    struct predbb_func_s f;
+    double vol;
+
+    create_z_barrel(&f.p);
+
+    cs2_predg3f_param(&f.pp, &f.p);
+
+    /* refine by box volume, no exact hulls */
+    cs2_beziertreeqq4f_init(&t);
+    t.bv = cs2_bezierbvqq4f_aabb;
+    cs2_beziertreeqq4f_from_func(&t, &predbb_func, &f);
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.001);
+
+    vol = 0.0;
+
+    for (ll = l.l; ll; ll = ll->next)
+    {
+        TEST_ASSERT_TRUE(!ll->n->b.hv);
+        TEST_ASSERT_TRUE(ll->n->vol <= 0.001);
+        test_almost_equal(ll->n->vol, cs2_bezierqq4f_vol(&ll->n->b, cs2_bezierbvqq4f_aabb));
+
+        vol += ll->n->vol;
+    }
+
+    test_almost_equal(cs2_beziertreeqq4f_vol(&t), vol);
+
+    /* clear */
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+static int pair_cmp(const void *a, const void *b)
+{
+    const struct cs2_beziertreepairqq4f_s *pa = (const struct cs2_beziertreepairqq4f_s *)a;
+    const struct cs2_beziertreepairqq4f_s *pb = (const struct cs2_beziertreepairqq4f_s *)b;
+    double ka[4] = { pa->a->u0, pa->a->v0, pa->b->u0, pa->b->v0 };
+    double kb[4] = { pb->a->u0, pb->a->v0, pb->b->u0, pb->b->v0 };
+    int i;
+
+    for (i = 0; i < 4; ++i)
+        if (ka[i] != kb[i])
+            return ka[i] < kb[i] ? -1 : 1;
+
+    return 0;
+}
+
+static int same_node(const struct cs2_beziertreenodeqq4f_s *a, const struct cs2_beziertreenodeqq4f_s *b)
+{
+    return a->u0 == b->u0 && a->v0 == b->v0 && a->u2 == b->u2 && a->v2 == b->v2;
+}
+
+TEST_CASE(beziertreeqq4f, inter)
+{
+    struct cs2_beziertreeqq4f_s ta, tb, tc;
+    struct cs2_beziertreeleafsqq4f_s la, lb;
+    struct cs2_beziertreeleafqq4f_s *lla;
+    struct cs2_beziertreepairsqq4f_s ps, pp;
+    struct predbb_func_s fa, fb;
+    size_t i, j, found;
+    int count = cs2_thread_count();
+
+    create_z_barrel(&fa.p);
+    create_z_barrel(&fb.p);
+    cs2_vec3f_set(&fb.p.a, 1.0, 1.0, 0.0);
+
+    cs2_predg3f_param(&fa.pp, &fa.p);
+    cs2_predg3f_param(&fb.pp, &fb.p);
+
+    /* lazy descent */
+    cs2_beziertreeqq4f_init(&ta);
+    cs2_beziertreeqq4f_from_func(&ta, &predbb_func, &fa);
+    cs2_beziertreeqq4f_init(&tb);
+    cs2_beziertreeqq4f_from_func(&tb, &predbb_func, &fb);
+
+    cs2_beziertreepairsqq4f_init(&ps);
+    cs2_beziertreeqq4f_inter(&ps, &ta, &tb, 0.001, 0);
+
+    /* hulls built by the query are counted */
+    TEST_ASSERT_TRUE(ta.hb > 0 && cs2_beziertreeqq4f_bytes(&ta) > ta.np.count * ta.np.size + ta.hb);
+
+    /* brute force over fully refined leaves */
+    cs2_beziertreeleafsqq4f_init(&la, &ta);
+    cs2_beziertreeleafsqq4f_sub_vol(&la, 0.001);
+    cs2_beziertreeleafsqq4f_init(&lb, &tb);
+    cs2_beziertreeleafsqq4f_sub_vol(&lb, 0.001);
+
+    /* every candidate is a pair of intersecting leaves */
+    for (i = 0; i < ps.n; ++i)
+    {
+        TEST_ASSERT_TRUE(cs2_beziertreenodeqq4f_is_leaf(ps.p[i].a) && ps.p[i].a->vol <= 0.001);
+        TEST_ASSERT_TRUE(cs2_beziertreenodeqq4f_is_leaf(ps.p[i].b) && ps.p[i].b->vol <= 0.001);
+        TEST_ASSERT_TRUE(ps.p[i].a->r == &ta && ps.p[i].b->r == &tb);
+        TEST_ASSERT_TRUE(cs2_bezierqq4f_inter(&ps.p[i].a->b, &ps.p[i].b->b));
+    }
+
+    /* and pruning is effective */
+    TEST_ASSERT_TRUE(ps.n > 0 && ps.n < la.c * lb.c);
+
+    /* self intersection contains all diagonal pairs */
+    cs2_beziertreepairsqq4f_init(&pp);
+    cs2_beziertreeqq4f_inter(&pp, &ta, &ta, 0.001, 0);
+
+    for (lla = la.l; lla; lla = lla->next)
+    {
+        found = 0;
+
+        for (j = 0; j < pp.n; ++j)
+            found += pp.p[j].a == lla->n && pp.p[j].b == lla->n;
+
+        TEST_ASSERT_TRUE(found == 1);
+    }
+
+    cs2_beziertreepairsqq4f_clear(&pp);
+
+    /* parallel descent of a fresh tree gives the same pairs */
+    cs2_thread_set_count(4);
+
+    cs2_beziertreeqq4f_init(&tc);
+    cs2_beziertreeqq4f_from_func(&tc, &predbb_func, &fa);
+
+    cs2_beziertreepairsqq4f_init(&pp);
+    cs2_beziertreeqq4f_inter(&pp, &tc, &tb, 0.001, 1);
+
+    cs2_thread_set_count(count);
+
+    TEST_ASSERT_TRUE(pp.n == ps.n);
+
+    qsort(ps.p, ps.n, sizeof(struct cs2_beziertreepairqq4f_s), pair_cmp);
+    qsort(pp.p, pp.n, sizeof(struct cs2_beziertreepairqq4f_s), pair_cmp);
+
+    for (i = 0; i < ps.n && i < pp.n; ++i)
+        TEST_ASSERT_TRUE(same_node(ps.p[i].a, pp.p[i].a) && same_node(ps.p[i].b, pp.p[i].b));
+
     /* clear */
+    cs2_beziertreepairsqq4f_clear(&pp);
+    cs2_beziertreepairsqq4f_clear(&ps);
+    cs2_beziertreeleafsqq4f_clear(&la);
+    cs2_beziertreeleafsqq4f_clear(&lb);
+    cs2_beziertreeqq4f_clear(&ta);
+    cs2_beziertreeqq4f_clear(&tb);
+    cs2_beziertreeqq4f_clear(&tc);
+}
+
+/* overwrites a node field of an image file */
+static int patch_img(const char *path, size_t i, size_t off, uint32_t v)
+{
+    FILE *f;
+    int ok;
+
+    f = fopen(path, "r+b");
+
+    if (!f)
+        return -1;
+
+    ok = fseek(f, (long)(sizeof(struct cs2_beziertreeimghdrqq4f_s) + sizeof(struct cs2_beziertreeimgnodeqq4f_s) * i + off), SEEK_SET) == 0 &&
+         fwrite(&v, sizeof(v), 1, f) == 1;
+
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+/* writes an image of a chain of 'd' split nodes (without hulls) with the header of an image file */
+static int chain_img(const char *path, const char *src, size_t d)
+{
+    struct cs2_beziertreeimghdrqq4f_s h;
+    struct cs2_beziertreeimgnodeqq4f_s n;
+    FILE *f;
+    size_t i;
+    int ok, k;
+
+    f = fopen(src, "rb");
+
+    if (!f)
+        return -1;
+
+    ok = fread(&h, sizeof(h), 1, f) == 1;
+
+    if (fclose(f) != 0 || !ok)
+        return -1;
+
+    /* node 4 i is split into 4 i + 1, ..., 4 i + 4 */
+    h.nn = 4 * d + 1;
+    h.np = h.nv = 0;
+    h.op = h.ov = h.size = h.on + sizeof(n) * h.nn;
+
+    f = fopen(path, "wb");
+
+    if (!f)
+        return -1;
+
+    ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+    for (i = 0; i < h.nn; ++i)
+    {
+        memset(&n, 0, sizeof(n));
+
+        for (k = 0; k < 4; ++k)
+            n.c[k] = (i % 4 == 0 && i < 4 * d) ? (uint32_t)(i + 1 + k) : CS2_BEZIERTREEIMGQQ4F_NONE;
+
+        n.p = i == 0 ? CS2_BEZIERTREEIMGQQ4F_NONE : (uint32_t)((i - 1) / 4 * 4);
+        ok = ok && fwrite(&n, sizeof(n), 1, f) == 1;
+    }
+
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+TEST_CASE(beziertreeqq4f, img)
+{
+    struct cs2_beziertreeqq4f_s t, tl;
+    struct cs2_beziertreeleafsqq4f_s l, lt, ll;
+    struct cs2_beziertreeleafqq4f_s *la, *lb;
+    struct cs2_beziertreeimgqq4f_s img;
+    struct cs2_hull4f_s h;
+    const struct cs2_hull4f_s *hc;
+    struct cs2_vec4f_s pa[9], pb[9];
+    struct counted_func_s f;
+    uint64_t key;
+    char path[64], deep[80];
+    uint32_t c;
+    size_t i;
+
+    create_z_barrel(&f.f.p);
+
+    cs2_predg3f_param(&f.f.pp, &f.f.p);
+    f.calls = 0;
+
+    key = cs2_beziertreeimgqq4f_key(&f.f.p, sizeof(f.f.p), 0);
+
+    sprintf(path, "/tmp/cs2_beziertreeqq4f_%ld.img", (long)getpid());
+
+    /* save a refined tree */
+    cs2_beziertreeqq4f_init(&t);
+    cs2_beziertreeqq4f_from_func(&t, &counted_func, &f);
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.001);
+
+    /* hulls are built by save, but not kept on the tree */
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_save(&t, path, key) == 0);
+
+    /* key must match */
+    cs2_beziertreeimgqq4f_init(&img);
+
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, path, key + 1) == -1);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, "/nonexistent/cs2.img", key) == -1);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, path, key) == 0);
+
+    TEST_ASSERT_TRUE(img.h->nn == t.np.count);
+    TEST_ASSERT_TRUE(img.n[0].p == CS2_BEZIERTREEIMGQQ4F_NONE);
+
+    /* hull views */
+    for (i = 1; i < img.h->nn; ++i)
+    {
+        TEST_ASSERT_TRUE(img.n[i].hv);
+
+        hc = cs2_beziertreeimgqq4f_hull(&h, &img, i);
+
+        TEST_ASSERT_TRUE(hc == &h && hc->nvr > 0 && hc->vol == img.n[i].hvol);
+    }
+
+    /* live tree without evaluations */
+    f.calls = 0;
+
+    cs2_beziertreeqq4f_init(&tl);
+    cs2_beziertreeqq4f_from_img(&tl, &img, &counted_func, &f);
+    cs2_beziertreeleafsqq4f_init(&ll, &tl);
+
+    TEST_ASSERT_TRUE(f.calls == 0);
+    TEST_ASSERT_TRUE(ll.c == l.c);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_vol(&tl) == cs2_beziertreeqq4f_vol(&t));
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_area(&tl) == cs2_beziertreeqq4f_area(&t));
+
+    /* same traversal order as the saved tree */
+    cs2_beziertreeleafsqq4f_init(&lt, &t);
+
+    for (la = lt.l, lb = ll.l; la && lb; la = la->next, lb = lb->next)
+    {
+        TEST_ASSERT_TRUE(same_node(la->n, lb->n));
+        cs2_bezierqq4f_cp(pa, &la->n->b);
+        cs2_bezierqq4f_cp(pb, &lb->n->b);
+
+        TEST_ASSERT_TRUE(memcmp(pa, pb, sizeof(pa)) == 0);
+        TEST_ASSERT_TRUE(memcmp(la->n->b.kmin, lb->n->b.kmin, sizeof(la->n->b.kmin)) == 0);
+        TEST_ASSERT_TRUE(!la->n->b.hv && lb->n->b.hv && lb->n->b.h.nhr > 0);
+    }
+
+    TEST_ASSERT_TRUE(!la && !lb);
+
+    cs2_beziertreeleafsqq4f_clear(&lt);
+
+    /* the image is not needed by the live tree, corrupted images are rejected */
+    c = img.n[0].c[0];
+    i = img.size;
+    cs2_beziertreeimgqq4f_clear(&img);
+
+    /* a child referenced twice */
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_save(&t, path, key) == 0);
+    TEST_ASSERT_TRUE(patch_img(path, 0, offsetof(struct cs2_beziertreeimgnodeqq4f_s, c) + sizeof(uint32_t), c) == 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, path, key) == -1);
+
+    /* a child not pointing back at its parent */
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_save(&t, path, key) == 0);
+    TEST_ASSERT_TRUE(patch_img(path, c, offsetof(struct cs2_beziertreeimgnodeqq4f_s, p), CS2_BEZIERTREEIMGQQ4F_NONE) == 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, path, key) == -1);
+
+    /* a root with a parent */
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_save(&t, path, key) == 0);
+    TEST_ASSERT_TRUE(patch_img(path, 0, offsetof(struct cs2_beziertreeimgnodeqq4f_s, p), 0) == 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, path, key) == -1);
+
+    /* untouched images load */
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_save(&t, path, key) == 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, path, key) == 0);
+
+    cs2_beziertreeimgqq4f_clear(&img);
+
+    /* depth is bounded */
+    sprintf(deep, "%s.deep", path);
+
+    TEST_ASSERT_TRUE(chain_img(deep, path, CS2_BEZIERTREEIMGQQ4F_DEPTH) == 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, deep, key) == 0);
+
+    cs2_beziertreeimgqq4f_clear(&img);
+
+    TEST_ASSERT_TRUE(chain_img(deep, path, CS2_BEZIERTREEIMGQQ4F_DEPTH + 1) == 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, deep, key) == -1);
+
+    unlink(deep);
+
+    TEST_ASSERT_TRUE(truncate(path, (off_t)(i - 8)) == 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeimgqq4f_load(&img, path, key) == -1);
+
+    unlink(path);
+
+    /* refinement continues */
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.0001);
+    cs2_beziertreeleafsqq4f_sub_vol(&ll, 0.0001);
+
+    TEST_ASSERT_TRUE(f.calls > 0 && ll.c == l.c);
+    test_almost_equal(cs2_beziertreeqq4f_vol(&tl), cs2_beziertreeqq4f_vol(&t));
+
+    /* clear */
+    cs2_beziertreeleafsqq4f_clear(&ll);
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&tl);
     cs2_beziertreeqq4f_clear(&t);
 }
+
+static void sum_leaves(struct cs2_beziertreenodeqq4f_s *n, double *vol, double *area, double *max, size_t *c)
+{
+    if (cs2_beziertreenodeqq4f_is_leaf(n))
+    {
+        *vol += n->vol;
+        *area += n->area;
+        *max = n->vol > *max ? n->vol : *max;
+        ++*c;
+    }
+    else
+    {
+        sum_leaves(n->c[0][0], vol, area, max, c);
+        sum_leaves(n->c[0][1], vol, area, max, c);
+        sum_leaves(n->c[1][0], vol, area, max, c);
+        sum_leaves(n->c[1][1], vol, area, max, c);
+    }
+}
+
+TEST_CASE(beziertreeqq4f, aggr)
+{
+    struct cs2_beziertreeqq4f_s t;
+    struct cs2_beziertreeleafsqq4f_s l;
+    struct cs2_beziertreerefineqq4f_s r;
+    struct cs2_beziertreebudgetqq4f_s b;
+    struct predbb_func_s f;
+    double vol, area, max;
+    size_t c;
+
+    create_z_barrel(&f.p);
+
+    cs2_predg3f_param(&f.pp, &f.p);
+
+    cs2_beziertreeqq4f_init(&t);
+    cs2_beziertreeqq4f_from_func(&t, &predbb_func, &f);
+
+    /* the virtual root is a leaf that must be split */
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_leaves(&t) == 1);
+    TEST_ASSERT_TRUE(isinf(cs2_beziertreeqq4f_max_vol(&t)));
+
+    /* threshold refinement */
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_vol(&l, 0.001);
+
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_leaves(&t) == l.c);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_max_vol(&t) <= 0.001);
+
+    /* budgeted refinement */
+    cs2_beziertreerefineqq4f_init(&r, &l, NULL, NULL);
+
+    memset(&b, 0, sizeof(b));
+    b.leaves = l.c + 300;
+
+    cs2_beziertreerefineqq4f_run(&r, &b);
+    cs2_beziertreerefineqq4f_clear(&r);
+
+    vol = area = max = 0.0;
+    c = 0;
+    sum_leaves(t.rn, &vol, &area, &max, &c);
+
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_leaves(&t) == l.c && c == l.c);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_max_vol(&t) == max);
+    test_almost_equal(cs2_beziertreeqq4f_vol(&t), vol);
+    test_almost_equal(cs2_beziertreeqq4f_area(&t), area);
+
+    /* subtrees */
+    vol = area = max = 0.0;
+    c = 0;
+    sum_leaves(t.rn->c[1][0], &vol, &area, &max, &c);
+
+    TEST_ASSERT_TRUE(cs2_beziertreenodeqq4f_leaves(t.rn->c[1][0]) == c);
+    TEST_ASSERT_TRUE(cs2_beziertreenodeqq4f_max_vol(t.rn->c[1][0]) == max);
+    test_almost_equal(cs2_beziertreenodeqq4f_vol(t.rn->c[1][0]), vol);
+
+    /* clear */
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+static void count_hulls(struct cs2_beziertreenodeqq4f_s *n, size_t *leaf, size_t *inner)
+{
+    int k;
+
+    /* measured hulls */
+    if (cs2_beziertreenodeqq4f_is_leaf(n))
+        *leaf += n->b.hm;
+    else
+    {
+        *inner += n->b.hm;
+
+        for (k = 0; k < 4; ++k)
+            count_hulls(n->c[k / 2][k % 2], leaf, inner);
+    }
+}
+
+TEST_CASE(beziertreeqq4f, flatness)
+{
+    struct cs2_beziertreeqq4f_s t, tv;
+    struct cs2_beziertreeleafsqq4f_s l, lv;
+    struct cs2_beziertreeleafqq4f_s *ll;
+    struct predbb_func_s f;
+    double vol, area, max;
+    size_t c, hl, hi;
+
+    create_z_barrel(&f.p);
+
+    cs2_predg3f_param(&f.pp, &f.p);
+
+    /* refine by flatness with cheap volumes: no hull is built */
+    cs2_beziertreeqq4f_init(&t);
+    t.bv = cs2_bezierbvqq4f_aabb;
+    cs2_beziertreeqq4f_from_func(&t, &predbb_func, &f);
+
+    cs2_beziertreeleafsqq4f_init(&l, &t);
+    cs2_beziertreeleafsqq4f_sub_par(&l, &cs2_beziertreenodeqq4f_flatness, NULL, 0.01);
+
+    for (ll = l.l; ll; ll = ll->next)
+        TEST_ASSERT_TRUE(cs2_beziertreenodeqq4f_flatness(ll->n, NULL) <= 0.01);
+
+    hl = hi = 0;
+    count_hulls(t.rn, &hl, &hi);
+
+    TEST_ASSERT_TRUE(l.c > 4 && hl == 0 && hi == 0);
+
+    /* the hulls of final leaves only, measured without building them */
+    cs2_beziertreeqq4f_set_bv(&t, cs2_bezierbvqq4f_hull);
+
+    hl = hi = 0;
+    count_hulls(t.rn, &hl, &hi);
+
+    TEST_ASSERT_TRUE(hl == l.c && hi == 0);
+
+    for (ll = l.l; ll; ll = ll->next)
+        TEST_ASSERT_TRUE(!ll->n->b.hv);
+
+    /* a hull built on demand has the measured volume */
+    test_almost_equal(cs2_bezierqq4f_hull(&l.l->n->b)->vol, l.l->n->vol);
+
+    vol = area = max = 0.0;
+    c = 0;
+    sum_leaves(t.rn, &vol, &area, &max, &c);
+
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_leaves(&t) == c);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_max_vol(&t) == max);
+    test_almost_equal(cs2_beziertreeqq4f_vol(&t), vol);
+    test_almost_equal(cs2_beziertreeqq4f_area(&t), area);
+
+    /* no split measure is the volume */
+    cs2_beziertreeqq4f_init(&tv);
+    cs2_beziertreeqq4f_from_func(&tv, &predbb_func, &f);
+
+    cs2_beziertreeleafsqq4f_init(&lv, &tv);
+    cs2_beziertreeleafsqq4f_sub(&lv, NULL, NULL, 0.001);
+
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_max_vol(&tv) <= 0.001);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_leaves(&tv) == lv.c);
+
+    /* clear */
+    cs2_beziertreeleafsqq4f_clear(&lv);
+    cs2_beziertreeqq4f_clear(&tv);
+    cs2_beziertreeleafsqq4f_clear(&l);
+    cs2_beziertreeqq4f_clear(&t);
+}
+
+static size_t count_nodes(struct cs2_beziertreenodeqq4f_s *n)
+{
+    size_t c = 1;
+    int k;
+
+    if (!cs2_beziertreenodeqq4f_is_leaf(n))
+        for (k = 0; k < 4; ++k)
+            c += count_nodes(n->c[k / 2][k % 2]);
+
+    return c;
+}
+
+static int all_leaves(struct cs2_beziertreeleafsqq4f_s *l)
+{
+    struct cs2_beziertreeleafqq4f_s *ll;
+    size_t c = 0;
+
+    for (ll = l->l; ll; ll = ll->next, ++c)
+        if (!cs2_beziertreenodeqq4f_is_leaf(ll->n))
+            return 0;
+
+    return c == l->c && c == cs2_beziertreeqq4f_leaves(l->t);
+}
+
+TEST_CASE(beziertreeqq4f, inter_and_leafs)
+{
+    struct cs2_beziertreeqq4f_s ta, tb;
+    struct cs2_beziertreeleafsqq4f_s la, lb;
+    struct cs2_beziertreerefineqq4f_s r;
+    struct cs2_beziertreebudgetqq4f_s b;
+    struct cs2_beziertreepairsqq4f_s ps;
+    struct predbb_func_s fa, fb;
+
+    create_z_barrel(&fa.p);
+    create_z_barrel(&fb.p);
+    cs2_vec3f_set(&fb.p.a, 1.0, 1.0, 0.0);
+
+    cs2_predg3f_param(&fa.pp, &fa.p);
+    cs2_predg3f_param(&fb.pp, &fb.p);
+
+    cs2_beziertreeqq4f_init(&ta);
+    cs2_beziertreeqq4f_from_func(&ta, &predbb_func, &fa);
+    cs2_beziertreeqq4f_init(&tb);
+    cs2_beziertreeqq4f_from_func(&tb, &predbb_func, &fb);
+
+    /* coarse lists, and a heap built before the query */
+    cs2_beziertreeleafsqq4f_init(&la, &ta);
+    cs2_beziertreeleafsqq4f_sub_vol(&la, 0.01);
+    cs2_beziertreeleafsqq4f_init(&lb, &tb);
+    cs2_beziertreeleafsqq4f_sub_vol(&lb, 0.01);
+    cs2_beziertreerefineqq4f_init(&r, &lb, NULL, NULL);
+
+    /* the query splits leaves behind the lists */
+    cs2_beziertreepairsqq4f_init(&ps);
+    cs2_beziertreeqq4f_inter(&ps, &ta, &tb, 0.001, 0);
+
+    TEST_ASSERT_TRUE(ps.n > 0);
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_leaves(&ta) > la.c);
+
+    /* a threshold the tree already meets stops early, with the list in sync */
+    cs2_beziertreeleafsqq4f_sub_vol(&la, cs2_beziertreeqq4f_max_vol(&ta));
+
+    TEST_ASSERT_TRUE(all_leaves(&la));
+
+    /* list refinement continues from the leaves of the tree */
+    cs2_beziertreeleafsqq4f_sub_vol(&la, 0.0001);
+
+    TEST_ASSERT_TRUE(all_leaves(&la));
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_max_vol(&ta) <= 0.0001);
+    TEST_ASSERT_TRUE(ta.np.count == count_nodes(ta.rn));
+
+    /* and so does budgeted refinement */
+    memset(&b, 0, sizeof(b));
+    b.leaves = cs2_beziertreeqq4f_leaves(&tb) + 30;
+
+    cs2_beziertreerefineqq4f_run(&r, &b);
+    cs2_beziertreerefineqq4f_clear(&r);
+
+    TEST_ASSERT_TRUE(all_leaves(&lb));
+    TEST_ASSERT_TRUE(cs2_beziertreeqq4f_leaves(&tb) + 3 > b.leaves);
+    TEST_ASSERT_TRUE(tb.np.count == count_nodes(tb.rn));
+
+    /* clear */
+    cs2_beziertreepairsqq4f_clear(&ps);
+    cs2_beziertreeleafsqq4f_clear(&la);
+    cs2_beziertreeleafsqq4f_clear(&lb);
+    cs2_beziertreeqq4f_clear(&ta);
+    cs2_beziertreeqq4f_clear(&tb);
+}
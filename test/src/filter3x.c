@@ -0,0 +1,325 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/filter3x.h"
+#include "cs2/spinquad3x.h"
+#include "cs2/predg3x.h"
+#include "cs2/rand.h"
+#include "test/test.h"
+
+static void rand_mpz(mpz_ptr x, struct cs2_rand_s *r, int shift)
+{
+    mpz_set_si(x, (long)cs2_rand_u1f(r, -1000.0, 1000.0));
+    mpz_mul_2exp(x, x, (unsigned long)shift);
+}
+
+static void rand_vec3x(struct cs2_vec3x_s *v, struct cs2_rand_s *r, int shift)
+{
+    rand_mpz(v->x, r, shift);
+    rand_mpz(v->y, r, shift);
+    rand_mpz(v->z, r, shift);
+}
+
+/* random integer of at most 'bits' bits */
+static void rand_mpz_bits(mpz_ptr x, struct cs2_rand_s *r, int bits)
+{
+    int i;
+
+    mpz_set_ui(x, 0);
+
+    for (i = 0; i < bits; ++i)
+    {
+        mpz_mul_2exp(x, x, 1);
+
+        if (cs2_rand_u1f(r, 0.0, 1.0) < 0.5)
+            mpz_add_ui(x, x, 1);
+    }
+
+    if (cs2_rand_u1f(r, 0.0, 1.0) < 0.5)
+        mpz_neg(x, x);
+}
+
+static void vec3x_mul_2exp(struct cs2_vec3x_s *v, unsigned long e)
+{
+    mpz_mul_2exp(v->x, v->x, e);
+    mpz_mul_2exp(v->y, v->y, e);
+    mpz_mul_2exp(v->z, v->z, e);
+}
+
+static void spinquad3x_mul_2exp(struct cs2_spinquad3x_s *sq, unsigned long e)
+{
+    mpz_mul_2exp(sq->a11, sq->a11, e);
+    mpz_mul_2exp(sq->a22, sq->a22, e);
+    mpz_mul_2exp(sq->a33, sq->a33, e);
+    mpz_mul_2exp(sq->a44, sq->a44, e);
+    mpz_mul_2exp(sq->a12, sq->a12, e);
+    mpz_mul_2exp(sq->a13, sq->a13, e);
+    mpz_mul_2exp(sq->a14, sq->a14, e);
+    mpz_mul_2exp(sq->a23, sq->a23, e);
+    mpz_mul_2exp(sq->a24, sq->a24, e);
+    mpz_mul_2exp(sq->a34, sq->a34, e);
+}
+
+static int spinquad3x_eq(const struct cs2_spinquad3x_s *a, const struct cs2_spinquad3x_s *b)
+{
+    return !mpz_cmp(a->a11, b->a11) && !mpz_cmp(a->a22, b->a22) && !mpz_cmp(a->a33, b->a33) && !mpz_cmp(a->a44, b->a44) &&
+           !mpz_cmp(a->a12, b->a12) && !mpz_cmp(a->a13, b->a13) && !mpz_cmp(a->a14, b->a14) &&
+           !mpz_cmp(a->a23, b->a23) && !mpz_cmp(a->a24, b->a24) && !mpz_cmp(a->a34, b->a34);
+}
+
+TEST_SUITE(filter3x)
+
+TEST_CASE(filter3x, spinquad3x_sign)
+{
+    struct cs2_rand_s r;
+    struct cs2_spinquad3x_s sq;
+    struct cs2_pin3x_s p;
+    struct cs2_filter3x_stats_s st;
+    mpz_t f;
+    int i, shift;
+
+    cs2_rand_seed(&r);
+    cs2_spinquad3x_init(&sq);
+    cs2_pin3x_init(&p);
+    mpz_init(f);
+    cs2_filter3x_reset_stats();
+
+    for (i = 0; i < 2000; ++i)
+    {
+        /* small, large and huge (beyond double range) coefficients */
+        shift = i % 3 == 0 ? 0 : (i % 3 == 1 ? 80 : 1100);
+
+        rand_mpz(sq.a11, &r, shift);
+        rand_mpz(sq.a22, &r, shift);
+        rand_mpz(sq.a33, &r, shift);
+        rand_mpz(sq.a44, &r, shift);
+        rand_mpz(sq.a12, &r, shift);
+        rand_mpz(sq.a13, &r, shift);
+        rand_mpz(sq.a14, &r, shift);
+        rand_mpz(sq.a23, &r, shift);
+        rand_mpz(sq.a24, &r, shift);
+        rand_mpz(sq.a34, &r, shift);
+
+        rand_mpz(p.p12, &r, 0);
+        rand_mpz(p.p23, &r, 0);
+        rand_mpz(p.p31, &r, 0);
+        rand_mpz(p.p0, &r, 0);
+
+        /* every fourth pin lies on the zero set: F(1, 1, 0, 0) = a11 + a22 + 2 a12 = 0 */
+        if (i % 4 == 0)
+        {
+            mpz_set_si(p.p12, 1);
+            mpz_set_si(p.p23, 1);
+            mpz_set_si(p.p31, 0);
+            mpz_set_si(p.p0, 0);
+            mpz_mul_2exp(sq.a12, sq.a11, 1);
+            mpz_add(sq.a12, sq.a12, sq.a22);
+            mpz_neg(sq.a12, sq.a12);
+            mpz_add(sq.a11, sq.a11, sq.a12);
+            mpz_add(sq.a22, sq.a22, sq.a12);
+        }
+
+        cs2_spinquad3x_eval(f, &sq, &p);
+
+        TEST_ASSERT_TRUE(cs2_spinquad3x_sign(&sq, &p) == mpz_sgn(f));
+    }
+
+    cs2_filter3x_stats(&st, cs2_filter3x_spinquad3x_sign);
+
+    TEST_ASSERT_TRUE(st.calls == 2000);
+    TEST_ASSERT_TRUE(st.hits > 0 && st.hits < st.calls);
+
+    mpz_clear(f);
+    cs2_pin3x_clear(&p);
+    cs2_spinquad3x_clear(&sq);
+}
+
+TEST_CASE(filter3x, predg3x_type)
+{
+    struct cs2_rand_s r;
+    struct cs2_predg3x_s g;
+    struct cs2_filter3x_stats_s st;
+    int i, shift;
+
+    cs2_rand_seed(&r);
+    cs2_predg3x_init(&g);
+    cs2_filter3x_reset_stats();
+
+    for (i = 0; i < 2000; ++i)
+    {
+        shift = i % 2 == 0 ? 0 : 60;
+
+        rand_vec3x(&g.k, &r, shift);
+        rand_vec3x(&g.l, &r, shift);
+        rand_vec3x(&g.a, &r, shift);
+        rand_vec3x(&g.b, &r, shift);
+        mpz_set_si(g.c, 0);
+
+        /* degenerate cases: equal and parallel vectors */
+        switch (i % 5)
+        {
+        case 1:
+            cs2_vec3x_copy(&g.l, &g.k);
+            break;
+
+        case 2:
+            mpz_mul_2exp(g.b.x, g.a.x, 3);
+            mpz_mul_2exp(g.b.y, g.a.y, 3);
+            mpz_mul_2exp(g.b.z, g.a.z, 3);
+            break;
+
+        case 3:
+            cs2_vec3x_copy(&g.l, &g.k);
+            cs2_vec3x_neg(&g.b, &g.a);
+            break;
+        }
+
+        TEST_ASSERT_TRUE(cs2_predg3x_type_filtered(&g) == cs2_predg3x_type(&g));
+    }
+
+    cs2_filter3x_stats(&st, cs2_filter3x_predg3x_type);
+
+    TEST_ASSERT_TRUE(st.calls == 2000);
+    TEST_ASSERT_TRUE(st.hits > 0 && st.hits < st.calls);
+
+    cs2_predg3x_clear(&g);
+}
+
+TEST_CASE(filter3x, spinquad3x_from_predg3x)
+{
+    struct cs2_rand_s r;
+    struct cs2_predg3x_s g;
+    struct cs2_spinquad3x_s sq, sqx;
+    struct cs2_filter3x_stats_s st;
+    int i, bits;
+
+    cs2_rand_seed(&r);
+    cs2_predg3x_init(&g);
+    cs2_spinquad3x_init(&sq);
+    cs2_spinquad3x_init(&sqx);
+    cs2_filter3x_reset_stats();
+
+    for (i = 0; i < 200; ++i)
+    {
+        /* up to the 40-bit budget */
+        bits = i % 2 ? 40 : 20;
+
+        rand_mpz_bits(g.k.x, &r, bits);
+        rand_mpz_bits(g.k.y, &r, bits);
+        rand_mpz_bits(g.k.z, &r, bits);
+        rand_mpz_bits(g.l.x, &r, bits);
+        rand_mpz_bits(g.l.y, &r, bits);
+        rand_mpz_bits(g.l.z, &r, bits);
+        rand_mpz_bits(g.a.x, &r, bits);
+        rand_mpz_bits(g.a.y, &r, bits);
+        rand_mpz_bits(g.a.z, &r, bits);
+        rand_mpz_bits(g.b.x, &r, bits);
+        rand_mpz_bits(g.b.y, &r, bits);
+        rand_mpz_bits(g.b.z, &r, bits);
+        rand_mpz_bits(g.c, &r, 62);
+
+        /* fixed-width */
+        cs2_spinquad3x_from_predg3x(&sq, &g);
+        spinquad3x_mul_2exp(&sq, 90);
+
+        /* the same predicate scaled by 2^30 is out of budget: the quadric scales by 2^90 */
+        vec3x_mul_2exp(&g.k, 30);
+        vec3x_mul_2exp(&g.l, 30);
+        vec3x_mul_2exp(&g.a, 30);
+        vec3x_mul_2exp(&g.b, 30);
+        mpz_mul_2exp(g.c, g.c, 90);
+
+        cs2_spinquad3x_from_predg3x(&sqx, &g);
+
+        TEST_ASSERT_TRUE(spinquad3x_eq(&sq, &sqx));
+    }
+
+    cs2_filter3x_stats(&st, cs2_filter3x_spinquad3x_from_predg3x);
+
+    TEST_ASSERT_TRUE(st.calls == 400);
+    TEST_ASSERT_TRUE(st.hits == 200);
+
+    cs2_spinquad3x_clear(&sqx);
+    cs2_spinquad3x_clear(&sq);
+    cs2_predg3x_clear(&g);
+}
+
+TEST_CASE(filter3x, spinquad3x_eval)
+{
+    struct cs2_rand_s r;
+    struct cs2_spinquad3x_s sq;
+    struct cs2_pin3x_s p;
+    struct cs2_filter3x_stats_s st;
+    mpz_t f, fx;
+    int i, ba, bp;
+
+    cs2_rand_seed(&r);
+    cs2_spinquad3x_init(&sq);
+    cs2_pin3x_init(&p);
+    mpz_init(f);
+    mpz_init(fx);
+    cs2_filter3x_reset_stats();
+
+    for (i = 0; i < 200; ++i)
+    {
+        /* ba + 2 bp within the budget */
+        ba = i % 2 ? 62 : 20;
+        bp = i % 2 ? 30 : 20;
+
+        rand_mpz_bits(sq.a11, &r, ba);
+        rand_mpz_bits(sq.a22, &r, ba);
+        rand_mpz_bits(sq.a33, &r, ba);
+        rand_mpz_bits(sq.a44, &r, ba);
+        rand_mpz_bits(sq.a12, &r, ba);
+        rand_mpz_bits(sq.a13, &r, ba);
+        rand_mpz_bits(sq.a14, &r, ba);
+        rand_mpz_bits(sq.a23, &r, ba);
+        rand_mpz_bits(sq.a24, &r, ba);
+        rand_mpz_bits(sq.a34, &r, ba);
+        rand_mpz_bits(p.p12, &r, bp);
+        rand_mpz_bits(p.p23, &r, bp);
+        rand_mpz_bits(p.p31, &r, bp);
+        rand_mpz_bits(p.p0, &r, bp);
+
+        /* fixed-width */
+        cs2_spinquad3x_eval(f, &sq, &p);
+        mpz_mul_2exp(f, f, 64);
+
+        /* out of budget: F scales linearly */
+        spinquad3x_mul_2exp(&sq, 64);
+        cs2_spinquad3x_eval(fx, &sq, &p);
+
+        TEST_ASSERT_TRUE(!mpz_cmp(f, fx));
+    }
+
+    cs2_filter3x_stats(&st, cs2_filter3x_spinquad3x_eval);
+
+    TEST_ASSERT_TRUE(st.calls == 400);
+    TEST_ASSERT_TRUE(st.hits == 200);
+
+    mpz_clear(fx);
+    mpz_clear(f);
+    cs2_pin3x_clear(&p);
+    cs2_spinquad3x_clear(&sq);
+}
@@ -23,6 +23,7 @@
  * SOFTWARE.
  */
 #include "cs2/hull4f.h"
+#include "cs2/rand.h"
 #include "test/test.h"
 #include <math.h>
 
@@ -213,3 +214,257 @@ TEST_CASE(hull4f, sep_simplex_abc)
     cs2_hull4f_clear(&hsb);
     cs2_hull4f_clear(&hsc);
 }
+
+TEST_CASE(hull4f, small_cube_a)
+{
+    struct cs2_hull4f_s hca;
+
+    cs2_hull4f_init(&hca);
+
+    TEST_ASSERT_TRUE(cs2_hull4f_from_arr_small(&hca, CUBE_A, CUBE_A_SIZE) == 0);
+
+    /* triangulated facets are merged back to the 8 cubes */
+    TEST_ASSERT_TRUE(hca.nhr == 8);
+    TEST_ASSERT_TRUE(hca.nvr == 16);
+    test_almost_equal(hca.vol, 1.0);
+    test_almost_equal(hca.area, 8.0);
+
+    cs2_hull4f_clear(&hca);
+}
+
+TEST_CASE(hull4f, small_degenerate)
+{
+    struct cs2_hull4f_s h;
+    struct cs2_vec4f_s v[9];
+    int i;
+
+    /* a flat grid */
+    for (i = 0; i < 9; ++i)
+        cs2_vec4f_set(&v[i], i / 3, i % 3, 1.0, 0.0);
+
+    cs2_hull4f_init(&h);
+
+    TEST_ASSERT_TRUE(cs2_hull4f_from_arr_small(&h, v, 9) == -1);
+    TEST_ASSERT_TRUE(cs2_hull4f_from_arr_small(&h, CUBE_A, 4) == -1);
+
+    cs2_hull4f_clear(&h);
+}
+
+TEST_CASE(hull4f, small_vs_qhull)
+{
+    struct cs2_hull4f_s hs, hq;
+    struct cs2_vec4f_s v[CS2_HULL4F_SMALL_N + 1], c;
+    struct cs2_rand_s r;
+    size_t i, j;
+    int k;
+
+    cs2_rand_seed(&r);
+
+    for (k = 0; k < 100; ++k)
+    {
+        cs2_vec4f_zero(&c);
+
+        for (i = 0; i < 9; ++i)
+        {
+            cs2_vec4f_set(&v[i], cs2_rand_1f(&r), cs2_rand_1f(&r), cs2_rand_1f(&r), cs2_rand_1f(&r));
+            cs2_vec4f_mad2(&c, &c, 1.0, &v[i], 1.0 / 9.0);
+        }
+
+        /* interior points push the set over the small kernel limit */
+        for (i = 9; i <= CS2_HULL4F_SMALL_N; ++i)
+            cs2_vec4f_copy(&v[i], &c);
+
+        cs2_hull4f_init(&hs);
+        cs2_hull4f_init(&hq);
+
+        TEST_ASSERT_TRUE(cs2_hull4f_from_arr_small(&hs, v, 9) == 0);
+        cs2_hull4f_from_arr(&hq, v, CS2_HULL4F_SMALL_N + 1);
+
+        TEST_ASSERT_TRUE(hs.nvr == hq.nvr);
+        test_almost_equal(hs.vol, hq.vol);
+        test_almost_equal(hs.area, hq.area);
+
+        /* all points are inside */
+        for (i = 0; i < hs.nhr; ++i)
+            for (j = 0; j < 9; ++j)
+                TEST_ASSERT_TRUE(cs2_plane4f_pops(&hs.hr[i], &v[j]) < EPS);
+
+        cs2_hull4f_clear(&hs);
+        cs2_hull4f_clear(&hq);
+    }
+}
+
+TEST_CASE(hull4f, gjk_cube_abc)
+{
+    struct cs2_hull4f_s hca, hcb, hcc;
+    struct cs2_vec4f_s w;
+    double d;
+
+    cs2_hull4f_init(&hca);
+    cs2_hull4f_init(&hcb);
+    cs2_hull4f_init(&hcc);
+
+    cs2_hull4f_from_arr(&hca, CUBE_A, CUBE_A_SIZE);
+    cs2_hull4f_from_arr(&hcb, CUBE_B, CUBE_B_SIZE);
+    cs2_hull4f_from_arr(&hcc, CUBE_C, CUBE_C_SIZE);
+
+    cs2_vec4f_zero(&w);
+    TEST_ASSERT_TRUE(cs2_hull4f_gjk(&d, &w, &hca, &hcb));
+    test_almost_equal(d, 0.0);
+
+    /* unit gap along x */
+    TEST_ASSERT_TRUE(!cs2_hull4f_gjk(&d, &w, &hca, &hcc));
+    test_almost_equal(d, 1.0);
+    test_almost_equal(w.x, 1.0);
+
+    cs2_vec4f_zero(&w);
+    TEST_ASSERT_TRUE(!cs2_hull4f_gjk(&d, &w, &hcc, &hcb));
+    test_almost_equal(d, 0.5);
+    test_almost_equal(w.x, -1.0);
+
+    /* v-reps only */
+    cs2_vec4f_zero(&w);
+    TEST_ASSERT_TRUE(!cs2_hull4f_gjk_arr(&d, &w, CUBE_A, CUBE_A_SIZE, CUBE_C, CUBE_C_SIZE));
+    test_almost_equal(d, 1.0);
+
+    cs2_hull4f_clear(&hca);
+    cs2_hull4f_clear(&hcb);
+    cs2_hull4f_clear(&hcc);
+}
+
+TEST_CASE(hull4f, gjk_simplex_abc)
+{
+    struct cs2_vec4f_s w;
+    double d;
+
+    cs2_vec4f_zero(&w);
+    TEST_ASSERT_TRUE(cs2_hull4f_gjk_arr(&d, &w, SIMPLEX_A, SIMPLEX_A_SIZE, SIMPLEX_B, SIMPLEX_B_SIZE));
+
+    cs2_vec4f_zero(&w);
+    TEST_ASSERT_TRUE(!cs2_hull4f_gjk_arr(&d, &w, SIMPLEX_A, SIMPLEX_A_SIZE, SIMPLEX_C, SIMPLEX_C_SIZE));
+    test_almost_equal(d, 1.0);
+
+    cs2_vec4f_zero(&w);
+    TEST_ASSERT_TRUE(!cs2_hull4f_gjk_arr(&d, &w, SIMPLEX_B, SIMPLEX_B_SIZE, SIMPLEX_C, SIMPLEX_C_SIZE));
+    test_almost_equal(d, 0.5);
+}
+
+TEST_CASE(hull4f, gjk_witness)
+{
+    struct cs2_vec4f_s a[9], b[9], w, wc;
+    struct cs2_rand_s r;
+    double d, dc, ma, mb;
+    size_t i;
+    int k, ic, iw, cold = 0, warm = 0;
+
+    cs2_rand_seed(&r);
+
+    for (k = 0; k < 100; ++k)
+    {
+        for (i = 0; i < 9; ++i)
+        {
+            cs2_vec4f_set(&a[i], cs2_rand_1f(&r), cs2_rand_1f(&r), cs2_rand_1f(&r), cs2_rand_1f(&r));
+            cs2_vec4f_set(&b[i], 1.5 + cs2_rand_1f(&r), cs2_rand_1f(&r), 0.5 + cs2_rand_1f(&r), cs2_rand_1f(&r));
+        }
+
+        cs2_vec4f_zero(&w);
+        TEST_ASSERT_TRUE(!cs2_hull4f_gjk_arr(&d, &w, a, 9, b, 9));
+
+        /* the witness direction separates the sets by the distance */
+        ma = -INFINITY;
+        mb = INFINITY;
+
+        for (i = 0; i < 9; ++i)
+        {
+            ma = fmax(ma, cs2_vec4f_dot(&w, &a[i]));
+            mb = fmin(mb, cs2_vec4f_dot(&w, &b[i]));
+        }
+
+        test_almost_equal(ma + d, mb);
+
+        /* a warm start from the witness gives the same answer */
+        cs2_vec4f_copy(&wc, &w);
+        TEST_ASSERT_TRUE(!cs2_hull4f_gjk_arr(&dc, &wc, a, 9, b, 9));
+        test_almost_equal(dc, d);
+
+        /* and needs fewer iterations for a slightly moved pair */
+        for (i = 0; i < 9; ++i)
+            cs2_vec4f_set(&b[i], b[i].x + 0.01, b[i].y - 0.01, b[i].z, b[i].w + 0.01);
+
+        cs2_vec4f_zero(&wc);
+        TEST_ASSERT_TRUE(!cs2_hull4f_gjk_arr_it(&dc, &wc, a, 9, b, 9, &ic));
+        TEST_ASSERT_TRUE(!cs2_hull4f_gjk_arr_it(&d, &w, a, 9, b, 9, &iw));
+        test_almost_equal(d, dc);
+
+        cold += ic;
+        warm += iw;
+    }
+
+    TEST_ASSERT_TRUE(warm < cold);
+}
+
+TEST_CASE(hull4f, sep_soa)
+{
+    struct cs2_hull4f_s hca, hcb, hcc, va, vb, vc;
+    size_t i;
+
+    cs2_hull4f_init(&hca);
+    cs2_hull4f_init(&hcb);
+    cs2_hull4f_init(&hcc);
+
+    cs2_hull4f_from_arr(&hca, CUBE_A, CUBE_A_SIZE);
+    cs2_hull4f_from_arr(&hcb, CUBE_B, CUBE_B_SIZE);
+    cs2_hull4f_from_arr(&hcc, CUBE_C, CUBE_C_SIZE);
+
+    /* the mirror holds the v-rep */
+    TEST_ASSERT_TRUE(hca.vs != NULL);
+
+    for (i = 0; i < hca.nvr; ++i)
+    {
+        TEST_ASSERT_TRUE(hca.vs[i] == hca.vr[i].x);
+        TEST_ASSERT_TRUE(hca.vs[hca.nvr + i] == hca.vr[i].y);
+        TEST_ASSERT_TRUE(hca.vs[2 * hca.nvr + i] == hca.vr[i].z);
+        TEST_ASSERT_TRUE(hca.vs[3 * hca.nvr + i] == hca.vr[i].w);
+    }
+
+    /* views without the mirror give the same answers */
+    va = hca;
+    vb = hcb;
+    vc = hcc;
+    va.vs = vb.vs = vc.vs = NULL;
+
+    TEST_ASSERT_TRUE(cs2_hull4f_inter(&va, &hcb) && cs2_hull4f_inter(&hca, &vb));
+    TEST_ASSERT_TRUE(!cs2_hull4f_inter(&va, &hcc) && !cs2_hull4f_inter(&hca, &vc));
+    TEST_ASSERT_TRUE(!cs2_hull4f_inter(&vb, &vc));
+
+    /* a cleared hull can be built again */
+    cs2_hull4f_clear(&hca);
+    cs2_hull4f_soa(&hca);
+    cs2_hull4f_from_arr(&hca, CUBE_A, CUBE_A_SIZE);
+
+    TEST_ASSERT_TRUE(hca.vs && cs2_hull4f_inter(&hca, &hcb));
+
+    cs2_hull4f_clear(&hca);
+    cs2_hull4f_clear(&hcb);
+    cs2_hull4f_clear(&hcc);
+}
+
+TEST_CASE(hull4f, measure_arr)
+{
+    struct cs2_hull4f_s h;
+    double vol, area;
+
+    cs2_hull4f_measure_arr(&vol, &area, CUBE_A, CUBE_A_SIZE);
+
+    test_almost_equal(vol, 1.0);
+    test_almost_equal(area, 8.0);
+
+    cs2_hull4f_init(&h);
+    cs2_hull4f_from_arr(&h, SIMPLEX_B, SIMPLEX_B_SIZE);
+    cs2_hull4f_measure_arr(&vol, &area, SIMPLEX_B, SIMPLEX_B_SIZE);
+
+    test_almost_equal(vol, h.vol);
+    test_almost_equal(area, h.area);
+
+    cs2_hull4f_clear(&h);
+}
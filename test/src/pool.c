@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/pool.h"
+#include "test/test.h"
+#include <stdint.h>
+
+struct pool_item_s
+{
+    double x;
+    int i;
+};
+
+TEST_SUITE(pool)
+
+TEST_CASE(pool, alloc_free)
+{
+    struct cs2_pool_s p;
+    struct pool_item_s *a[1000], *b;
+    int i;
+
+    cs2_pool_init(&p, sizeof(struct pool_item_s));
+
+    for (i = 0; i < 1000; ++i)
+    {
+        a[i] = CS2_POOL_ALLOC(&p, struct pool_item_s);
+        a[i]->x = i;
+        a[i]->i = i;
+
+        /* aligned */
+        TEST_ASSERT_TRUE((uintptr_t)a[i] % 16 == 0);
+    }
+
+    TEST_ASSERT_TRUE(p.count == 1000);
+
+    /* objects are distinct and keep their values across slabs */
+    for (i = 0; i < 1000; ++i)
+        TEST_ASSERT_TRUE(a[i]->x == i && a[i]->i == i);
+
+    /* recycled objects are reused first */
+    CS2_POOL_FREE(&p, a[10]);
+    CS2_POOL_FREE(&p, a[20]);
+
+    TEST_ASSERT_TRUE(p.count == 998);
+
+    b = CS2_POOL_ALLOC(&p, struct pool_item_s);
+    TEST_ASSERT_TRUE(b == a[20]);
+
+    b = CS2_POOL_ALLOC(&p, struct pool_item_s);
+    TEST_ASSERT_TRUE(b == a[10]);
+
+    /* bulk free */
+    cs2_pool_clear(&p);
+
+    TEST_ASSERT_TRUE(p.count == 0 && p.slabs == NULL);
+
+    cs2_pool_clear(&p);
+}
@@ -59,6 +59,27 @@ static void rand_predg3f(struct cs2_predg3f_s *g, struct cs2_rand_s *r)
     g->c = cs2_rand_u1f(r, MIN, MAX);
 }
 
+/* parametrizable test predicates (note: 'a pair of yz-crossed ellipsoids' is not covered yet) */
+static const struct cs2_predg3f_s *const PARAM_PREDS[] = {
+    &test_predg3f_a_pair_of_points,
+    &test_predg3f_a_pair_of_separate_ellipsoids,
+    &test_predg3f_a_pair_of_y_touching_ellipsoids,
+    &test_predg3f_a_pair_of_z_touching_ellipsoids,
+    &test_predg3f_a_y_barrel,
+    &test_predg3f_a_z_barrel,
+    &test_predg3f_a_notched_y_barrel,
+    &test_predg3f_a_notched_z_barrel,
+    &test_predg3f_a_pair_of_separate_yz_caps,
+    &test_predg3f_a_xy_zw_torus,
+    &test_predg3f_a_xy_circle,
+    &test_predg3f_a_zw_circle,
+    &test_predg3f_a_xz_yw_torus,
+    &test_predg3f_a_xz_circle,
+    &test_predg3f_a_yw_circle
+};
+
+static const size_t PARAM_PREDS_SIZE = sizeof(PARAM_PREDS) / sizeof(PARAM_PREDS[0]);
+
 TEST_SUITE(predg3f)
 
 #if 0 /* TODO: uncomment when all cases are covered */
@@ -563,6 +584,201 @@ TEST_CASE(predg3f, param_a_yw_circle)
     }
 }
 
+TEST_CASE(predg3f, param_n)
+{
+    struct cs2_predg3f_s pg[1000];
+    struct cs2_predgparam3f_s pp[1000], tp;
+    size_t i;
+    int j;
+
+    const size_t N = 1000;
+
+    /* mixed types */
+    for (i = 0; i < N; ++i)
+        cs2_predg3f_copy(&pg[i], i % 3 == 0 ? PARAM_PREDS[i % PARAM_PREDS_SIZE] : &test_predg3f_an_empty_set);
+
+    cs2_predg3f_param_n(pp, pg, N);
+
+    for (i = 0; i < N; ++i)
+    {
+        cs2_predg3f_param(&tp, &pg[i]);
+
+        TEST_ASSERT_TRUE(pp[i].t == tp.t);
+        TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].a, tp.a));
+        TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].b, tp.b));
+        TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].c, tp.c));
+
+        for (j = 0; j < 4; ++j)
+        {
+            TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].e[j], tp.e[j]));
+            TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].ev[j].x, tp.ev[j].x));
+            TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].ev[j].y, tp.ev[j].y));
+            TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].ev[j].z, tp.ev[j].z));
+            TEST_ASSERT_TRUE(_cs2_almost_equal(pp[i].ev[j].w, tp.ev[j].w));
+        }
+    }
+}
+
+TEST_CASE(predg3f, eval_d)
+{
+    struct cs2_predgparam3f_s pp;
+    struct cs2_spin3f_s s, su, sv, sp, sm;
+    double u, v, d;
+    size_t p;
+    int c;
+
+    const double H = 10e-7;
+    const double EPS_D = 10e-4;
+
+    for (p = 0; p < PARAM_PREDS_SIZE; ++p)
+    {
+        cs2_predg3f_param(&pp, PARAM_PREDS[p]);
+
+        for (c = 0; c < cs2_predgparamtype3f_domain_components(pp.t); ++c)
+        {
+            /* interior points away from folds */
+            for (u = 0.03; u < 1.0; u += 0.07)
+            {
+                for (v = 0.03; v < 1.0; v += 0.07)
+                {
+                    cs2_predgparam3f_eval_d(&s, &su, &sv, &pp, u, v, c);
+
+                    /* central differences */
+                    cs2_predgparam3f_eval(&sp, &pp, u + H, v, c);
+                    cs2_predgparam3f_eval(&sm, &pp, u - H, v, c);
+
+                    d = fabs((sp.s12 - sm.s12) / (2.0 * H) - su.s12) + fabs((sp.s23 - sm.s23) / (2.0 * H) - su.s23) +
+                        fabs((sp.s31 - sm.s31) / (2.0 * H) - su.s31) + fabs((sp.s0 - sm.s0) / (2.0 * H) - su.s0);
+
+                    TEST_ASSERT_TRUE(d < EPS_D);
+
+                    cs2_predgparam3f_eval(&sp, &pp, u, v + H, c);
+                    cs2_predgparam3f_eval(&sm, &pp, u, v - H, c);
+
+                    d = fabs((sp.s12 - sm.s12) / (2.0 * H) - sv.s12) + fabs((sp.s23 - sm.s23) / (2.0 * H) - sv.s23) +
+                        fabs((sp.s31 - sm.s31) / (2.0 * H) - sv.s31) + fabs((sp.s0 - sm.s0) / (2.0 * H) - sv.s0);
+
+                    TEST_ASSERT_TRUE(d < EPS_D);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(predg3f, inv)
+{
+    struct cs2_predgparam3f_s pp;
+    struct cs2_spin3f_s s, ts;
+    double u, v, tu, tv, res;
+    size_t p;
+    int c, tc;
+
+    const double EPS_RES = 10e-7;
+
+    for (p = 0; p < PARAM_PREDS_SIZE; ++p)
+    {
+        cs2_predg3f_param(&pp, PARAM_PREDS[p]);
+
+        for (c = 0; c < cs2_predgparamtype3f_domain_components(pp.t); ++c)
+        {
+            for (u = 0.0; u <= 1.0; u += 0.05)
+            {
+                for (v = 0.0; v <= 1.0; v += 0.05)
+                {
+                    cs2_predgparam3f_eval(&s, &pp, u, v, c);
+
+                    res = cs2_predgparam3f_inv(&tu, &tv, &tc, &pp, &s);
+
+                    TEST_ASSERT_TRUE(res < EPS_RES);
+                    TEST_ASSERT_TRUE(tu >= 0.0 && tu <= 1.0 && tv >= 0.0 && tv <= 1.0);
+
+                    /* parameters may differ at poles and seams, the spin may not */
+                    cs2_predgparam3f_eval(&ts, &pp, tu, tv, tc);
+
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(s.s12, ts.s12));
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(s.s23, ts.s23));
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(s.s31, ts.s31));
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(s.s0, ts.s0));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(predg3f, eval_n)
+{
+    struct cs2_predgparam3f_s pp;
+    struct cs2_spin3f_s sp;
+    double u[101], v[101], s12[101], s23[101], s31[101], s0[101];
+    size_t p, i, j;
+    int c;
+
+    const size_t N = 101;
+
+    for (p = 0; p < PARAM_PREDS_SIZE; ++p)
+    {
+        cs2_predg3f_param(&pp, PARAM_PREDS[p]);
+
+        for (c = 0; c < cs2_predgparamtype3f_domain_components(pp.t); ++c) for (j = 0; j < N; ++j)
+        {
+            for (i = 0; i < N; ++i)
+            {
+                u[i] = (double)i / (double)(N - 1);
+                v[i] = (double)j / (double)(N - 1);
+            }
+
+            cs2_predgparam3f_eval_n(s12, s23, s31, s0, &pp, u, v, N, c);
+
+            for (i = 0; i < N; ++i)
+            {
+                cs2_predgparam3f_eval(&sp, &pp, u[i], v[i], c);
+
+                TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s12, s12[i]));
+                TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s23, s23[i]));
+                TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s31, s31[i]));
+                TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s0, s0[i]));
+            }
+        }
+    }
+}
+
+TEST_CASE(predg3f, plan)
+{
+    struct cs2_predgparam3f_s pp;
+    struct cs2_predgplan3f_s pl;
+    struct cs2_spin3f_s sp, ps;
+    double u, v;
+    size_t p;
+    int c;
+
+    for (p = 0; p < PARAM_PREDS_SIZE; ++p)
+    {
+        cs2_predg3f_param(&pp, PARAM_PREDS[p]);
+
+        for (c = 0; c < cs2_predgparamtype3f_domain_components(pp.t); ++c)
+        {
+            cs2_predgparam3f_plan(&pl, &pp, c);
+
+            TEST_ASSERT_TRUE(pl.t == pp.t);
+            TEST_ASSERT_TRUE(pl.dc == c);
+
+            for (u = 0.0; u <= 1.0; u += 0.01)
+            {
+                for (v = 0.0; v <= 1.0; v += 0.01)
+                {
+                    cs2_predgparam3f_eval(&sp, &pp, u, v, c);
+                    cs2_predgplan3f_eval(&ps, &pl, u, v);
+
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s12, ps.s12));
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s23, ps.s23));
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s31, ps.s31));
+                    TEST_ASSERT_TRUE(_cs2_almost_equal(sp.s0, ps.s0));
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE(predg3f, from_pquvc)
 {
     struct cs2_vec3f_s p, q, u, v, tp, tq, tu, tv;
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/spinquad3f.h"
+#include "cs2/rand.h"
+#include "test/test.h"
+#include <math.h>
+
+static void rand_spinquad3f(struct cs2_spinquad3f_s *sq, struct cs2_rand_s *r)
+{
+    sq->a11 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a22 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a33 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a44 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a12 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a13 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a14 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a23 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a24 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a34 = cs2_rand_u1f(r, -1.0, 1.0);
+}
+
+static void rand_spin3f(struct cs2_spin3f_s *s, struct cs2_rand_s *r)
+{
+    double l;
+
+    s->s12 = cs2_rand_u1f(r, -1.0, 1.0);
+    s->s23 = cs2_rand_u1f(r, -1.0, 1.0);
+    s->s31 = cs2_rand_u1f(r, -1.0, 1.0);
+    s->s0 = cs2_rand_u1f(r, -1.0, 1.0);
+
+    l = sqrt(s->s12 * s->s12 + s->s23 * s->s23 + s->s31 * s->s31 + s->s0 * s->s0);
+
+    s->s12 /= l;
+    s->s23 /= l;
+    s->s31 /= l;
+    s->s0 /= l;
+}
+
+TEST_SUITE(spinquad3f)
+
+TEST_CASE(spinquad3f, eval_box)
+{
+    struct cs2_rand_s r;
+    struct cs2_spinquad3f_s sq;
+    struct cs2_spinbox3f_s b;
+    struct cs2_spin3f_s s;
+    double fmin, fmax, f, w;
+    int i, j, sign;
+
+    cs2_rand_seed(&r);
+
+    for (i = 0; i < 1000; ++i)
+    {
+        rand_spinquad3f(&sq, &r);
+
+        w = cs2_rand_u1f(&r, 0.0, 0.5);
+
+        b.lo.s12 = cs2_rand_u1f(&r, -1.0, 1.0);
+        b.lo.s23 = cs2_rand_u1f(&r, -1.0, 1.0);
+        b.lo.s31 = cs2_rand_u1f(&r, -1.0, 1.0);
+        b.lo.s0 = cs2_rand_u1f(&r, -1.0, 1.0);
+        b.hi.s12 = b.lo.s12 + cs2_rand_u1f(&r, 0.0, w);
+        b.hi.s23 = b.lo.s23 + cs2_rand_u1f(&r, 0.0, w);
+        b.hi.s31 = b.lo.s31 + cs2_rand_u1f(&r, 0.0, w);
+        b.hi.s0 = b.lo.s0 + cs2_rand_u1f(&r, 0.0, w);
+
+        cs2_spinquad3f_eval_box(&fmin, &fmax, &sq, &b);
+        sign = cs2_spinquad3f_sign_box(&sq, &b);
+
+        TEST_ASSERT_TRUE(fmin <= fmax);
+
+        /* corners and random points */
+        for (j = 0; j < 64; ++j)
+        {
+            if (j < 16)
+            {
+                s.s12 = (j & 1) ? b.hi.s12 : b.lo.s12;
+                s.s23 = (j & 2) ? b.hi.s23 : b.lo.s23;
+                s.s31 = (j & 4) ? b.hi.s31 : b.lo.s31;
+                s.s0 = (j & 8) ? b.hi.s0 : b.lo.s0;
+            }
+            else
+            {
+                s.s12 = cs2_rand_u1f(&r, b.lo.s12, b.hi.s12);
+                s.s23 = cs2_rand_u1f(&r, b.lo.s23, b.hi.s23);
+                s.s31 = cs2_rand_u1f(&r, b.lo.s31, b.hi.s31);
+                s.s0 = cs2_rand_u1f(&r, b.lo.s0, b.hi.s0);
+            }
+
+            f = cs2_spinquad3f_eval(&sq, &s);
+
+            TEST_ASSERT_TRUE(fmin <= f && f <= fmax);
+            TEST_ASSERT_TRUE(sign == 0 || (sign > 0 && f > 0.0) || (sign < 0 && f < 0.0));
+        }
+    }
+
+    /* a degenerate box is a point, the range is tight */
+    rand_spinquad3f(&sq, &r);
+    rand_spin3f(&b.lo, &r);
+    b.hi = b.lo;
+
+    cs2_spinquad3f_eval_box(&fmin, &fmax, &sq, &b);
+    f = cs2_spinquad3f_eval(&sq, &b.lo);
+
+    TEST_ASSERT_TRUE(fmin <= f && f <= fmax && fmax - fmin < 1e-12);
+}
+
+TEST_CASE(spinquad3f, eval_cap)
+{
+    struct cs2_rand_s r;
+    struct cs2_spinquad3f_s sq;
+    struct cs2_spin3f_s c, s;
+    double fmin, fmax, f, rad, l;
+    int i, j, sign, certified = 0;
+
+    cs2_rand_seed(&r);
+
+    for (i = 0; i < 1000; ++i)
+    {
+        rand_spinquad3f(&sq, &r);
+        rand_spin3f(&c, &r);
+
+        rad = cs2_rand_u1f(&r, 0.0, 0.5);
+
+        cs2_spinquad3f_eval_cap(&fmin, &fmax, &sq, &c, rad);
+        sign = cs2_spinquad3f_sign_cap(&sq, &c, rad);
+
+        TEST_ASSERT_TRUE(fmin <= fmax);
+
+        if (sign != 0)
+            ++certified;
+
+        for (j = 0; j < 64; ++j)
+        {
+            /* random unit spin in the cap */
+            s.s12 = c.s12 + cs2_rand_u1f(&r, -rad, rad);
+            s.s23 = c.s23 + cs2_rand_u1f(&r, -rad, rad);
+            s.s31 = c.s31 + cs2_rand_u1f(&r, -rad, rad);
+            s.s0 = c.s0 + cs2_rand_u1f(&r, -rad, rad);
+
+            l = sqrt(s.s12 * s.s12 + s.s23 * s.s23 + s.s31 * s.s31 + s.s0 * s.s0);
+
+            s.s12 /= l;
+            s.s23 /= l;
+            s.s31 /= l;
+            s.s0 /= l;
+
+            l = sqrt((s.s12 - c.s12) * (s.s12 - c.s12) + (s.s23 - c.s23) * (s.s23 - c.s23) +
+                     (s.s31 - c.s31) * (s.s31 - c.s31) + (s.s0 - c.s0) * (s.s0 - c.s0));
+
+            if (l > rad)
+                continue;
+
+            f = cs2_spinquad3f_eval(&sq, &s);
+
+            TEST_ASSERT_TRUE(fmin <= f && f <= fmax);
+            TEST_ASSERT_TRUE(sign == 0 || (sign > 0 && f > 0.0) || (sign < 0 && f < 0.0));
+        }
+    }
+
+    /* small caps away from the zero set are certified */
+    TEST_ASSERT_TRUE(certified > 0);
+}
@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/spinquadbank3f.h"
+#include "cs2/rand.h"
+#include "test/test.h"
+#include <math.h>
+
+static void rand_spinquad3f(struct cs2_spinquad3f_s *sq, struct cs2_rand_s *r)
+{
+    sq->a11 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a22 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a33 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a44 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a12 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a13 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a14 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a23 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a24 = cs2_rand_u1f(r, -1.0, 1.0);
+    sq->a34 = cs2_rand_u1f(r, -1.0, 1.0);
+}
+
+static void rand_spin3f(struct cs2_spin3f_s *s, struct cs2_rand_s *r)
+{
+    double l;
+
+    s->s12 = cs2_rand_u1f(r, -1.0, 1.0);
+    s->s23 = cs2_rand_u1f(r, -1.0, 1.0);
+    s->s31 = cs2_rand_u1f(r, -1.0, 1.0);
+    s->s0 = cs2_rand_u1f(r, -1.0, 1.0);
+
+    l = sqrt(s->s12 * s->s12 + s->s23 * s->s23 + s->s31 * s->s31 + s->s0 * s->s0);
+
+    s->s12 /= l;
+    s->s23 /= l;
+    s->s31 /= l;
+    s->s0 /= l;
+}
+
+TEST_SUITE(spinquadbank3f)
+
+TEST_CASE(spinquadbank3f, add_get)
+{
+    struct cs2_spinquadbank3f_s b;
+    struct cs2_spinquad3f_s sq[200], tq;
+    struct cs2_rand_s r;
+    size_t i;
+
+    cs2_rand_seed(&r);
+    cs2_spinquadbank3f_init(&b);
+
+    for (i = 0; i < 200; ++i)
+    {
+        rand_spinquad3f(&sq[i], &r);
+        TEST_ASSERT_TRUE(cs2_spinquadbank3f_add(&b, &sq[i]) == i);
+    }
+
+    TEST_ASSERT_TRUE(b.n == 200);
+    TEST_ASSERT_TRUE(b.cap % 64 == 0);
+    TEST_ASSERT_TRUE(cs2_spinquadbank3f_mask_size(&b) == 4);
+
+    for (i = 0; i < 200; ++i)
+    {
+        cs2_spinquadbank3f_get(&tq, &b, i);
+
+        TEST_ASSERT_TRUE(tq.a11 == sq[i].a11 && tq.a22 == sq[i].a22 && tq.a33 == sq[i].a33 && tq.a44 == sq[i].a44);
+        TEST_ASSERT_TRUE(tq.a12 == sq[i].a12 && tq.a13 == sq[i].a13 && tq.a14 == sq[i].a14);
+        TEST_ASSERT_TRUE(tq.a23 == sq[i].a23 && tq.a24 == sq[i].a24 && tq.a34 == sq[i].a34);
+    }
+
+    cs2_spinquadbank3f_clear(&b);
+}
+
+TEST_CASE(spinquadbank3f, sign)
+{
+    struct cs2_spinquadbank3f_s b;
+    struct cs2_spinquad3f_s sq[150];
+    struct cs2_spin3f_s s[20];
+    struct cs2_rand_s r;
+    uint64_t pos[20 * 3], neg[20 * 3];
+    double s12[20], s23[20], s31[20], s0[20], f[150], e;
+    size_t i, j, w;
+
+    cs2_rand_seed(&r);
+    cs2_spinquadbank3f_init(&b);
+
+    for (i = 0; i < 150; ++i)
+    {
+        rand_spinquad3f(&sq[i], &r);
+        cs2_spinquadbank3f_add(&b, &sq[i]);
+    }
+
+    for (j = 0; j < 20; ++j)
+    {
+        rand_spin3f(&s[j], &r);
+
+        s12[j] = s[j].s12;
+        s23[j] = s[j].s23;
+        s31[j] = s[j].s31;
+        s0[j] = s[j].s0;
+    }
+
+    w = cs2_spinquadbank3f_mask_size(&b);
+
+    cs2_spinquadbank3f_sign_n(pos, neg, &b, s12, s23, s31, s0, 20);
+
+    for (j = 0; j < 20; ++j)
+    {
+        cs2_spinquadbank3f_eval(f, &b, &s[j]);
+
+        for (i = 0; i < 150; ++i)
+        {
+            e = cs2_spinquad3f_eval(&sq[i], &s[j]);
+
+            TEST_ASSERT_TRUE(fabs(e - f[i]) < 10e-12);
+            TEST_ASSERT_TRUE(((pos[j * w + i / 64] >> (i % 64)) & 1) == (e > 0.0));
+            TEST_ASSERT_TRUE(((neg[j * w + i / 64] >> (i % 64)) & 1) == (e < 0.0));
+        }
+
+        /* padding */
+        TEST_ASSERT_TRUE((pos[j * w + w - 1] >> (150 % 64)) == 0);
+        TEST_ASSERT_TRUE((neg[j * w + w - 1] >> (150 % 64)) == 0);
+    }
+
+    cs2_spinquadbank3f_clear(&b);
+}
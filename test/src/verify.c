@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/verify.h"
+#include "test/test.h"
+
+TEST_SUITE(verify)
+
+TEST_CASE(verify, levels)
+{
+    enum cs2_verify_level_e level = cs2_verify_level();
+    unsigned rate = cs2_verify_sample_rate();
+    int i, count;
+
+    cs2_verify_set_level(cs2_verify_level_off);
+
+    for (i = 0, count = 0; i < 100; ++i)
+        count += cs2_verify_sample();
+
+    TEST_ASSERT_TRUE(count == 0);
+
+    cs2_verify_set_level(cs2_verify_level_full);
+
+    for (i = 0, count = 0; i < 100; ++i)
+        count += cs2_verify_sample();
+
+    TEST_ASSERT_TRUE(count == 100);
+
+    cs2_verify_set_level(cs2_verify_level_sampled);
+    cs2_verify_set_sample_rate(4);
+
+    /* drain a pending countdown */
+    while (!cs2_verify_sample());
+
+    for (i = 0, count = 0; i < 100; ++i)
+        count += cs2_verify_sample();
+
+    TEST_ASSERT_TRUE(count == 25);
+
+    cs2_verify_set_sample_rate(rate);
+    cs2_verify_set_level(level);
+}
+
+TEST_CASE(verify, stats)
+{
+    struct cs2_verify_stats_s st;
+    int fatal = cs2_verify_fatal();
+
+    cs2_verify_set_fatal(0);
+    cs2_verify_reset_stats();
+
+    TEST_ASSERT_TRUE(cs2_verify_check(1, "1", __FILE__, __LINE__, "ok"));
+    TEST_ASSERT_TRUE(!cs2_verify_check(0, "0", __FILE__, __LINE__, "failed: %d", 0));
+    TEST_ASSERT_TRUE(cs2_verify_check(1, "1", __FILE__, __LINE__, "ok"));
+
+    cs2_verify_stats(&st);
+
+    TEST_ASSERT_TRUE(st.checks == 3);
+    TEST_ASSERT_TRUE(st.failures == 1);
+    TEST_ASSERT_TRUE(st.last_file != NULL);
+
+    cs2_verify_reset_stats();
+    cs2_verify_stats(&st);
+
+    TEST_ASSERT_TRUE(st.checks == 0);
+    TEST_ASSERT_TRUE(st.failures == 0);
+
+    cs2_verify_set_fatal(fatal);
+}
@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2015-2019 Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs2), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "cs2/xctx.h"
+#include "cs2/predg3x.h"
+#include "cs2/spinquad3x.h"
+#include "cs2/thread.h"
+#include "test/test.h"
+
+TEST_SUITE(xctx)
+
+TEST_CASE(xctx, get_put)
+{
+    struct cs2_xctx_s xc;
+    mpz_ptr z[100];
+    struct cs2_vec3x_s *v[100];
+    int i;
+
+    cs2_xctx_init(&xc);
+
+    /* temporaries keep their values across growth */
+    for (i = 0; i < 100; ++i)
+    {
+        z[i] = cs2_xctx_get_mpz(&xc);
+        mpz_set_si(z[i], i);
+
+        v[i] = cs2_xctx_get_vec3x(&xc);
+        cs2_vec3x_set_si(v[i], i, -i, 2 * i);
+    }
+
+    for (i = 0; i < 100; ++i)
+    {
+        TEST_ASSERT_TRUE(mpz_cmp_si(z[i], i) == 0);
+        TEST_ASSERT_TRUE(mpz_cmp_si(v[i]->x, i) == 0 && mpz_cmp_si(v[i]->y, -i) == 0 && mpz_cmp_si(v[i]->z, 2 * i) == 0);
+    }
+
+    cs2_xctx_put_mpz(&xc, 100);
+    cs2_xctx_put_vec3x(&xc, 100);
+
+    /* released temporaries are reused */
+    TEST_ASSERT_TRUE(cs2_xctx_get_mpz(&xc) == z[0]);
+    TEST_ASSERT_TRUE(cs2_xctx_get_vec3x(&xc) == v[0]);
+
+    cs2_xctx_put_mpz(&xc, 1);
+    cs2_xctx_put_vec3x(&xc, 1);
+
+    cs2_xctx_clear(&xc);
+
+    TEST_ASSERT_TRUE(cs2_xctx_thread() == cs2_xctx_thread());
+
+    /* the thread context is recreated after a cleanup */
+    cs2_xctx_get_mpz(cs2_xctx_thread());
+    cs2_xctx_put_mpz(cs2_xctx_thread(), 1);
+    cs2_xctx_cleanup();
+    cs2_xctx_cleanup();
+
+    TEST_ASSERT_TRUE(cs2_xctx_thread()->zcap == 0);
+}
+
+TEST_CASE(xctx, kernels)
+{
+    struct cs2_xctx_s xc;
+    struct cs2_predg3x_s g;
+    struct cs2_spinquad3x_s sq, sqc;
+    struct cs2_pin3x_s p;
+    mpz_t f, fc;
+    int i;
+
+    cs2_xctx_init(&xc);
+    cs2_predg3x_init(&g);
+    cs2_spinquad3x_init(&sq);
+    cs2_spinquad3x_init(&sqc);
+    cs2_pin3x_init(&p);
+    mpz_init(f);
+    mpz_init(fc);
+
+    for (i = 0; i < 50; ++i)
+    {
+        /* beyond the fixed-width budget, so that gmp temporaries are used */
+        cs2_vec3x_set_si(&g.k, i + 1, 2 - i, 3);
+        cs2_vec3x_set_si(&g.l, 5, i, -7 * i);
+        cs2_vec3x_set_si(&g.a, -i, 11, 13);
+        cs2_vec3x_set_si(&g.b, 17, -19 * i, i * i);
+        mpz_set_si(g.c, 23 * i);
+        mpz_mul_2exp(g.k.x, g.k.x, 100);
+        mpz_mul_2exp(g.c, g.c, 300);
+
+        cs2_pin3x_set_si(&p, i, -3, 5, 7 - i);
+        mpz_mul_2exp(p.p0, p.p0, 80);
+
+        cs2_spinquad3x_from_predg3x(&sq, &g);
+        cs2_spinquad3x_from_predg3x_ctx(&sqc, &g, &xc);
+
+        TEST_ASSERT_TRUE(mpz_cmp(sq.a11, sqc.a11) == 0 && mpz_cmp(sq.a14, sqc.a14) == 0 && mpz_cmp(sq.a34, sqc.a34) == 0);
+
+        cs2_spinquad3x_eval(f, &sq, &p);
+        cs2_spinquad3x_eval_ctx(fc, &sq, &p, &xc);
+
+        TEST_ASSERT_TRUE(mpz_cmp(f, fc) == 0);
+        TEST_ASSERT_TRUE(cs2_spinquad3x_sign_ctx(&sq, &p, &xc) == mpz_sgn(f));
+        TEST_ASSERT_TRUE(cs2_predg3x_type_ctx(&g, &xc) == cs2_predg3x_type(&g));
+
+        /* every kernel returns its temporaries */
+        TEST_ASSERT_TRUE(xc.ztop == 0 && xc.vtop == 0);
+    }
+
+    mpz_clear(fc);
+    mpz_clear(f);
+    cs2_pin3x_clear(&p);
+    cs2_spinquad3x_clear(&sqc);
+    cs2_spinquad3x_clear(&sq);
+    cs2_predg3x_clear(&g);
+    cs2_xctx_clear(&xc);
+}
+
+static void xctx_type_range(size_t begin, size_t end, void *d)
+{
+    struct cs2_predg3x_s g;
+    int *t = (int *)d;
+    size_t i;
+
+    cs2_predg3x_init(&g);
+
+    for (i = begin; i < end; ++i)
+    {
+        /* every third predicate has k = l, so that p = u = 0 */
+        cs2_vec3x_set_si(&g.k, (long)i, 1, 2);
+        cs2_vec3x_set_si(&g.l, (long)(i % 3 ? i + 1 : i), 1, 2);
+        cs2_vec3x_set_si(&g.a, 1, (long)i, 3);
+        cs2_vec3x_set_si(&g.b, 4, 5, (long)i);
+        mpz_mul_2exp(g.k.x, g.k.x, 200);
+        mpz_mul_2exp(g.l.x, g.l.x, 200);
+
+        t[i] = (int)cs2_predg3x_type(&g);
+    }
+
+    cs2_predg3x_clear(&g);
+}
+
+TEST_CASE(xctx, threads)
+{
+    int t[1000];
+    size_t i;
+
+    /* each worker uses its own thread context */
+    cs2_thread_parallel_for(1000, 10, xctx_type_range, t);
+
+    for (i = 0; i < 1000; ++i)
+        TEST_ASSERT_TRUE(t[i] == (i % 3 ? cs2_predgtype3x_ellipsoidal : cs2_predgtype3x_improper));
+}